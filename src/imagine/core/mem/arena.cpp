@@ -0,0 +1,94 @@
+/*
+ Imagine v0.1
+ [core]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/core/mem/arena.h"
+
+namespace ig {
+namespace {
+
+thread_local std::pmr::memory_resource* current = nullptr;
+
+} // namespace
+
+arena::arena(size_t block, std::pmr::memory_resource* upstream)
+  : upstream_{upstream}
+  , block_{block}
+  , chunk_{0}
+  , offset_{0} {}
+
+arena::~arena() {
+  release();
+}
+
+void arena::rewind(const marker& m) {
+  chunk_ = m.chunk;
+  offset_ = m.offset;
+}
+
+void arena::release() {
+  for (auto& c : chunks_)
+    upstream_->deallocate(c.ptr, c.size, alignof(std::max_align_t));
+  chunks_.clear();
+  chunk_ = 0;
+  offset_ = 0;
+}
+
+auto arena::used() const -> size_t {
+  size_t n = offset_;
+  for (size_t c = 0; c < chunk_ && c < chunks_.size(); ++c)
+    n += chunks_[c].size;
+  return n;
+}
+
+auto arena::reserved() const -> size_t {
+  size_t n = 0;
+  for (auto& c : chunks_) n += c.size;
+  return n;
+}
+
+void* arena::do_allocate(size_t bytes, size_t alignment) {
+  for (; chunk_ < chunks_.size(); ++chunk_, offset_ = 0) {
+    auto& c = chunks_[chunk_];
+    auto at = (reinterpret_cast<uintptr_t>(c.ptr) + offset_ + alignment - 1) & ~uintptr_t(alignment - 1);
+    auto end = at - reinterpret_cast<uintptr_t>(c.ptr) + bytes;
+    if (end <= c.size) {
+      offset_ = end;
+      return reinterpret_cast<void*>(at);
+    }
+  }
+
+  // Chunks grow geometrically, a rewound arena walks through them again before asking for more
+  auto size = std::max(
+    chunks_.empty() ? block_ : chunks_.back().size * 2,
+    bytes + alignment);
+  chunks_.push_back({static_cast<std::byte*>(upstream_->allocate(size, alignof(std::max_align_t))), size});
+  chunk_ = chunks_.size() - 1;
+  offset_ = 0;
+  return do_allocate(bytes, alignment);
+}
+
+auto current_resource() -> std::pmr::memory_resource* {
+  return current ? current : std::pmr::new_delete_resource();
+}
+
+arena_frame::arena_frame(arena& a)
+  : arena_{a}
+  , mark_{a.mark()}
+  , previous_{current} { current = &a; }
+
+arena_frame::~arena_frame() {
+  arena_.rewind(mark_);
+  current = previous_;
+}
+
+resource_frame::resource_frame(std::pmr::memory_resource& r)
+  : previous_{current} { current = &r; }
+
+resource_frame::~resource_frame() {
+  current = previous_;
+}
+
+} // namespace ig
@@ -0,0 +1,128 @@
+/*
+ Imagine v0.1
+ [core]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_CORE_ARENA_H
+#define IG_CORE_ARENA_H
+
+#include "imagine/ig.h"
+
+#include <memory_resource>
+#include <vector>
+
+namespace ig {
+
+// Monotonic memory carved from chunks, deallocation is a no-op
+// Rewinding to a mark keeps the chunks, so a repeated workload stops reaching the upstream resource
+// An arena serves a single thread
+class IG_API arena : public std::pmr::memory_resource {
+public:
+  struct marker {
+    size_t chunk;
+    size_t offset;
+  };
+
+  explicit arena(size_t block = size_t(1) << 20, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+  ~arena() override;
+
+  auto mark() const { return marker{chunk_, offset_}; }
+  void rewind(const marker& m);
+  void release();
+
+  auto used() const -> size_t;
+  auto reserved() const -> size_t;
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+protected:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void*, size_t, size_t) override {}
+  bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+
+private:
+  struct chunk {
+    std::byte* ptr;
+    size_t size;
+  };
+
+  std::pmr::memory_resource* upstream_;
+  size_t block_;
+
+  std::vector<chunk> chunks_;
+  size_t chunk_, offset_;
+};
+
+// Resource of the dynamic containers created by the calling thread, the global heap outside of frames
+IG_API auto current_resource() -> std::pmr::memory_resource*;
+
+// Scope in which the thread allocates from an arena, everything allocated within is released on exit
+// Frames nest, and containers allocated within must not outlive them
+class IG_API arena_frame {
+public:
+  explicit arena_frame(arena& a);
+  ~arena_frame();
+
+  arena_frame(const arena_frame&) = delete;
+  arena_frame& operator=(const arena_frame&) = delete;
+
+private:
+  arena& arena_;
+  arena::marker mark_;
+  std::pmr::memory_resource* previous_;
+};
+
+// Scope in which the thread allocates from any resource, it is restored on exit
+// Containers keep their resource, which must outlive them but not the frame
+class IG_API resource_frame {
+public:
+  explicit resource_frame(std::pmr::memory_resource& r);
+  ~resource_frame();
+
+  resource_frame(const resource_frame&) = delete;
+  resource_frame& operator=(const resource_frame&) = delete;
+
+private:
+  std::pmr::memory_resource* previous_;
+};
+
+// Allocator bound to the current resource when a container is created or copied
+// Move assignments between resources transfer elements instead of buffers, so a result never adopts frame memory
+template <typename T>
+class arena_allocator {
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::false_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  arena_allocator() noexcept : resource_{current_resource()} {}
+  explicit arena_allocator(std::pmr::memory_resource* resource) noexcept : resource_{resource} {}
+  template <typename U>
+  arena_allocator(const arena_allocator<U>& o) noexcept : resource_{o.resource()} {}
+
+  auto allocate(size_t n) { return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T))); }
+  void deallocate(T* p, size_t n) { resource_->deallocate(p, n * sizeof(T), alignof(T)); }
+
+  auto select_on_container_copy_construction() const { return arena_allocator{}; }
+  auto resource() const { return resource_; }
+
+private:
+  std::pmr::memory_resource* resource_;
+};
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs)
+{ return lhs.resource()->is_equal(*rhs.resource()); }
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs)
+{ return !(lhs == rhs); }
+
+template <typename T> using arena_vector = std::vector<T, arena_allocator<T>>;
+
+} // namespace ig
+
+#endif // IG_CORE_ARENA_H
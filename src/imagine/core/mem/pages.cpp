@@ -0,0 +1,235 @@
+/*
+ Imagine v0.1
+ [core]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/core/mem/pages.h"
+#include "imagine/core/net/distribute.h"
+
+#if defined(IG_LINUX)
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace ig {
+namespace {
+
+// Size of the huge pages of x86-64 and aarch64 with 4 KiB base pages
+constexpr size_t huge_page = size_t(1) << 21;
+
+auto round_up(size_t n, size_t to) { return (n + to - 1) / to * to; }
+
+#if defined(IG_LINUX)
+// <linux/mempolicy.h>, without requiring libnuma
+constexpr int mpol_bind = 2, mpol_interleave = 3;
+constexpr size_t mask_bits = 8 * sizeof(unsigned long);
+
+auto base_page() {
+  static const auto size = size_t(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+// Online nodes as a mask, from a list such as 0-3,6
+auto online_nodes() -> const std::vector<unsigned long>& {
+  static const auto mask = [] {
+    std::vector<unsigned long> bits;
+    auto set = [&bits](size_t node) {
+      if (node / mask_bits >= bits.size())
+        bits.resize(node / mask_bits + 1, 0);
+      bits[node / mask_bits] |= 1ul << (node % mask_bits);
+    };
+
+    std::ifstream online{"/sys/devices/system/node/online"};
+    std::string range;
+    while (std::getline(online, range, ',')) {
+      unsigned first = 0, last = 0;
+      auto n = std::sscanf(range.c_str(), "%u-%u", &first, &last);
+      if (n < 1) continue;
+      for (auto node = first; node <= (n == 2 ? last : first); ++node)
+        set(node);
+    }
+    if (bits.empty())
+      set(0);
+    return bits;
+  }();
+  return mask;
+}
+
+bool bind(void* ptr, size_t length, int mode, const std::vector<unsigned long>& mask) {
+  return syscall(SYS_mbind, ptr, length, mode, mask.data(), mask.size() * mask_bits + 1, 0) == 0;
+}
+
+void place(void* ptr, size_t length, const page_options& options) {
+  switch (options.numa) {
+  case numa_policy::interleave:
+    bind(ptr, length, mpol_interleave, online_nodes());
+    break;
+  case numa_policy::bind: {
+    std::vector<unsigned long> mask(size_t(options.node) / mask_bits + 1, 0);
+    mask[size_t(options.node) / mask_bits] |= 1ul << (size_t(options.node) % mask_bits);
+    bind(ptr, length, mpol_bind, mask);
+    break;
+  }
+  case numa_policy::first_touch: {
+    // Pages are faulted by the range that evaluation would give to each worker, one write per page
+    auto page = options.huge == huge_pages::none ? base_page() : huge_page;
+    auto bytes = static_cast<volatile std::byte*>(ptr);
+    parallel_for(0, length / page, 1, [bytes, page](size_t first, size_t last) {
+      for (auto p = first; p < last; ++p)
+        bytes[p * page] = std::byte{0};
+    });
+    break;
+  }
+  case numa_policy::local:
+    break;
+  }
+}
+
+// Anonymous mapping on a huge page boundary, the slack around it is returned to the system
+auto map_aligned(size_t length) -> void* {
+  auto raw = mmap(nullptr, length + huge_page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED)
+    return raw;
+
+  auto base = reinterpret_cast<uintptr_t>(raw);
+  auto at = round_up(base, huge_page);
+  if (at > base)
+    munmap(raw, at - base);
+  if (auto tail = base + length + huge_page - (at + length))
+    munmap(reinterpret_cast<void*>(at + length), tail);
+  return reinterpret_cast<void*>(at);
+}
+#endif
+
+} // namespace
+
+page_resource::page_resource(const page_options& options, std::pmr::memory_resource* upstream)
+  : options_{options}
+  , upstream_{upstream}
+  , mapped_{0} {}
+
+void* page_resource::do_allocate(size_t bytes, size_t alignment) {
+  if (bytes < options_.threshold)
+    return upstream_->allocate(bytes, alignment);
+
+#if defined(IG_LINUX)
+  assert(alignment <= base_page() && "Invalid page allocation, alignment exceeds a page");
+
+  void* ptr = MAP_FAILED;
+  auto length = round_up(bytes, options_.huge == huge_pages::none ? base_page() : huge_page);
+  auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  if (options_.huge == huge_pages::reserved)
+    ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+  if (ptr == MAP_FAILED && options_.huge != huge_pages::none) {
+    ptr = map_aligned(length);
+    if (ptr != MAP_FAILED)
+      madvise(ptr, length, MADV_HUGEPAGE);
+  }
+  if (ptr == MAP_FAILED && options_.huge == huge_pages::none)
+    ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (ptr == MAP_FAILED)
+    throw std::bad_alloc{};
+
+  // The policy has to be set before the first write faults the pages in
+  place(ptr, length, options_);
+  mapped_ += length;
+  return ptr;
+#else
+  mapped_ += bytes;
+  return upstream_->allocate(bytes, std::max(alignment, huge_page));
+#endif
+}
+
+void page_resource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+  if (bytes < options_.threshold) {
+    upstream_->deallocate(ptr, bytes, alignment);
+    return;
+  }
+
+#if defined(IG_LINUX)
+  auto length = round_up(bytes, options_.huge == huge_pages::none ? base_page() : huge_page);
+  munmap(ptr, length);
+  mapped_ -= length;
+#else
+  upstream_->deallocate(ptr, bytes, std::max(alignment, huge_page));
+  mapped_ -= bytes;
+#endif
+}
+
+auto numa_nodes() -> size_t {
+#if defined(IG_LINUX)
+  auto& mask = online_nodes();
+  size_t last = 0;
+  for (size_t node = 0; node < mask.size() * mask_bits; ++node)
+    if (mask[node / mask_bits] & (1ul << (node % mask_bits)))
+      last = node;
+  return last + 1;
+#else
+  return 1;
+#endif
+}
+
+auto page_placement(const void* ptr, size_t bytes) -> page_report {
+  page_report report;
+  if (!ptr || bytes == 0)
+    return report;
+
+#if defined(IG_LINUX)
+  auto page = base_page();
+  auto first = reinterpret_cast<uintptr_t>(ptr) / page * page;
+  auto last = reinterpret_cast<uintptr_t>(ptr) + bytes;
+  report.pages = (last - first + page - 1) / page;
+
+  // Queried by batches, move_pages without target nodes only reports the node of each page
+  constexpr size_t batch = 1024;
+  std::vector<void*> addresses(batch);
+  std::vector<int> status(batch);
+  for (size_t p = 0; p < report.pages; p += batch) {
+    auto n = std::min(batch, report.pages - p);
+    for (size_t i = 0; i < n; ++i)
+      addresses[i] = reinterpret_cast<void*>(first + (p + i) * page);
+    if (syscall(SYS_move_pages, 0, n, addresses.data(), nullptr, status.data(), 0) != 0) {
+      report.nodes.clear();
+      report.absent = 0;
+      break;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      if (status[i] < 0) {
+        ++report.absent;
+        continue;
+      }
+      if (size_t(status[i]) >= report.nodes.size())
+        report.nodes.resize(status[i] + 1, 0);
+      ++report.nodes[status[i]];
+    }
+  }
+
+  // Huge pages are only visible per mapping
+  std::ifstream smaps{"/proc/self/smaps"};
+  std::string line;
+  bool inside = false;
+  while (std::getline(smaps, line)) {
+    unsigned long begin = 0, end = 0;
+    char field[64];
+    size_t kb = 0;
+    if (std::sscanf(line.c_str(), "%lx-%lx ", &begin, &end) == 2)
+      inside = begin < last && end > first;
+    else if (inside && std::sscanf(line.c_str(), "%63[^:]: %zu kB", field, &kb) == 2) {
+      std::string name{field};
+      if (name == "AnonHugePages" || name == "Private_Hugetlb" || name == "Shared_Hugetlb")
+        report.huge += kb << 10;
+    }
+  }
+  report.huge = std::min(report.huge, round_up(last - first, huge_page));
+#else
+  report.pages = (bytes + 4095) / 4096;
+#endif
+  return report;
+}
+
+} // namespace ig
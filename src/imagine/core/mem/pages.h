@@ -0,0 +1,75 @@
+/*
+ Imagine v0.1
+ [core]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_CORE_PAGES_H
+#define IG_CORE_PAGES_H
+
+#include "imagine/ig.h"
+
+#include <atomic>
+#include <memory_resource>
+#include <vector>
+
+namespace ig {
+
+// none:        base pages
+// transparent: aligned on huge page boundaries and advised, the kernel promotes them when it can
+// reserved:    taken from the preallocated huge page pool, transparent when the pool is empty
+enum class huge_pages { none, transparent, reserved };
+
+// local:       pages land on the node of the thread that first writes them
+// interleave:  pages are spread round-robin across the online nodes
+// bind:        pages are restricted to a single node
+// first_touch: pages are written by the workers over the same contiguous ranges as parallel evaluation
+enum class numa_policy { local, interleave, bind, first_touch };
+
+struct page_options {
+  huge_pages huge = huge_pages::transparent;
+  numa_policy numa = numa_policy::local;
+  int node = 0;
+  // Smaller allocations are served by the upstream resource
+  size_t threshold = size_t(1) << 21;
+};
+
+// Large blocks mapped directly from the system, with their own huge page and placement policy
+// Policies are hints, a kernel or platform that rejects them leaves the default placement
+class IG_API page_resource : public std::pmr::memory_resource {
+public:
+  explicit page_resource(const page_options& options = {}, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+  auto options() const -> const page_options& { return options_; }
+  auto mapped() const -> size_t { return mapped_; }
+
+  page_resource(const page_resource&) = delete;
+  page_resource& operator=(const page_resource&) = delete;
+
+protected:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+
+private:
+  page_options options_;
+  std::pmr::memory_resource* upstream_;
+  std::atomic<size_t> mapped_;
+};
+
+// Where the pages of [ptr, ptr + bytes) actually are
+// nodes[i] counts the resident base pages on node i, absent pages are not faulted yet
+// huge counts the bytes backed by huge pages in the mappings that hold the range
+struct page_report {
+  size_t pages = 0;
+  size_t absent = 0;
+  size_t huge = 0;
+  std::vector<size_t> nodes;
+};
+
+IG_API auto numa_nodes() -> size_t;
+IG_API auto page_placement(const void* ptr, size_t bytes) -> page_report;
+
+} // namespace ig
+
+#endif // IG_CORE_PAGES_H
@@ -0,0 +1,59 @@
+/*
+ Imagine v0.1
+ [core]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_CORE_UNROLL_H
+#define IG_CORE_UNROLL_H
+
+#include "imagine/ig.h"
+
+#include <array>
+#include <utility>
+
+namespace ig {
+
+template <typename Fn, size_t... I>
+constexpr void unroll_impl(Fn&& fn, std::index_sequence<I...>)
+{
+  (fn(std::integral_constant<size_t, I>{}), ...);
+}
+
+// fn(0), ..., fn(N - 1) as straight-line code, indices are compile-time constants
+template <size_t N, typename Fn>
+constexpr void unroll(Fn&& fn)
+{
+  unroll_impl(std::forward<Fn>(fn), std::make_index_sequence<N>());
+}
+
+// op over fn(First), ..., fn(First + N - 1) as a balanced tree, independent halves keep the pipeline busy
+template <size_t N, size_t First = 0, typename Fn, typename Op>
+constexpr auto unroll_fold(Fn&& fn, Op&& op)
+{
+  static_assert(N > 0, "Invalid unrolled fold, empty range");
+  if constexpr (N == 1)
+    return fn(std::integral_constant<size_t, First>{});
+  else
+    return op(
+      unroll_fold<N / 2, First>        (fn, op),
+      unroll_fold<N - N / 2, First + N / 2>(fn, op));
+}
+
+// Long folds keep W interleaved partials, so that successive steps are independent and can share a register
+template <size_t N, size_t W = 8, typename Fn, typename Op>
+constexpr auto unroll_reduce(Fn&& fn, Op&& op)
+{
+  if constexpr (N <= W) {
+    return unroll_fold<N>(fn, op);
+  } else {
+    std::array<decltype(fn(std::integral_constant<size_t, 0>{})), W> acc{};
+    unroll<W>([&](auto w) { acc[w] = fn(w); });
+    unroll<N - W>([&](auto i) { acc[i % W] = op(acc[i % W], fn(std::integral_constant<size_t, i + W>{})); });
+    return unroll_fold<W>([&](auto w) { return acc[w]; }, op);
+  }
+}
+
+} // namespace ig
+
+#endif // IG_CORE_UNROLL_H
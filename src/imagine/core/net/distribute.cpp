@@ -0,0 +1,21 @@
+/*
+ Imagine v0.1
+ [core]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/core/net/distribute.h"
+
+namespace ig {
+
+job& pool() {
+  static job workers{std::max(std::thread::hardware_concurrency(), 2u) - 1};
+  return workers;
+}
+
+bool& in_parallel() {
+  thread_local bool nested = false;
+  return nested;
+}
+
+} // namespace ig
@@ -7,10 +7,59 @@
 #ifndef IG_CORE_DISTRIBUTE_H
 #define IG_CORE_DISTRIBUTE_H
 
-#include "imagine/ig.h"
+#include "imagine/core/net/job.h"
 
 namespace ig {
 
+// Shared workers for data-parallel kernels
+IG_API job& pool();
+IG_API bool& in_parallel();
+
+// Split [begin, end) in contiguous ranges of at least grain elements, fn(first, last) runs on each range
+// nested calls from a running range are executed serially
+template <typename Callable>
+void parallel_for(size_t begin, size_t end, size_t grain, Callable&& fn) {
+  if (begin >= end)
+    return;
+
+  auto n = end - begin;
+  auto ranges = in_parallel()
+    ? size_t(1)
+    : std::min(pool().size() + 1, (n + grain - 1) / std::max<size_t>(grain, 1));
+  if (ranges <= 1) {
+    fn(begin, end);
+    return;
+  }
+
+  auto range = [&fn](size_t first, size_t last) {
+    auto& nested = in_parallel();
+    auto prev = nested;
+    nested = true;
+    try { fn(first, last); } catch (...) { nested = prev; throw; }
+    nested = prev;
+  };
+
+  std::vector< std::future<void> > futures;
+  futures.reserve(ranges - 1);
+  auto step = n / ranges, rem = n % ranges;
+  auto first = begin;
+  for (size_t i = 0; i < ranges - 1; ++i) {
+    auto last = first + step + (i < rem);
+    futures.emplace_back(pool().work(range, first, last));
+    first = last;
+  }
+
+  // Ranges reference fn, all of them must end before leaving
+  std::exception_ptr error;
+  try { range(first, end); } catch (...) { error = std::current_exception(); }
+  for (auto& f : futures) {
+    try { f.get(); } catch (...) { if (!error) error = std::current_exception(); }
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
 } // namespace ig
 
 #endif // IG_CORE_DISTRIBUTE_H
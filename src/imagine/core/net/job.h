@@ -20,6 +20,7 @@ public:
   ~job();
 
   void wait();
+  auto size() const { return workers_.size(); }
   template <typename Callable, typename... Args> auto work(Callable&& fn, Args&&... args);
 
   job(const job&) = delete;
@@ -0,0 +1,43 @@
+/*
+ Imagine v0.1
+ [envi]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_ENVI_MAPPING_IMPL_H
+#define IG_ENVI_MAPPING_IMPL_H
+
+#include "imagine/envi/impl_arch/config_impl.h"
+#include "imagine/envi/mapping.h"
+
+namespace ig   {
+namespace impl {
+
+class mapping_impl {
+public:
+  mapping_impl();
+  ~mapping_impl() = default;
+
+  map_mode mode_;
+
+  // Views start on a page boundary, data_ skips the head of the first page
+  void* base_;
+  size_t length_;
+  std::byte* data_;
+  size_t size_;
+
+  #if defined(IG_WIN)
+  HANDLE file_;
+  HANDLE map_;
+  // kernel32
+  // <windows.h>
+  #elif defined(IG_UNIX)
+  int file_;
+  // <sys/mman.h>
+  #endif
+};
+
+} // namespace impl
+} // namespace ig
+
+#endif // IG_ENVI_MAPPING_IMPL_H
@@ -0,0 +1,120 @@
+/*
+ Imagine v0.1
+ [envi]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/envi/impl_arch/mapping_impl.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace ig   {
+namespace impl {
+
+mapping_impl::mapping_impl()
+  : mode_{map_mode::read}
+  , base_{nullptr}
+  , length_{0}
+  , data_{nullptr}
+  , size_{0}
+  , file_{-1} {}
+
+} // namespace impl
+
+bool mapping::open(const std::string& path, map_mode mode, size_t size, size_t offset) {
+  close();
+
+  auto writable = mode == map_mode::write;
+  native_->file_ = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+  if (native_->file_ < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(native_->file_, &st) != 0) {
+    close();
+    return false;
+  }
+
+  auto extent = size_t(st.st_size);
+  if (!size) {
+    size = extent > offset ? extent - offset : 0;
+  } else if (offset + size > extent) {
+    if (!writable || ftruncate(native_->file_, off_t(offset + size)) != 0) {
+      close();
+      return false;
+    }
+  }
+
+  if (!size) {
+    close();
+    return false;
+  }
+
+  auto page = size_t(sysconf(_SC_PAGESIZE));
+  auto head = offset % page;
+  auto prot = mode == map_mode::read ? PROT_READ : PROT_READ | PROT_WRITE;
+  auto flags = mode == map_mode::copy ? MAP_PRIVATE : MAP_SHARED;
+
+  auto base = mmap(nullptr, head + size, prot, flags, native_->file_, off_t(offset - head));
+  if (base == MAP_FAILED) {
+    close();
+    return false;
+  }
+
+  native_->mode_ = mode;
+  native_->base_ = base;
+  native_->length_ = head + size;
+  native_->data_ = static_cast<std::byte*>(base) + head;
+  native_->size_ = size;
+  return true;
+}
+
+void mapping::close() {
+  if (native_->base_) {
+    munmap(native_->base_, native_->length_);
+    native_->base_ = nullptr;
+    native_->data_ = nullptr;
+    native_->length_ = 0;
+    native_->size_ = 0;
+  }
+  if (native_->file_ >= 0) {
+    ::close(native_->file_);
+    native_->file_ = -1;
+  }
+}
+
+bool mapping::flush(bool async) {
+  if (!native_->base_ || native_->mode_ != map_mode::write)
+    return false;
+  return msync(native_->base_, native_->length_, async ? MS_ASYNC : MS_SYNC) == 0;
+}
+
+// Dropping private pages would discard their copy-on-write changes, it is rejected
+bool mapping::advise(map_advice advice) {
+  if (!native_->base_ || (advice == map_advice::dontneed && native_->mode_ == map_mode::copy))
+    return false;
+
+  auto hint = MADV_NORMAL;
+  switch (advice) {
+  case map_advice::normal:     hint = MADV_NORMAL;     break;
+  case map_advice::sequential: hint = MADV_SEQUENTIAL; break;
+  case map_advice::random:     hint = MADV_RANDOM;     break;
+  case map_advice::willneed:   hint = MADV_WILLNEED;   break;
+  case map_advice::dontneed:   hint = MADV_DONTNEED;   break;
+  }
+  return madvise(native_->base_, native_->length_, hint) == 0;
+}
+
+// Transparent huge pages, only honoured when the kernel supports them for file-backed memory
+bool mapping::huge_pages() {
+#if defined(MADV_HUGEPAGE)
+  return native_->base_ && madvise(native_->base_, native_->length_, MADV_HUGEPAGE) == 0;
+#else
+  return false;
+#endif
+}
+
+} // namespace ig
@@ -0,0 +1,131 @@
+/*
+ Imagine v0.1
+ [envi]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/envi/impl_arch/mapping_impl.h"
+
+namespace ig   {
+namespace impl {
+
+mapping_impl::mapping_impl()
+  : mode_{map_mode::read}
+  , base_{nullptr}
+  , length_{0}
+  , data_{nullptr}
+  , size_{0}
+  , file_{INVALID_HANDLE_VALUE}
+  , map_{nullptr} {}
+
+} // namespace impl
+
+bool mapping::open(const std::string& path, map_mode mode, size_t size, size_t offset) {
+  close();
+
+  auto writable = mode == map_mode::write;
+  native_->file_ = CreateFileA(
+    path.c_str(),
+    writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+    FILE_SHARE_READ,
+    nullptr,
+    writable ? OPEN_ALWAYS : OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL,
+    nullptr);
+  if (native_->file_ == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER st;
+  if (!GetFileSizeEx(native_->file_, &st)) {
+    close();
+    return false;
+  }
+
+  auto extent = size_t(st.QuadPart);
+  if (!size)
+    size = extent > offset ? extent - offset : 0;
+  if (!size || (!writable && offset + size > extent)) {
+    close();
+    return false;
+  }
+
+  // Views must start on the allocation granularity
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  auto head = offset % info.dwAllocationGranularity;
+  auto start = uint64_t(offset - head);
+  auto end = uint64_t(offset + size);
+
+  native_->map_ = CreateFileMappingA(
+    native_->file_,
+    nullptr,
+    mode == map_mode::read ? PAGE_READONLY : mode == map_mode::write ? PAGE_READWRITE : PAGE_WRITECOPY,
+    DWORD(end >> 32),
+    DWORD(end & 0xffffffff),
+    nullptr);
+  if (!native_->map_) {
+    close();
+    return false;
+  }
+
+  auto base = MapViewOfFile(
+    native_->map_,
+    mode == map_mode::read ? FILE_MAP_READ : mode == map_mode::write ? FILE_MAP_WRITE : FILE_MAP_COPY,
+    DWORD(start >> 32),
+    DWORD(start & 0xffffffff),
+    head + size);
+  if (!base) {
+    close();
+    return false;
+  }
+
+  native_->mode_ = mode;
+  native_->base_ = base;
+  native_->length_ = head + size;
+  native_->data_ = static_cast<std::byte*>(base) + head;
+  native_->size_ = size;
+  return true;
+}
+
+void mapping::close() {
+  if (native_->base_) {
+    UnmapViewOfFile(native_->base_);
+    native_->base_ = nullptr;
+    native_->data_ = nullptr;
+    native_->length_ = 0;
+    native_->size_ = 0;
+  }
+  if (native_->map_) {
+    CloseHandle(native_->map_);
+    native_->map_ = nullptr;
+  }
+  if (native_->file_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(native_->file_);
+    native_->file_ = INVALID_HANDLE_VALUE;
+  }
+}
+
+bool mapping::flush(bool async) {
+  if (!native_->base_ || native_->mode_ != map_mode::write)
+    return false;
+  return FlushViewOfFile(native_->base_, native_->length_)
+    && (async || FlushFileBuffers(native_->file_));
+}
+
+// Only prefetching has a counterpart, other hints are accepted and ignored
+bool mapping::advise(map_advice advice) {
+  if (!native_->base_ || (advice == map_advice::dontneed && native_->mode_ == map_mode::copy))
+    return false;
+  if (advice != map_advice::willneed)
+    return true;
+
+  WIN32_MEMORY_RANGE_ENTRY range{native_->base_, native_->length_};
+  return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+// Large pages are unavailable for file-backed views
+bool mapping::huge_pages() {
+  return false;
+}
+
+} // namespace ig
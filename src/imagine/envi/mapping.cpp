@@ -0,0 +1,49 @@
+/*
+ Imagine v0.1
+ [envi]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/envi/impl_arch/mapping_impl.h"
+#include "imagine/envi/mapping.h"
+
+namespace ig {
+
+mapping::mapping()
+  : native_{std::make_unique<impl::mapping_impl>()} {}
+
+mapping::mapping(const std::string& path, map_mode mode, size_t size, size_t offset)
+  : native_{std::make_unique<impl::mapping_impl>()} {
+  if (!open(path, mode, size, offset)) {
+    throw std::runtime_error{
+      "[Mapping] Failed to map " + path +
+      " (inexistant, inaccessible or too small resource)"};
+  }
+}
+
+mapping::~mapping() {
+  close();
+}
+
+bool mapping::is_open() const
+{ return native_->base_ != nullptr; }
+
+auto mapping::data() const -> std::byte*
+{ return native_->data_; }
+
+auto mapping::size() const -> size_t
+{ return native_->size_; }
+
+auto mapping::mode() const -> map_mode
+{ return native_->mode_; }
+
+// Native implementations
+//
+
+// bool mapping::open(const std::string& path, map_mode mode, size_t size, size_t offset);
+// void mapping::close();
+// bool mapping::flush(bool async);
+// bool mapping::advise(map_advice advice);
+// bool mapping::huge_pages();
+
+} // namespace ig
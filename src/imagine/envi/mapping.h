@@ -0,0 +1,51 @@
+/*
+ Imagine v0.1
+ [envi]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_ENVI_MAPPING_H
+#define IG_ENVI_MAPPING_H
+
+#include "imagine/ig.h"
+
+namespace ig   {
+namespace impl { class mapping_impl; }
+
+// read:  shared read-only pages
+// write: shared pages, stores reach the file (created or extended when needed)
+// copy:  private copy-on-write pages, the file is never modified
+enum class map_mode   { read, write, copy };
+
+// dontneed releases the pages, it is rejected on copy mappings where it would discard their changes
+enum class map_advice { normal, sequential, random, willneed, dontneed };
+
+class IG_API mapping {
+public:
+  mapping();
+  explicit mapping(const std::string& path, map_mode mode = map_mode::read, size_t size = 0, size_t offset = 0);
+  virtual ~mapping();
+
+  // A null size maps the file from offset to its end
+  bool open(const std::string& path, map_mode mode = map_mode::read, size_t size = 0, size_t offset = 0);
+  void close();
+
+  bool flush(bool async = false);
+  bool advise(map_advice advice);
+  bool huge_pages();
+
+  bool is_open() const;
+  auto data() const -> std::byte*;
+  auto size() const -> size_t;
+  auto mode() const -> map_mode;
+
+  mapping(const mapping&) = delete;
+  mapping& operator=(const mapping&) = delete;
+
+private:
+  std::unique_ptr<impl::mapping_impl> native_;
+};
+
+} // namespace ig
+
+#endif // IG_ENVI_MAPPING_H
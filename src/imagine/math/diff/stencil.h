@@ -0,0 +1,431 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_STENCIL_H
+#define IG_MATH_STENCIL_H
+
+#include "imagine/math/theory/ndarray.h"
+#include "imagine/core/net/distribute.h"
+
+namespace ig   {
+namespace diff {
+
+// periodic:  neighbours wrap around every dimension
+// dirichlet: neighbours outside of the grid hold a fixed value
+// ghost:     the outer radius layers are boundary data, copied and never updated
+enum class boundary { periodic, dirichlet, ghost };
+
+template <typename T>
+struct bounds {
+  boundary kind = boundary::periodic;
+  T value = 0;
+};
+
+template <typename T> auto periodic()             { return bounds<T>{boundary::periodic, 0}; }
+template <typename T> auto dirichlet(T value = 0) { return bounds<T>{boundary::dirichlet, value}; }
+template <typename T> auto ghost()                { return bounds<T>{boundary::ghost, 0}; }
+
+// Linear neighbourhood, out(x) = sum of weight * in(x + offset) over the taps
+template <typename T>
+class stencil {
+public:
+  struct tap {
+    nd::stride_array offset;
+    T weight;
+  };
+
+  explicit stencil(size_t dims) : dims_{dims} {}
+
+  auto& add(const nd::stride_array& offset, T weight);
+
+  auto dims() const   { return dims_; }
+  auto& taps() const  { return taps_; }
+  auto radius() const;
+
+  auto operator*(T s) const;
+  auto operator+(const stencil& o) const;
+
+  static auto identity(size_t dims);
+  // Second order central differences, 2 * dims + 1 points
+  static auto laplacian(size_t dims, T h = 1);
+
+private:
+  size_t dims_;
+  std::vector<tap> taps_;
+};
+
+template <typename T>
+auto& stencil<T>::add(const nd::stride_array& offset, T weight) {
+  assert(offset.size() == dims_ && "Invalid stencil offset");
+  for (auto& t : taps_) {
+    if (std::equal(offset.begin(), offset.end(), t.offset.begin())) {
+      t.weight += weight;
+      return *this;
+    }
+  } taps_.push_back({offset, weight});
+  return *this;
+}
+
+template <typename T>
+auto stencil<T>::radius() const {
+  size_t r = 0;
+  for (auto& t : taps_)
+    for (auto o : t.offset) r = std::max(r, size_t(o < 0 ? -o : o));
+  return r;
+}
+
+template <typename T>
+auto stencil<T>::operator*(T s) const {
+  auto res = *this;
+  for (auto& t : res.taps_) t.weight *= s;
+  return res;
+}
+
+template <typename T>
+auto stencil<T>::operator+(const stencil& o) const {
+  assert(dims_ == o.dims_ && "Incoherent stencil dimensions");
+  auto res = *this;
+  for (auto& t : o.taps_) res.add(t.offset, t.weight);
+  return res;
+}
+
+template <typename T>
+auto stencil<T>::identity(size_t dims) {
+  stencil res{dims};
+  res.add(nd::stride_array(dims, 0), 1);
+  return res;
+}
+
+template <typename T>
+auto stencil<T>::laplacian(size_t dims, T h) {
+  auto w = 1 / (h * h);
+  stencil res{dims};
+  res.add(nd::stride_array(dims, 0), -2 * T(dims) * w);
+  for (size_t k = 0; k < dims; ++k) {
+    nd::stride_array o(dims, 0);
+    o[k] = -1; res.add(o, w);
+    o[k] = +1; res.add(o, w);
+  } return res;
+}
+
+namespace detail {
+
+// Stencil resolved on a dense grid, dimensions that do not wrap are windows of a larger one
+template <typename T>
+struct stencil_plan {
+  stencil_plan(const stencil<T>& s, const nd::shape_array& shape, const bounds<T>& bc)
+    : shape{shape}
+    , strides{nd::dense_strides(shape)}
+    , wrap(shape.size(), bc.kind == boundary::periodic)
+    , radius{s.radius()}
+    , bc{bc} {
+    for (auto& t : s.taps()) {
+      std::ptrdiff_t f = 0;
+      for (size_t k = 0; k < shape.size(); ++k) f += t.offset[k] * strides[k];
+      offsets.push_back(t.offset);
+      flat.push_back(f);
+      weights.push_back(t.weight);
+    }
+  }
+
+  auto dims() const { return shape.size(); }
+
+  nd::shape_array shape;
+  nd::stride_array strides;
+  nd::dims_array<bool> wrap;
+  size_t radius;
+  bounds<T> bc;
+
+  std::vector<nd::stride_array> offsets;
+  std::vector<std::ptrdiff_t> flat;
+  std::vector<T> weights;
+};
+
+// Neighbour resolved through the boundary, only reached near the faces
+template <typename T>
+T neighbour(const stencil_plan<T>& p, const T* in, const size_t* c, const nd::stride_array& off) {
+  std::ptrdiff_t idx = 0;
+  for (size_t k = 0; k < p.dims(); ++k) {
+    auto n = std::ptrdiff_t(p.shape[k]);
+    auto x = std::ptrdiff_t(c[k]) + off[k];
+    if (x < 0 || x >= n) {
+      if (!p.wrap[k])
+        return p.bc.value;
+      x = (x % n + n) % n;
+    } idx += x * p.strides[k];
+  } return in[idx];
+}
+
+// Interior run of a row, every neighbour is a fixed offset away
+// taps are copied locally so that stores to the row cannot alias them
+template <typename T>
+void sweep_run(const stencil_plan<T>& p, const T* in, T* out, size_t first, size_t last) {
+  constexpr size_t max_taps = 32;
+  auto taps = p.flat.size();
+  if (taps > max_taps) {
+    for (auto x = first; x < last; ++x) {
+      T acc = 0;
+      for (size_t t = 0; t < taps; ++t) acc += p.weights[t] * in[x + p.flat[t]];
+      out[x] = acc;
+    } return;
+  }
+
+  const T* src[max_taps];
+  T w[max_taps];
+  for (size_t t = 0; t < taps; ++t)
+    src[t] = in + p.flat[t],
+    w[t] = p.weights[t];
+
+  auto x = first;
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<T, float>) {
+    for (; x + 2 * IG_PACKET_WIDE <= last; x += 2 * IG_PACKET_WIDE) {
+      auto w0 = packet{w[0]};
+      auto acc0 = w0 * nd::load(src[0] + x);
+      auto acc1 = w0 * nd::load(src[0] + x + IG_PACKET_WIDE);
+      for (size_t t = 1; t < taps; ++t) {
+        auto wt = packet{w[t]};
+        acc0 = acc0 + wt * nd::load(src[t] + x);
+        acc1 = acc1 + wt * nd::load(src[t] + x + IG_PACKET_WIDE);
+      }
+      nd::store(out + x, acc0);
+      nd::store(out + x + IG_PACKET_WIDE, acc1);
+    }
+  }
+#endif
+  for (; x < last; ++x) {
+    T acc = 0;
+    for (size_t t = 0; t < taps; ++t) acc += w[t] * src[t][x];
+    out[x] = acc;
+  }
+}
+
+// Row along the first dimension at the outer coordinates c[1..]
+template <typename T>
+void sweep_row(const stencil_plan<T>& p, const T* in, T* out, size_t* c) {
+  auto n = p.shape[0], r = p.radius;
+  std::ptrdiff_t base = 0;
+  auto interior = true;
+  for (size_t k = 1; k < p.dims(); ++k)
+    base += std::ptrdiff_t(c[k]) * p.strides[k],
+    interior = interior && c[k] >= r && c[k] + r < p.shape[k];
+
+  auto row_in = in + base;
+  auto row_out = out + base;
+  auto edge = [&](size_t first, size_t last) {
+    for (c[0] = first; c[0] < last; ++c[0]) {
+      T acc = 0;
+      for (size_t t = 0; t < p.weights.size(); ++t) acc += p.weights[t] * neighbour(p, in, c, p.offsets[t]);
+      row_out[c[0]] = acc;
+    }
+  };
+
+  if (p.bc.kind == boundary::ghost) {
+    if (!interior || n <= 2 * r) {
+      std::copy_n(row_in, n, row_out);
+      return;
+    }
+    std::copy_n(row_in, r, row_out);
+    std::copy_n(row_in + n - r, r, row_out + n - r);
+    sweep_run(p, row_in, row_out, r, n - r);
+  } else if (!interior || n <= 2 * r) {
+    edge(0, n);
+  } else {
+    edge(0, r);
+    sweep_run(p, row_in, row_out, r, n - r);
+    edge(n - r, n);
+  }
+}
+
+// Rows whose last coordinate lies in [first, last), blocked along the second dimension
+// so that the planes touched by neighbouring rows stay in cache, and split across the job pool
+template <typename T>
+void sweep(const stencil_plan<T>& p, const T* in, T* out, size_t first, size_t last, size_t block = 16) {
+  auto d = p.dims();
+  if (d == 1) {
+    size_t c[1] = {0};
+    sweep_row(p, in, out, c);
+    return;
+  }
+
+  if (d == 2) {
+    parallel_for(first, last, std::max<size_t>(1, nd::parallel_grain / p.shape[0]), [&](size_t f, size_t l) {
+      size_t c[2] = {0, 0};
+      for (c[1] = f; c[1] < l; ++c[1]) sweep_row(p, in, out, c);
+    }); return;
+  }
+
+  // Outer rows span dimensions 2..d-1, the last one restricted to [first, last)
+  size_t outer = last - first;
+  for (size_t k = 2; k + 1 < d; ++k) outer *= p.shape[k];
+  auto ny = p.shape[1];
+  auto blocks = (ny + block - 1) / block;
+  auto chunk = std::max<size_t>(1, nd::parallel_grain / (p.shape[0] * ny));
+  auto chunks = (outer + chunk - 1) / chunk;
+
+  parallel_for(0, blocks * chunks, 1, [&](size_t f, size_t l) {
+    size_t c[nd::max_dims] = {};
+    for (auto task = f; task < l; ++task) {
+      auto yb = task % blocks, oc = task / blocks;
+      for (auto o = oc * chunk; o < std::min(outer, (oc + 1) * chunk); ++o) {
+        auto rest = o;
+        for (size_t k = 2; k + 1 < d; ++k)
+          c[k] = rest % p.shape[k],
+          rest /= p.shape[k];
+        c[d - 1] = first + rest;
+        for (c[1] = yb * block; c[1] < std::min(ny, (yb + 1) * block); ++c[1])
+          sweep_row(p, in, out, c);
+      }
+    }
+  });
+}
+
+} // namespace detail
+
+// out = s(in), out must have the shape of in
+template <typename T>
+void apply(const stencil<T>& s, const ndarray<T>& in, ndarray<T>& out, const bounds<T>& bc = {}) {
+  assert(
+    s.dims() == in.dims() &&
+    out.size() == in.size() &&
+    in.buffer() != out.buffer() && "Invalid stencil operands");
+
+  nd::shape_array shape{in.shape().begin(), in.shape().end()};
+  detail::stencil_plan<T> p{s, shape, bc};
+  detail::sweep(p, in.buffer(), out.buffer(), 0, shape[shape.size() - 1]);
+}
+
+// u = s^steps(u), time steps are fused by depth over tiles of the second and last dimensions
+// every tile is advanced in a private buffer extended by depth * radius on its cut faces,
+// the overlap is computed redundantly so that a tile is read from memory once per depth steps
+template <typename T>
+void advance(const stencil<T>& s, ndarray<T>& u, size_t steps, const bounds<T>& bc = {}, size_t depth = 4, size_t tile = 32) {
+  assert(s.dims() == u.dims() && "Invalid stencil operands");
+  nd::shape_array shape{u.shape().begin(), u.shape().end()};
+  ndarray<T> next{shape};
+
+  auto d = shape.size();
+  auto r = s.radius();
+  if (d < 2 || depth <= 1 || r == 0) {
+    detail::stencil_plan<T> p{s, shape, bc};
+    for (size_t n = 0; n < steps; ++n) {
+      detail::sweep(p, u.buffer(), next.buffer(), 0, shape[d - 1]);
+      std::swap(u, next);
+    } return;
+  }
+
+  // Windowed dimensions, tiles are thinner along the last one which has the largest stride
+  size_t win[2] = {1, d - 1}, edge[2] = {tile, std::max<size_t>(1, tile / 2)};
+  auto wins = d == 2 ? size_t(1) : size_t(2);
+  if (d == 2) edge[0] = edge[1];
+
+  size_t tiles[2] = {1, 1};
+  for (size_t w = 0; w < wins; ++w) tiles[w] = (shape[win[w]] + edge[w] - 1) / edge[w];
+
+  auto n0 = shape[0];
+  auto periodic = bc.kind == boundary::periodic;
+  auto global = nd::dense_strides(shape);
+
+  // Rows of a grid within per-dimension ranges of the outer coordinates
+  auto rows = [d](const nd::shape_array& lo, const nd::shape_array& hi, auto&& fn) {
+    size_t c[nd::max_dims] = {};
+    for (size_t k = 1; k < d; ++k) {
+      if (lo[k] >= hi[k]) return;
+      c[k] = lo[k];
+    }
+    for (;;) {
+      fn(c);
+      size_t k = 1;
+      for (; k < d && ++c[k] == hi[k]; ++k) c[k] = lo[k];
+      if (k == d) return;
+    }
+  };
+
+  for (size_t n = 0; n < steps; n += depth) {
+    auto t = std::min(depth, steps - n);
+    auto halo = std::ptrdiff_t(t * r);
+    const T* src = u.buffer();
+    T* dst = next.buffer();
+
+    parallel_for(0, tiles[0] * tiles[1], 1, [&](size_t f, size_t l) {
+      std::vector<T> a, b;
+      for (auto task = f; task < l; ++task) {
+        auto local = shape;
+        nd::stride_array lo(d, 0), core_lo(d, 0), core_hi(d, 0);
+        nd::dims_array<bool> cut_lo(d, false), cut_hi(d, false);
+        for (size_t k = 1; k < d; ++k) core_hi[k] = std::ptrdiff_t(shape[k]);
+
+        for (size_t w = 0, id = task; w < wins; ++w) {
+          auto k = win[w], i = id % tiles[w]; id /= tiles[w];
+          auto nk = std::ptrdiff_t(shape[k]);
+          core_lo[k] = std::ptrdiff_t(i * edge[w]);
+          core_hi[k] = std::min(nk, std::ptrdiff_t((i + 1) * edge[w]));
+
+          auto l0 = core_lo[k] - halo, h0 = core_hi[k] + halo;
+          if (!periodic)
+            l0 = std::max<std::ptrdiff_t>(l0, 0),
+            h0 = std::min(h0, nk);
+          lo[k] = l0;
+          local[k] = size_t(h0 - l0);
+          cut_lo[k] = periodic || l0 > 0;
+          cut_hi[k] = periodic || h0 < nk;
+        }
+
+        detail::stencil_plan<T> p{s, local, bc};
+        for (size_t w = 0; w < wins; ++w) p.wrap[win[w]] = false;
+
+        auto size = std::accumulate(local.begin(), local.end(), size_t(1), std::multiplies<>{});
+        a.resize(size);
+        b.resize(size);
+
+        // Gather, periodic tiles wrap around the grid
+        nd::shape_array all_lo(d, 0), all_hi = local;
+        rows(all_lo, all_hi, [&](size_t* c) {
+          std::ptrdiff_t g = 0, o = 0;
+          for (size_t k = 1; k < d; ++k) {
+            auto nk = std::ptrdiff_t(shape[k]);
+            auto x = ((lo[k] + std::ptrdiff_t(c[k])) % nk + nk) % nk;
+            g += x * global[k];
+            o += std::ptrdiff_t(c[k]) * p.strides[k];
+          } std::copy_n(src + g, n0, a.data() + o);
+        });
+
+        // Cut faces lose radius valid layers per step, physical faces keep their boundary
+        for (size_t k = 1; k <= t; ++k) {
+          nd::shape_array first(d, 0), last = local;
+          for (size_t w = 0; w < wins; ++w) {
+            auto m = win[w];
+            if (cut_lo[m]) first[m] = k * r;
+            if (cut_hi[m]) last[m] = local[m] - k * r;
+          }
+          rows(first, last, [&](size_t* c) { detail::sweep_row(p, a.data(), b.data(), c); });
+          std::swap(a, b);
+        }
+
+        // Scatter the core of the tile
+        nd::shape_array out_lo(d, 0), out_hi = local;
+        for (size_t w = 0; w < wins; ++w) {
+          auto m = win[w];
+          out_lo[m] = size_t(core_lo[m] - lo[m]);
+          out_hi[m] = size_t(core_hi[m] - lo[m]);
+        }
+        rows(out_lo, out_hi, [&](size_t* c) {
+          std::ptrdiff_t g = 0, o = 0;
+          for (size_t k = 1; k < d; ++k)
+            g += (lo[k] + std::ptrdiff_t(c[k])) * global[k],
+            o += std::ptrdiff_t(c[k]) * p.strides[k];
+          std::copy_n(a.data() + o, n0, dst + g);
+        });
+      }
+    });
+    std::swap(u, next);
+  }
+}
+
+} // namespace diff
+} // namespace ig
+
+#endif // IG_MATH_STENCIL_H
@@ -8,6 +8,8 @@
 #define IG_MATH_MESH_H
 
 #include "imagine/math/geom/representation/analytic/triangle.h"
+#include "imagine/math/lin/reorder/graph.h"
+#include "imagine/math/lin/reorder/permute.h"
 
 #include <array>
 
@@ -25,6 +27,9 @@ public:
 
   auto center_of_mass() const;
 
+  auto graph() const -> lin::graph;
+  void permute(const std::vector<size_t>& perm);
+
   std::vector<face>   faces;
   std::vector<vertex> vertices;
 
@@ -70,6 +75,40 @@ auto mesh<Manifold>::center_of_mass() const {
   } return c / w;
 }
 
+// Vertex adjacency through face edges
+template <typename Manifold>
+auto mesh<Manifold>::graph() const -> lin::graph {
+  auto n = vertices.size();
+  std::vector<std::pair<size_t, size_t>> edges;
+  edges.reserve(faces.size() * 6);
+  for (auto& face : faces)
+    for (size_t k = 0; k < 3; ++k)
+      edges.emplace_back(face[k], face[(k + 1) % 3]),
+      edges.emplace_back(face[(k + 1) % 3], face[k]);
+
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  lin::graph g{std::vector<size_t>(n + 1, 0), {}};
+  g.adj.reserve(edges.size());
+  for (auto& [i, j] : edges)
+    g.ptr[i + 1]++,
+    g.adj.push_back(j);
+  std::partial_sum(g.ptr.begin(), g.ptr.end(), g.ptr.begin());
+  return g;
+}
+
+// Renumber vertices with perm[new] = old, faces follow
+template <typename Manifold>
+void mesh<Manifold>::permute(const std::vector<size_t>& perm) {
+  assert(perm.size() == vertices.size() && "Incoherent mesh vertex permutation");
+  auto iperm = lin::inverse(perm);
+
+  vertices = lin::permute(vertices, perm);
+  for (auto& face : faces)
+    for (auto& v : face) v = uint32_t(iperm[v]);
+}
+
 } // namespace ig
 
 #endif // IG_MATH_MESH_H
@@ -12,19 +12,50 @@
 namespace ig  {
 namespace lin {
 
+// Static vectors are reduced by an unrolled tree without any intermediate expression, others pairwise
+// a compensated sum carries the rounding error of every addition, 16-bit elements are accumulated and returned in float
 template
 < typename Lhs,
   typename Rhs >
-constexpr auto dot(const matrix_base<Lhs>& lhs, const matrix_base<Rhs>& rhs)
-{ return (lhs * rhs).sum(); }
+constexpr auto dot(const matrix_base<Lhs>& lhs, const matrix_base<Rhs>& rhs, summation mode = summation::pairwise) {
+  using value_type = std::common_type_t< matrix_t<Lhs>, matrix_t<Rhs> >;
+  using accum_type = accum_t<value_type>;
+  auto term = [&lhs, &rhs](size_t i) { return accum_type(lhs[i]) * accum_type(rhs[i]); };
+  if constexpr (std::is_floating_point_v<accum_type>) {
+    if (mode == summation::compensated) {
+      assert(lhs.size() == rhs.size() && "Invalid dot product, incoherent sizes");
+      return cwise_compensated<accum_type>(lhs.size(), term);
+    }
+  }
+  if constexpr (is_unrolled<Lhs> && is_unrolled<Rhs> && static_size<Lhs> == static_size<Rhs>) {
+    if (lhs.size() == static_size<Lhs> && rhs.size() == static_size<Rhs>)
+      return accum_type(unroll_fold< static_size<Lhs> >([&](auto i) { return term(i); }, std::plus<>{}));
+  }
+#if defined(IG_SSE)
+  if constexpr (is_dense_matrix<Lhs>::value && is_dense_matrix<Rhs>::value && std::is_same_v<matrix_t<Lhs>, float> && std::is_same_v<matrix_t<Rhs>, float>) {
+    assert(lhs.size() == rhs.size() && "Invalid dot product, incoherent sizes");
+    auto a = lhs.derived().buffer(), b = rhs.derived().buffer();
+    return cwise_reduce<false>(lhs.size(),
+      [a, b](size_t i) { return float4{_mm_loadu_ps(a + i)} * float4{_mm_loadu_ps(b + i)}; },
+      [a, b](size_t i) { return a[i] * b[i]; });
+  }
+#endif
+  assert(lhs.size() == rhs.size() && "Invalid dot product, incoherent sizes");
+  return cwise_reduce<false, accum_type>(lhs.size(), term);
+}
 
 template <typename Mat>
 constexpr auto norm(const matrix_base<Mat>& mat)
 { return std::sqrt(dot(mat, mat)); }
 
+// Static vectors are scaled by the inverse norm, their evaluation is unrolled
 template <typename Mat>
-constexpr auto normalise(const matrix_base<Mat>& mat)
-{ return mat / norm(mat); }
+constexpr auto normalise(const matrix_base<Mat>& mat) {
+  if constexpr (is_unrolled<Mat> && std::is_floating_point_v< matrix_t<Mat> >)
+    return mat * (matrix_t<Mat>(1) / norm(mat));
+  else
+    return mat / norm(mat);
+}
 
 template <typename Mat>
 constexpr auto trace(const matrix_base<Mat>& mat)
@@ -40,7 +40,7 @@ private:
 
 template <typename Mat>
 eigen<Mat, true>::eigen(const matrix_type& mat)
-  : n_{mat.diagsize()}
+  : n_{mat.diag_size()}
   , v_{mat}
   , d_{n_} {
 
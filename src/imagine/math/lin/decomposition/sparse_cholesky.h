@@ -0,0 +1,489 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_SPARSECHOLESKY_H
+#define IG_MATH_SPARSECHOLESKY_H
+
+#include "imagine/math/theory/sparse.h"
+#include "imagine/math/lin/reorder/amd.h"
+#include "imagine/math/lin/reorder/partition.h"
+#include "imagine/core/net/distribute.h"
+
+namespace ig {
+
+enum class fill_ordering { natural, amd, nested_dissection };
+
+// Pattern-only analysis, reusable for every matrix with the same sparsity structure
+struct cholesky_symbolic {
+  struct entry { size_t src, row, col; };
+
+  size_t n, nnz;
+  std::vector<size_t> perm, iperm;
+  std::vector<size_t> parent;
+
+  // Supernodes: columns [super[s], super[s + 1]), rows rows[rows_ptr[s] .. rows_ptr[s + 1])
+  std::vector<size_t> super, super_of, super_parent;
+  std::vector<size_t> children_ptr, children;
+  std::vector<size_t> rows_ptr, rows, values_ptr;
+  // Supernodes grouped by height in the supernodal elimination tree
+  std::vector<size_t> levels_ptr, levels;
+  // Original entries scattered into supernode fronts
+  std::vector<size_t> assembly_ptr;
+  std::vector<entry> assembly;
+
+  auto supernodes() const { return super.size() - 1; }
+  auto factor_nnz() const { return values_ptr.back(); }
+};
+
+template <typename T>
+class sparse_cholesky {
+public:
+  using value_type = T;
+  using sparse_type = sparse<value_type>;
+  using vector_type = colvec<value_type>;
+  using symbolic_type = std::shared_ptr<const cholesky_symbolic>;
+
+  static_assert(std::is_arithmetic<value_type>::value, "Cholesky decomposition requires an arithmetic matrix");
+
+  explicit sparse_cholesky(const sparse_type& mat, fill_ordering ordering = fill_ordering::amd);
+  explicit sparse_cholesky(const sparse_type& mat, symbolic_type symbolic);
+
+  static auto analyse(const sparse_type& mat, fill_ordering ordering = fill_ordering::amd) -> symbolic_type;
+  static auto analyse(const sparse_type& mat, std::vector<size_t> perm) -> symbolic_type;
+
+  void factorize(const sparse_type& mat);
+
+  auto det() const -> value_type;
+  auto log_det() const -> value_type;
+  auto solve(const vector_type& b) const -> vector_type;
+
+  auto& symbolic() const { return symbolic_; }
+  auto& values() const   { return lx_; }
+
+private:
+  void factorize_front(const sparse_type& mat, size_t s, std::vector< std::vector<value_type> >& updates);
+
+  symbolic_type symbolic_;
+  std::vector<value_type> lx_;
+};
+
+template <typename T>
+sparse_cholesky<T>::sparse_cholesky(const sparse_type& mat, fill_ordering ordering)
+  : sparse_cholesky{mat, analyse(mat, ordering)} {}
+
+template <typename T>
+sparse_cholesky<T>::sparse_cholesky(const sparse_type& mat, symbolic_type symbolic)
+  : symbolic_{std::move(symbolic)} {
+  factorize(mat);
+}
+
+template <typename T>
+auto sparse_cholesky<T>::analyse(const sparse_type& mat, fill_ordering ordering) -> symbolic_type {
+  assert(mat.square() && "Cholesky decomposition requires a square matrix");
+  std::vector<size_t> perm(mat.cols());
+  switch (ordering) {
+  case fill_ordering::natural: std::iota(perm.begin(), perm.end(), 0); break;
+  case fill_ordering::amd: perm = lin::amd(mat); break;
+  case fill_ordering::nested_dissection: perm = lin::nested_dissection(mat); break; }
+  return analyse(mat, std::move(perm));
+}
+
+template <typename T>
+auto sparse_cholesky<T>::analyse(const sparse_type& mat, std::vector<size_t> perm) -> symbolic_type {
+  constexpr auto none = std::numeric_limits<size_t>::max();
+  auto sym = std::make_shared<cholesky_symbolic>();
+  auto n = sym->n = mat.cols();
+  sym->nnz = mat.nnz();
+
+  auto& cols = mat.col_ptr();
+  auto& rows = mat.row_ind();
+
+  std::vector<size_t> iperm(n);
+  // Upper pattern of PAP^T by columns (rows i < j), built from the lower triangle of A
+  auto upper = [&](std::vector<size_t>& ptr, std::vector<size_t>& idx) {
+    for (size_t i = 0; i < n; ++i) iperm[perm[i]] = i;
+    ptr.assign(n + 1, 0);
+    for (size_t j = 0; j < n; ++j)
+      for (auto k = cols[j]; k < cols[j + 1]; ++k)
+        if (rows[k] > j)
+          ptr[std::max(iperm[rows[k]], iperm[j]) + 1]++;
+    std::partial_sum(ptr.begin(), ptr.end(), ptr.begin());
+
+    idx.resize(ptr[n]);
+    std::vector<size_t> next(ptr.begin(), ptr.end() - 1);
+    for (size_t j = 0; j < n; ++j)
+      for (auto k = cols[j]; k < cols[j + 1]; ++k)
+        if (rows[k] > j)
+          idx[next[std::max(iperm[rows[k]], iperm[j])]++] = std::min(iperm[rows[k]], iperm[j]);
+  };
+
+  // Elimination tree (Liu)
+  auto etree = [n, none](const std::vector<size_t>& ptr, const std::vector<size_t>& idx) {
+    std::vector<size_t> parent(n, none), ancestor(n, none);
+    for (size_t k = 0; k < n; ++k) {
+      for (auto p = ptr[k]; p < ptr[k + 1]; ++p) {
+        for (auto i = idx[p]; i != none && i < k; ) {
+          auto next = ancestor[i];
+          ancestor[i] = k;
+          if (next == none) parent[i] = k;
+          i = next;
+        }
+      }
+    } return parent;
+  };
+
+  std::vector<size_t> uptr, uidx;
+  upper(uptr, uidx);
+  auto parent = etree(uptr, uidx);
+
+  // Postorder, keeps supernodes contiguous
+  {
+    std::vector<size_t> head(n, none), next(n, none), stack, post;
+    for (size_t j = n; j-- > 0; )
+      if (parent[j] != none)
+        next[j] = head[parent[j]],
+        head[parent[j]] = j;
+
+    post.reserve(n);
+    for (size_t j = 0; j < n; ++j) {
+      if (parent[j] != none) continue;
+      stack.push_back(j);
+      while (!stack.empty()) {
+        auto p = stack.back();
+        if (head[p] != none) {
+          auto c = head[p];
+          head[p] = next[c];
+          stack.push_back(c);
+        } else {
+          stack.pop_back();
+          post.push_back(p);
+        }
+      }
+    }
+
+    std::vector<size_t> postperm(n);
+    for (size_t k = 0; k < n; ++k) postperm[k] = perm[post[k]];
+    perm = std::move(postperm);
+  }
+
+  upper(uptr, uidx);
+  parent = etree(uptr, uidx);
+
+  // Column counts from row subtrees
+  std::vector<size_t> count(n, 1), mark(n, none);
+  for (size_t i = 0; i < n; ++i) {
+    mark[i] = i;
+    for (auto p = uptr[i]; p < uptr[i + 1]; ++p)
+      for (auto j = uidx[p]; mark[j] != i; j = parent[j])
+        mark[j] = i,
+        count[j]++;
+  }
+
+  // Fundamental supernodes
+  std::vector<size_t> children(n, 0);
+  for (size_t j = 0; j < n; ++j)
+    if (parent[j] != none) children[parent[j]]++;
+
+  auto& super = sym->super;
+  auto& super_of = sym->super_of;
+  super_of.resize(n);
+  for (size_t j = 0; j < n; ++j) {
+    if (j == 0 || !(parent[j - 1] == j && count[j - 1] == count[j] + 1 && children[j] == 1))
+      super.push_back(j);
+    super_of[j] = super.size() - 1;
+  }
+  super.push_back(n);
+
+  auto ns = sym->supernodes();
+  auto& sparent = sym->super_parent;
+  sparent.assign(ns, none);
+  for (size_t s = 0; s < ns; ++s) {
+    auto p = parent[super[s + 1] - 1];
+    if (p != none) sparent[s] = super_of[p];
+  }
+
+  auto& cptr = sym->children_ptr;
+  auto& schildren = sym->children;
+  cptr.assign(ns + 1, 0);
+  for (size_t s = 0; s < ns; ++s)
+    if (sparent[s] != none) cptr[sparent[s] + 1]++;
+  std::partial_sum(cptr.begin(), cptr.end(), cptr.begin());
+  schildren.resize(cptr[ns]);
+  {
+    std::vector<size_t> next(cptr.begin(), cptr.end() - 1);
+    for (size_t s = 0; s < ns; ++s)
+      if (sparent[s] != none) schildren[next[sparent[s]]++] = s;
+  }
+
+  // Row structure of supernodes, from the lower pattern and children structures
+  std::vector<size_t> lptr(n + 1, 0), lidx(uidx.size());
+  for (auto i : uidx) lptr[i + 1]++;
+  std::partial_sum(lptr.begin(), lptr.end(), lptr.begin());
+  {
+    std::vector<size_t> next(lptr.begin(), lptr.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+      for (auto p = uptr[i]; p < uptr[i + 1]; ++p)
+        lidx[next[uidx[p]]++] = i;
+  }
+
+  auto& rows_ptr = sym->rows_ptr;
+  auto& srows = sym->rows;
+  auto& values_ptr = sym->values_ptr;
+  rows_ptr.assign(1, 0);
+  values_ptr.assign(1, 0);
+  std::fill(mark.begin(), mark.end(), none);
+  for (size_t s = 0; s < ns; ++s) {
+    auto first = super[s], last = super[s + 1];
+    std::vector<size_t> r;
+    r.reserve(count[first]);
+
+    for (auto j = first; j < last; ++j)
+      mark[j] = s,
+      r.push_back(j);
+    for (auto j = first; j < last; ++j)
+      for (auto p = lptr[j]; p < lptr[j + 1]; ++p)
+        if (mark[lidx[p]] != s)
+          mark[lidx[p]] = s,
+          r.push_back(lidx[p]);
+    for (auto q = cptr[s]; q < cptr[s + 1]; ++q) {
+      auto c = schildren[q];
+      auto width = super[c + 1] - super[c];
+      for (auto p = rows_ptr[c] + width; p < rows_ptr[c + 1]; ++p)
+        if (mark[srows[p]] != s)
+          mark[srows[p]] = s,
+          r.push_back(srows[p]);
+    }
+
+    std::sort(r.begin(), r.end());
+    assert(r.size() == count[first] && "Incoherent symbolic Cholesky factorization");
+
+    srows.insert(srows.end(), r.begin(), r.end());
+    rows_ptr.push_back(srows.size());
+    values_ptr.push_back(values_ptr.back() + r.size() * (last - first));
+  }
+
+  // Heights for level scheduling
+  std::vector<size_t> height(ns, 0);
+  size_t levels = 0;
+  for (size_t s = 0; s < ns; ++s) {
+    if (sparent[s] != none)
+      height[sparent[s]] = std::max(height[sparent[s]], height[s] + 1);
+    levels = std::max(levels, height[s] + 1);
+  }
+
+  auto& lvl_ptr = sym->levels_ptr;
+  auto& lvl = sym->levels;
+  lvl_ptr.assign(levels + 1, 0);
+  for (auto h : height) lvl_ptr[h + 1]++;
+  std::partial_sum(lvl_ptr.begin(), lvl_ptr.end(), lvl_ptr.begin());
+  lvl.resize(ns);
+  {
+    std::vector<size_t> next(lvl_ptr.begin(), lvl_ptr.end() - 1);
+    for (size_t s = 0; s < ns; ++s) lvl[next[height[s]]++] = s;
+  }
+
+  // Assembly map of the lower triangle of A in front coordinates
+  auto& asm_ptr = sym->assembly_ptr;
+  auto& entries = sym->assembly;
+  asm_ptr.assign(ns + 1, 0);
+  for (size_t j = 0; j < n; ++j)
+    for (auto k = cols[j]; k < cols[j + 1]; ++k)
+      if (rows[k] >= j)
+        asm_ptr[super_of[std::min(iperm[rows[k]], iperm[j])] + 1]++;
+  std::partial_sum(asm_ptr.begin(), asm_ptr.end(), asm_ptr.begin());
+
+  entries.resize(asm_ptr[ns]);
+  {
+    std::vector<size_t> next(asm_ptr.begin(), asm_ptr.end() - 1);
+    for (size_t j = 0; j < n; ++j) {
+      for (auto k = cols[j]; k < cols[j + 1]; ++k) {
+        if (rows[k] < j) continue;
+        auto r = std::max(iperm[rows[k]], iperm[j]);
+        auto c = std::min(iperm[rows[k]], iperm[j]);
+        auto s = super_of[c];
+
+        auto first = srows.begin() + rows_ptr[s],
+             last  = srows.begin() + rows_ptr[s + 1];
+        entries[next[s]++] = {k, size_t(std::lower_bound(first, last, r) - first), c - super[s]};
+      }
+    }
+  }
+
+  sym->perm = std::move(perm);
+  sym->iperm = std::move(iperm);
+  sym->parent = std::move(parent);
+  return sym;
+}
+
+template <typename T>
+void sparse_cholesky<T>::factorize(const sparse_type& mat) {
+  auto& sym = *symbolic_;
+  assert(
+    mat.cols() == sym.n &&
+    mat.nnz()  == sym.nnz
+    && "Sparse Cholesky refactorization requires the analysed sparsity pattern");
+
+  lx_.assign(sym.factor_nnz(), value_type(0));
+  std::vector< std::vector<value_type> > updates(sym.supernodes());
+
+  // Supernodes of a level only depend on lower levels
+  for (size_t h = 0; h + 1 < sym.levels_ptr.size(); ++h)
+    parallel_for(sym.levels_ptr[h], sym.levels_ptr[h + 1], 1, [&](size_t first, size_t last) {
+      for (auto l = first; l < last; ++l)
+        factorize_front(mat, sym.levels[l], updates);
+    });
+}
+
+template <typename T>
+void sparse_cholesky<T>::factorize_front(const sparse_type& mat, size_t s, std::vector< std::vector<value_type> >& updates) {
+  auto& sym = *symbolic_;
+  auto& values = mat.values();
+
+  auto first = sym.super[s];
+  auto w = sym.super[s + 1] - first;
+  auto m = sym.rows_ptr[s + 1] - sym.rows_ptr[s];
+  auto rows = sym.rows.data() + sym.rows_ptr[s];
+
+  // Dense lower front, column-major
+  std::vector<value_type> front(m * m, value_type(0));
+  auto f = [&front, m](size_t i, size_t j) -> value_type& { return front[j * m + i]; };
+
+  for (auto p = sym.assembly_ptr[s]; p < sym.assembly_ptr[s + 1]; ++p) {
+    auto& e = sym.assembly[p];
+    f(e.row, e.col) += values[e.src];
+  }
+
+  // Extend-add children update matrices
+  std::vector<size_t> rel;
+  for (auto q = sym.children_ptr[s]; q < sym.children_ptr[s + 1]; ++q) {
+    auto c = sym.children[q];
+    if (updates[c].empty()) continue;
+
+    auto cw = sym.super[c + 1] - sym.super[c];
+    auto crows = sym.rows.data() + sym.rows_ptr[c] + cw;
+    auto cm = sym.rows_ptr[c + 1] - sym.rows_ptr[c] - cw;
+
+    rel.resize(cm);
+    for (size_t i = 0, k = 0; i < cm; ++i) {
+      while (rows[k] != crows[i]) ++k;
+      rel[i] = k;
+    }
+
+    auto& u = updates[c];
+    for (size_t j = 0; j < cm; ++j)
+      for (size_t i = j; i < cm; ++i)
+        f(rel[i], rel[j]) += u[j * cm + i];
+    std::vector<value_type>{}.swap(u);
+  }
+
+  // Panel factorization of the supernode columns
+  for (size_t k = 0; k < w; ++k) {
+    auto d = f(k, k);
+    if (d <= std::numeric_limits<value_type>::epsilon()) {
+      throw std::logic_error{"Sparse Cholesky decomposition failed (Not positive-definite)"};
+    }
+
+    d = f(k, k) = std::sqrt(d);
+    for (auto i = k + 1; i < m; ++i) f(i, k) /= d;
+    for (auto j = k + 1; j < w; ++j) {
+      auto l = f(j, k);
+      for (auto i = j; i < m; ++i) f(i, j) -= f(i, k) * l;
+    }
+  }
+
+  // Schur complement update, distributed over columns for large fronts
+  parallel_for(w, m, 64, [&](size_t cf, size_t cl) {
+    for (auto j = cf; j < cl; ++j)
+      for (size_t k = 0; k < w; ++k) {
+        auto l = f(j, k);
+        auto col = &front[j * m], src = &front[k * m];
+        for (auto i = j; i < m; ++i) col[i] -= src[i] * l;
+      }
+  });
+
+  std::copy(front.begin(), front.begin() + m * w, lx_.begin() + sym.values_ptr[s]);
+  if (m > w) {
+    auto um = m - w;
+    auto& u = updates[s];
+    u.resize(um * um);
+    for (size_t j = 0; j < um; ++j)
+      std::copy(&f(w + j, w + j), &f(w, w + j) + um, u.begin() + j * um + j);
+  }
+}
+
+template <typename T>
+auto sparse_cholesky<T>::det() const -> value_type {
+  return std::exp(log_det());
+}
+
+template <typename T>
+auto sparse_cholesky<T>::log_det() const -> value_type {
+  auto& sym = *symbolic_;
+  value_type l = 0;
+  for (size_t s = 0; s < sym.supernodes(); ++s) {
+    auto w = sym.super[s + 1] - sym.super[s];
+    auto m = sym.rows_ptr[s + 1] - sym.rows_ptr[s];
+    for (size_t k = 0; k < w; ++k) l += std::log(lx_[sym.values_ptr[s] + k * m + k]);
+  } return 2 * l;
+}
+
+template <typename T>
+auto sparse_cholesky<T>::solve(const vector_type& b) const -> vector_type {
+  auto& sym = *symbolic_;
+  assert(
+    b.vector() &&
+    b.size() == sym.n
+    && "Invalid b vector to solve");
+
+  vector_type y{sym.n};
+  for (size_t k = 0; k < sym.n; ++k) y[k] = b[sym.perm[k]];
+
+  // Forward L
+  for (size_t s = 0; s < sym.supernodes(); ++s) {
+    auto first = sym.super[s];
+    auto w = sym.super[s + 1] - first;
+    auto m = sym.rows_ptr[s + 1] - sym.rows_ptr[s];
+    auto rows = sym.rows.data() + sym.rows_ptr[s];
+    auto l = lx_.data() + sym.values_ptr[s];
+
+    for (size_t k = 0; k < w; ++k) {
+      auto x = y[first + k] /= l[k * m + k];
+      for (auto i = k + 1; i < m; ++i) y[rows[i]] -= l[k * m + i] * x;
+    }
+  }
+
+  // Backward L^T
+  for (auto s = sym.supernodes(); s-- > 0; ) {
+    auto first = sym.super[s];
+    auto w = sym.super[s + 1] - first;
+    auto m = sym.rows_ptr[s + 1] - sym.rows_ptr[s];
+    auto rows = sym.rows.data() + sym.rows_ptr[s];
+    auto l = lx_.data() + sym.values_ptr[s];
+
+    for (auto k = w; k-- > 0; ) {
+      auto x = y[first + k];
+      for (auto i = k + 1; i < m; ++i) x -= l[k * m + i] * y[rows[i]];
+      y[first + k] = x / l[k * m + k];
+    }
+  }
+
+  vector_type x{sym.n};
+  for (size_t k = 0; k < sym.n; ++k) x[sym.perm[k]] = y[k];
+  return x;
+}
+
+namespace lin {
+
+template <typename T>
+auto chol_run(const sparse<T>& mat, fill_ordering ordering = fill_ordering::amd) {
+  assert(mat.square() && "Cholesky decomposition requires a square matrix");
+  return sparse_cholesky<T>{mat, ordering};
+}
+
+} // namespace lin
+} // namespace ig
+
+#endif // IG_MATH_SPARSECHOLESKY_H
@@ -8,6 +8,7 @@
 #define IG_MATH_DET_H
 
 #include "imagine/math/lin/decomposition/lu.h"
+#include "imagine/math/theory/simd_accel/intrinsics.h"
 
 namespace ig  {
 namespace lin {
@@ -61,6 +62,78 @@ struct determinant<Mat, 4> {
   }
 };
 
+#if defined(IG_SSE)
+
+// Row-major 2x2 blocks packed in a register
+namespace sse {
+
+template <int x, int y, int z, int w>
+inline __m128 swizzle(__m128 v)             { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x)); }
+template <int x, int y, int z, int w>
+inline __m128 shuffle(__m128 a, __m128 b)   { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x)); }
+
+// A B
+inline __m128 mat2_mul(__m128 a, __m128 b) {
+  return _mm_add_ps(_mm_mul_ps(a, swizzle<0, 3, 0, 3>(b)),
+                    _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+// adj(A) B
+inline __m128 mat2_adj_mul(__m128 a, __m128 b) {
+  return _mm_sub_ps(_mm_mul_ps(swizzle<3, 3, 0, 0>(a), b),
+                    _mm_mul_ps(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+}
+
+// A adj(B)
+inline __m128 mat2_mul_adj(__m128 a, __m128 b) {
+  return _mm_sub_ps(_mm_mul_ps(a, swizzle<3, 0, 3, 0>(b)),
+                    _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+inline float sum(__m128 v) {
+  v = _mm_add_ps(v, swizzle<2, 3, 0, 1>(v));
+  v = _mm_add_ps(v, swizzle<1, 0, 3, 2>(v));
+  return _mm_cvtss_f32(v);
+}
+
+// Blocks A, B, C, D of the 4x4 matrix and their determinants
+struct blocks {
+  explicit blocks(const float* m) {
+    auto r0 = _mm_loadu_ps(m),     r1 = _mm_loadu_ps(m + 4),
+         r2 = _mm_loadu_ps(m + 8), r3 = _mm_loadu_ps(m + 12);
+
+    a = _mm_movelh_ps(r0, r1); b = _mm_movehl_ps(r1, r0);
+    c = _mm_movelh_ps(r2, r3); d = _mm_movehl_ps(r3, r2);
+
+    dets = _mm_sub_ps(
+      _mm_mul_ps(shuffle<0, 2, 0, 2>(r0, r2), shuffle<1, 3, 1, 3>(r1, r3)),
+      _mm_mul_ps(shuffle<1, 3, 1, 3>(r0, r2), shuffle<0, 2, 0, 2>(r1, r3)));
+  }
+
+  // |M| = |A||D| + |B||C| - tr(adj(A) B adj(D) C)
+  auto det(__m128 ab, __m128 dc) const {
+    auto tr = sum(_mm_mul_ps(ab, swizzle<0, 2, 1, 3>(dc)));
+    return
+      _mm_cvtss_f32(_mm_add_ps(
+        _mm_mul_ss(dets, swizzle<3, 3, 3, 3>(dets)),
+        _mm_mul_ss(swizzle<1, 1, 1, 1>(dets), swizzle<2, 2, 2, 2>(dets)))) - tr;
+  }
+
+  __m128 a, b, c, d, dets;
+};
+
+} // namespace sse
+
+template <>
+struct determinant<matrix<float, 4>, 4> {
+  static auto run(const matrix_base< matrix<float, 4> >& mat) {
+    sse::blocks m{&mat.derived()[0]};
+    return m.det(sse::mat2_adj_mul(m.a, m.b), sse::mat2_adj_mul(m.d, m.c));
+  }
+};
+
+#endif
+
 } // namespace detail
 
 template <typename Mat>
@@ -0,0 +1,300 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_EXPM_H
+#define IG_MATH_EXPM_H
+
+#include "imagine/math/theory/sparse.h"
+#include "imagine/math/lin/decomposition/lu.h"
+#include "imagine/math/theory/simd_accel/intrinsics.h"
+#include "imagine/core/net/distribute.h"
+
+namespace ig  {
+namespace lin {
+namespace detail {
+
+// Pade [m/m] coefficients and backward error bounds of the scaling and squaring method (Higham 2005)
+template <typename T>
+struct pade {
+  static constexpr double b3[]  = {120, 60, 12, 1};
+  static constexpr double b5[]  = {30240, 15120, 3360, 420, 30, 1};
+  static constexpr double b7[]  = {17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1};
+  static constexpr double b9[]  = {17643225600., 8821612800., 2075673600., 302702400., 30270240., 2162160., 110880., 3960., 90., 1.};
+  static constexpr double b13[] = {64764752532480000., 32382376266240000., 7771770303897600., 1187353796428800., 129060195264000.,
+                                   10559470521600., 670442572800., 33522128640., 1323241920., 40840800., 960960., 16380., 182., 1.};
+
+  static constexpr bool single = std::is_same_v<T, float>;
+  static constexpr double theta3 = single ? 4.258730016922831e-1 : 1.495585217958292e-2;
+  static constexpr double theta5 = single ? 1.880152677804762    : 2.539398330063230e-1;
+  static constexpr double theta7 = single ? 3.925724783138660    : 9.504178996162932e-1;
+  static constexpr double theta9  = 2.097847961257068;
+  static constexpr double theta13 = 5.371920351148152;
+};
+
+template <typename Mat>
+auto norm1(const matrix_base<Mat>& mat) {
+  matrix_t<Mat> n = 0;
+  for (size_t j = 0; j < mat.cols(); ++j) {
+    matrix_t<Mat> s = 0;
+    for (size_t i = 0; i < mat.rows(); ++i) s += std::abs(mat(i, j));
+    n = std::max(n, s);
+  } return n;
+}
+
+} // namespace detail
+
+// Matrix exponential by scaling and squaring with Pade approximants
+template <typename Mat>
+auto expm(const matrix_base<Mat>& mat) {
+  using value_type = matrix_t<Mat>;
+  using matrix_type = matrix<value_type>;
+  using vector_type = colvec<value_type>;
+  using pade = detail::pade<value_type>;
+
+  static_assert(std::is_floating_point<value_type>::value, "Matrix exponential requires a floating-point matrix");
+  assert(mat.square() && "Matrix exponential exists only with square matrices");
+
+  auto n = mat.rows();
+  matrix_type A{mat}, U{n, n}, V{n, n};
+  auto I = matrix_type::eye(n);
+
+  auto norm = detail::norm1(A);
+  size_t s = 0;
+
+  auto low = [&](const double* b, size_t m) {
+    // U = A (sum b_odd A^(k-1)), V = sum b_even A^k
+    matrix_type A2 = A % A, Ak = I, Uk{n, n};
+    V = value_type(b[0]) * I;
+    Uk = value_type(b[1]) * I;
+    for (size_t k = 2; k <= m; k += 2) {
+      Ak = Ak % A2;
+      V  += value_type(b[k]) * Ak;
+      Uk += value_type(b[k + 1]) * Ak;
+    } U = A % Uk;
+  };
+
+  if (norm <= pade::theta3) {
+    low(pade::b3, 3);
+  } else if (norm <= pade::theta5) {
+    low(pade::b5, 5);
+  } else if (norm <= pade::theta7 || pade::single) {
+    if (norm > pade::theta7)
+      s = size_t(std::ceil(std::log2(norm / pade::theta7))),
+      A /= value_type(std::ldexp(1., int(s)));
+    low(pade::b7, 7);
+  } else if (norm <= pade::theta9) {
+    low(pade::b9, 9);
+  } else {
+    if (norm > pade::theta13)
+      s = size_t(std::ceil(std::log2(norm / pade::theta13))),
+      A /= value_type(std::ldexp(1., int(s)));
+
+    auto& b = pade::b13;
+    matrix_type A2 = A % A;
+    matrix_type A4 = A2 % A2;
+    matrix_type A6 = A4 % A2;
+    matrix_type W1 = b[13] * A6 + b[11] * A4 + b[9] * A2;
+    matrix_type W2 = b[12] * A6 + b[10] * A4 + b[8] * A2;
+    matrix_type W  = A6 % W1 + b[7] * A6 + b[5] * A4 + b[3] * A2 + b[1] * I;
+    U = A % W;
+    V = A6 % W2 + b[6] * A6 + b[4] * A4 + b[2] * A2 + b[0] * I;
+  }
+
+  // Solve (V - U) R = (V + U) through LU
+  matrix_type P = V + U;
+  auto Q = lu_run(matrix_type{V - U});
+
+  matrix_type R{n, n};
+  for (size_t j = 0; j < n; ++j)
+    R.col(j) = Q.solve(vector_type{P.col(j)});
+
+  for (size_t k = 0; k < s; ++k)
+    R = R % R;
+  return concrete_matrix<Mat>{R};
+}
+
+namespace detail {
+
+template <typename L> inline auto lane_abs(const L& v)              { return abs(v); }
+template <typename L> inline auto lane_max(const L& lhs, const L& rhs) { return max(lhs, rhs); }
+inline auto lane_abs(const float& v)                                  { return std::abs(v); }
+inline auto lane_max(const float& lhs, const float& rhs)              { return std::max(lhs, rhs); }
+
+template <typename L> inline constexpr size_t lane_count = sizeof(L) / sizeof(float);
+template <typename L> inline auto& lane(L& v, size_t l)      { return v[l]; }
+inline auto& lane(float& v, size_t)                          { return v; }
+
+// Pade [7/7] exponential of lanes of N x N matrices stored as structure of arrays
+template <typename L, size_t N>
+void expm_lanes(std::array<L, N * N>& A) {
+  using block = std::array<L, N * N>;
+  using pade = detail::pade<float>;
+
+  auto mul = [](const block& lhs, const block& rhs) {
+    block res;
+    for (size_t i = 0; i < N; ++i)
+      for (size_t k = 0; k < N; ++k) {
+        L s = lhs[i * N] * rhs[k];
+        for (size_t j = 1; j < N; ++j) s = s + lhs[i * N + j] * rhs[j * N + k];
+        res[i * N + k] = s;
+      }
+    return res;
+  };
+
+  // Common scaling of the lanes from their 1-norms
+  L norm = 0.f;
+  for (size_t j = 0; j < N; ++j) {
+    L s = lane_abs(A[j]);
+    for (size_t i = 1; i < N; ++i) s = s + lane_abs(A[i * N + j]);
+    norm = lane_max(norm, s);
+  }
+
+  float nmax = 0;
+  for (size_t l = 0; l < lane_count<L>; ++l) nmax = std::max(nmax, lane(norm, l));
+
+  int s = nmax > pade::theta7
+    ? int(std::ceil(std::log2(nmax / pade::theta7)))
+    : 0;
+  L scale = std::ldexp(1.f, -s);
+  for (auto& a : A) a = a * scale;
+
+  // U = A (b7 A6 + b5 A4 + b3 A2 + b1 I), V = b6 A6 + b4 A4 + b2 A2 + b0 I
+  auto& b = pade::b7;
+  auto A2 = mul(A, A);
+  auto A4 = mul(A2, A2);
+  auto A6 = mul(A4, A2);
+
+  block W, V;
+  for (size_t k = 0; k < N * N; ++k) {
+    L id = (k % (N + 1) == 0) ? 1.f : 0.f;
+    W[k] = L(float(b[7])) * A6[k] + L(float(b[5])) * A4[k] + L(float(b[3])) * A2[k] + L(float(b[1])) * id;
+    V[k] = L(float(b[6])) * A6[k] + L(float(b[4])) * A4[k] + L(float(b[2])) * A2[k] + L(float(b[0])) * id;
+  }
+  auto U = mul(A, W);
+
+  // Gauss-Jordan on Q = V - U, well conditioned in the Pade domain
+  block Q, R;
+  for (size_t k = 0; k < N * N; ++k)
+    Q[k] = V[k] - U[k],
+    R[k] = V[k] + U[k];
+
+  for (size_t p = 0; p < N; ++p) {
+    L inv = L(1.f) / Q[p * N + p];
+    for (size_t j = 0; j < N; ++j) Q[p * N + j] = Q[p * N + j] * inv, R[p * N + j] = R[p * N + j] * inv;
+    for (size_t i = 0; i < N; ++i) {
+      if (i == p) continue;
+      L f = Q[i * N + p];
+      for (size_t j = 0; j < N; ++j) Q[i * N + j] = Q[i * N + j] - f * Q[p * N + j], R[i * N + j] = R[i * N + j] - f * R[p * N + j];
+    }
+  }
+
+  for (int k = 0; k < s; ++k)
+    R = mul(R, R);
+  A = R;
+}
+
+} // namespace detail
+
+// Batched exponentials exp(A[i] dt) of small single-precision matrices, vectorized across the batch
+template <size_t N>
+void expm(const matrix<float, N>* in, matrix<float, N>* out, size_t count, float dt = 1.f) {
+  static_assert(N > 0 && N <= 8, "Batched matrix exponential targets small fixed-size matrices");
+#if defined(IG_SSE)
+  using lane_type = packet;
+#else
+  using lane_type = float;
+#endif
+  constexpr auto w = detail::lane_count<lane_type>;
+
+  parallel_for(0, (count + w - 1) / w, 64, [&](size_t first, size_t last) {
+    std::array<lane_type, N * N> A;
+    for (auto g = first; g < last; ++g) {
+      auto base = g * w;
+      auto lanes = std::min(w, count - base);
+
+      // Array of structures to structure of arrays, missing lanes are zero
+      for (size_t k = 0; k < N * N; ++k) {
+        A[k] = 0.f;
+        for (size_t l = 0; l < lanes; ++l) detail::lane(A[k], l) = in[base + l][k] * dt;
+      }
+
+      detail::expm_lanes<lane_type, N>(A);
+
+      for (size_t l = 0; l < lanes; ++l)
+        for (size_t k = 0; k < N * N; ++k) out[base + l][k] = detail::lane(A[k], l);
+    }
+  });
+}
+
+template <size_t N>
+auto expm(const std::vector< matrix<float, N> >& batch, float dt = 1.f) {
+  std::vector< matrix<float, N> > res(batch.size());
+  expm(batch.data(), res.data(), batch.size(), dt);
+  return res;
+}
+
+// Action exp(tA) b of a large sparse matrix, truncated Taylor series with scaling (Al-Mohy & Higham 2011)
+template <typename T, typename Vec>
+auto expmv(const sparse<T>& A, const matrix_base<Vec>& b, T t = 1) {
+  using vector_type = colvec<T>;
+  assert(
+    A.square() &&
+    b.vector() &&
+    b.size() == A.cols()
+    && "Incoherent sparse matrix exponential action");
+
+  // theta_m for m = 5, 10, .., 40 in double precision
+  constexpr double theta[] = {2.400876357887274e-3, 1.441829761614378e-1, 6.410835233041199e-1, 1.439976378172342,
+                              2.440407718224447,    3.568130932306289,    4.780558209007719,    6.051109896626617};
+  auto tol = std::numeric_limits<T>::epsilon();
+
+  // 1-norm of tA
+  auto& cols = A.col_ptr();
+  auto& vals = A.values();
+  double norm = 0;
+  for (size_t j = 0; j < A.cols(); ++j) {
+    double s = 0;
+    for (auto k = cols[j]; k < cols[j + 1]; ++k) s += std::abs(vals[k]);
+    norm = std::max(norm, s);
+  } norm *= std::abs(double(t));
+
+  // Degree and number of steps minimizing the matrix-vector products
+  size_t m = 0, s = 1;
+  if (norm > 0) {
+    auto cost = std::numeric_limits<size_t>::max();
+    for (size_t q = 0; q < std::size(theta); ++q) {
+      auto mq = 5 * (q + 1);
+      auto sq = std::max<size_t>(1, size_t(std::ceil(norm / theta[q])));
+      if (mq * sq < cost) cost = mq * sq, m = mq, s = sq;
+    }
+  }
+
+  auto inf = [](const vector_type& v) {
+    T n = 0;
+    for (size_t i = 0; i < v.size(); ++i) n = std::max(n, std::abs(v[i]));
+    return n;
+  };
+
+  vector_type f{b}, v{b};
+  auto h = t / T(s);
+  for (size_t i = 0; i < s; ++i) {
+    auto c1 = inf(v);
+    for (size_t k = 1; k <= m; ++k) {
+      v = (h / T(k)) * (A % v);
+      f += v;
+
+      // Two successive terms below tolerance
+      auto c2 = inf(v);
+      if (c1 + c2 <= tol * inf(f)) break;
+      c1 = c2;
+    } v = f;
+  } return f;
+}
+
+} // namespace lin
+} // namespace ig
+
+#endif // IG_MATH_EXPM_H
@@ -82,6 +82,90 @@ struct inverse<Mat, 4> {
   }
 };
 
+#if defined(IG_SSE)
+
+template <>
+struct inverse<matrix<float, 4>, 4> {
+  static auto run(const matrix_base< matrix<float, 4> >& mat) {
+    using namespace sse;
+    blocks m{&mat.derived()[0]};
+
+    auto detA = swizzle<0, 0, 0, 0>(m.dets), detB = swizzle<1, 1, 1, 1>(m.dets),
+         detC = swizzle<2, 2, 2, 2>(m.dets), detD = swizzle<3, 3, 3, 3>(m.dets);
+
+    // Minors shared by every block of the adjugate
+    auto ab = mat2_adj_mul(m.a, m.b);
+    auto dc = mat2_adj_mul(m.d, m.c);
+
+    auto x = _mm_sub_ps(_mm_mul_ps(detD, m.a), mat2_mul(m.b, dc));
+    auto w = _mm_sub_ps(_mm_mul_ps(detA, m.d), mat2_mul(m.c, ab));
+    auto y = _mm_sub_ps(_mm_mul_ps(detB, m.c), mat2_mul_adj(m.d, ab));
+    auto z = _mm_sub_ps(_mm_mul_ps(detC, m.b), mat2_mul_adj(m.a, dc));
+
+    auto r = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), _mm_set1_ps(m.det(ab, dc)));
+    x = _mm_mul_ps(x, r); y = _mm_mul_ps(y, r);
+    z = _mm_mul_ps(z, r); w = _mm_mul_ps(w, r);
+
+    matrix<float, 4> res;
+    _mm_storeu_ps(&res[0],  shuffle<3, 1, 3, 1>(x, y));
+    _mm_storeu_ps(&res[4],  shuffle<2, 0, 2, 0>(x, y));
+    _mm_storeu_ps(&res[8],  shuffle<3, 1, 3, 1>(z, w));
+    _mm_storeu_ps(&res[12], shuffle<2, 0, 2, 0>(z, w));
+    return res;
+  }
+};
+
+#endif
+
+// [R t; 0 1] with R orthonormal
+template <typename Mat>
+struct rigid_inverse {
+  static auto run(const matrix_base<Mat>& mat) {
+    concrete_matrix<Mat> res;
+    for (size_t i = 0; i < 3; ++i) {
+      for (size_t j = 0; j < 3; ++j)
+        res(i, j) = mat(j, i);
+      res(i, 3) = -(mat(0, i) * mat(0, 3) + mat(1, i) * mat(1, 3) + mat(2, i) * mat(2, 3));
+    } res(3, 3) = 1;
+    return res;
+  }
+};
+
+#if defined(IG_SSE)
+
+template <>
+struct rigid_inverse< matrix<float, 4> > {
+  static auto run(const matrix_base< matrix<float, 4> >& mat) {
+    using namespace sse;
+    auto p = &mat.derived()[0];
+    auto xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+    auto r0 = _mm_loadu_ps(p),     r1 = _mm_loadu_ps(p + 4),
+         r2 = _mm_loadu_ps(p + 8);
+
+    // -R^T t as a combination of the rows of R
+    auto t = _mm_add_ps(_mm_add_ps(
+      _mm_mul_ps(swizzle<3, 3, 3, 3>(r0), r0),
+      _mm_mul_ps(swizzle<3, 3, 3, 3>(r1), r1)),
+      _mm_mul_ps(swizzle<3, 3, 3, 3>(r2), r2));
+    auto r3 = _mm_sub_ps(_mm_setr_ps(0.f, 0.f, 0.f, 1.f), _mm_and_ps(t, xyz));
+
+    r0 = _mm_and_ps(r0, xyz);
+    r1 = _mm_and_ps(r1, xyz);
+    r2 = _mm_and_ps(r2, xyz);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    matrix<float, 4> res;
+    _mm_storeu_ps(&res[0],  r0);
+    _mm_storeu_ps(&res[4],  r1);
+    _mm_storeu_ps(&res[8],  r2);
+    _mm_storeu_ps(&res[12], r3);
+    return res;
+  }
+};
+
+#endif
+
 } // namespace detail
 
 template <typename Mat>
@@ -92,6 +176,40 @@ constexpr auto inv(const matrix_base<Mat>& mat) {
     (mat);
 }
 
+// Inverse of an affine transform [A t; 0 1], cofactors of A are computed once
+template <typename Mat>
+auto affine_inv(const matrix_base<Mat>& mat) {
+  static_assert(
+    matrix_traits<Mat>::n_rows == 4 &&
+    matrix_traits<Mat>::n_cols == 4,
+    "Affine inverse requires a 4x4 transform");
+
+  concrete_matrix<Mat> res;
+  for (size_t i = 0; i < 3; ++i)
+    for (size_t j = 0; j < 3; ++j)
+      res(j, i) = detail::inverse<Mat, 3>::com(mat, i, j);
+
+  auto d = 1 / (mat(0, 0) * res(0, 0) + mat(0, 1) * res(1, 0) + mat(0, 2) * res(2, 0));
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 3; ++j)
+      res(i, j) *= d;
+    res(i, 3) = -(res(i, 0) * mat(0, 3) + res(i, 1) * mat(1, 3) + res(i, 2) * mat(2, 3));
+  } res(3, 3) = 1;
+  return res;
+}
+
+// Inverse of a rigid transform [R t; 0 1], R^T and -R^T t
+template <typename Mat>
+auto rigid_inv(const matrix_base<Mat>& mat) {
+  static_assert(
+    matrix_traits<Mat>::n_rows == 4 &&
+    matrix_traits<Mat>::n_cols == 4,
+    "Rigid inverse requires a 4x4 transform");
+  return
+    detail::rigid_inverse<Mat>::run
+    (mat);
+}
+
 } // namespace lin
 } // namespace ig
 
@@ -0,0 +1,146 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_AMD_H
+#define IG_MATH_AMD_H
+
+#include "imagine/math/lin/reorder/graph.h"
+
+namespace ig  {
+namespace lin {
+
+// Approximate minimum degree ordering (Amestoy, Davis & Duff) on the quotient graph
+// returns perm with perm[new] = old
+template <typename T>
+auto amd(const sparse<T>& mat) -> std::vector<size_t> {
+  enum class state : uint8_t { variable, element, absorbed, dense };
+
+  auto n = mat.cols();
+  auto [ptr, adj] = make_graph(mat);
+
+  std::vector<size_t> perm;
+  perm.reserve(n);
+  if (n == 0) return perm;
+
+  std::vector<state> st(n, state::variable);
+  std::vector< std::vector<size_t> > vars(n), elms(n), lp(n);
+
+  // Dense rows are ordered last and removed from the graph
+  auto dense = std::max<size_t>(16, size_t(10 * std::sqrt(double(n))));
+  for (size_t i = 0; i < n; ++i)
+    if (ptr[i + 1] - ptr[i] > dense && ptr[i + 1] - ptr[i] > n / 2)
+      st[i] = state::dense;
+
+  // Degree buckets
+  constexpr auto none = std::numeric_limits<size_t>::max();
+  std::vector<size_t> deg(n), head(n, none), next(n, none), prev(n, none);
+  auto insert = [&](size_t i) {
+    auto d = deg[i];
+    next[i] = head[d], prev[i] = none;
+    if (head[d] != none) prev[head[d]] = i;
+    head[d] = i;
+  };
+  auto remove = [&](size_t i) {
+    if (prev[i] != none) next[prev[i]] = next[i]; else head[deg[i]] = next[i];
+    if (next[i] != none) prev[next[i]] = prev[i];
+  };
+
+  size_t live = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (st[i] == state::dense) continue;
+    for (auto k = ptr[i]; k < ptr[i + 1]; ++k)
+      if (st[adj[k]] != state::dense)
+        vars[i].push_back(adj[k]);
+    deg[i] = vars[i].size();
+    insert(i);
+    live++;
+  }
+
+  std::vector<size_t> mark(n, none), wmark(n, none);
+  std::vector<long long> w(n, 0);
+
+  size_t mindeg = 0;
+  for (size_t k = 0; k < live; ++k) {
+    // Pivot of minimum approximate degree
+    while (head[mindeg] == none) mindeg++;
+    auto p = head[mindeg];
+    remove(p);
+
+    // Construct new element Lp from absorbed elements and remaining neighbours
+    std::vector<size_t> le;
+    mark[p] = p;
+    for (auto e : elms[p]) {
+      if (st[e] != state::element) continue;
+      for (auto v : lp[e])
+        if (st[v] == state::variable && mark[v] != p)
+          mark[v] = p,
+          le.push_back(v);
+      st[e] = state::absorbed;
+      std::vector<size_t>{}.swap(lp[e]);
+    }
+    for (auto v : vars[p])
+      if (st[v] == state::variable && mark[v] != p)
+        mark[v] = p,
+        le.push_back(v);
+
+    st[p] = state::element;
+    std::vector<size_t>{}.swap(vars[p]);
+    std::vector<size_t>{}.swap(elms[p]);
+    perm.push_back(p);
+
+    // Prune variable and element lists of Lp
+    for (auto i : le) {
+      remove(i);
+      auto& ei = elms[i];
+      ei.erase(std::remove_if(ei.begin(), ei.end(), [&st](auto e) { return st[e] != state::element; }), ei.end());
+      ei.push_back(p);
+
+      auto& ai = vars[i];
+      ai.erase(std::remove_if(ai.begin(), ai.end(), [&st, &mark, p](auto v) { return st[v] != state::variable || mark[v] == p; }), ai.end());
+    }
+
+    // |Le \ Lp| for every element adjacent to Lp
+    for (auto i : le) {
+      for (auto e : elms[i]) {
+        if (e == p) continue;
+        if (wmark[e] != p)
+          wmark[e] = p,
+          w[e] = lp[e].size();
+        w[e]--;
+      }
+    }
+
+    // Approximate external degrees
+    auto remaining = live - k - 1;
+    for (auto i : le) {
+      auto d = vars[i].size() + le.size() - 1;
+      for (auto e : elms[i]) {
+        if (e == p || st[e] != state::element) continue;
+        // Aggressive absorption of elements covered by Lp
+        if (w[e] == 0) {
+          st[e] = state::absorbed;
+          std::vector<size_t>{}.swap(lp[e]);
+        } else d += w[e];
+      }
+
+      deg[i] = std::min({deg[i] + le.size() - 1, d, remaining});
+      insert(i);
+      mindeg = std::min(mindeg, deg[i]);
+    }
+
+    lp[p] = std::move(le);
+  }
+
+  for (size_t i = 0; i < n; ++i)
+    if (st[i] == state::dense)
+      perm.push_back(i);
+  return perm;
+}
+
+} // namespace lin
+} // namespace ig
+
+#endif // IG_MATH_AMD_H
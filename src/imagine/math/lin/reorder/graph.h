@@ -0,0 +1,105 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_REORDERGRAPH_H
+#define IG_MATH_REORDERGRAPH_H
+
+#include "imagine/math/theory/sparse.h"
+
+namespace ig  {
+namespace lin {
+
+// Undirected graph in compressed adjacency form, vertex i is adjacent to adj[ptr[i] .. ptr[i + 1])
+struct graph {
+  auto size() const { return ptr.empty() ? 0 : ptr.size() - 1; }
+  auto degree(size_t i) const { return ptr[i + 1] - ptr[i]; }
+
+  std::vector<size_t> ptr, adj;
+};
+
+// Symmetric adjacency of A + A^T without diagonal
+template <typename T>
+auto make_graph(const sparse<T>& mat) -> graph {
+  assert(mat.square() && "Graph ordering requires a square matrix");
+  auto n = mat.cols();
+  auto& cols = mat.col_ptr();
+  auto& rows = mat.row_ind();
+
+  std::vector<size_t> ptr(n + 1, 0);
+  for (size_t j = 0; j < n; ++j)
+    for (auto k = cols[j]; k < cols[j + 1]; ++k)
+      if (rows[k] != j)
+        ptr[rows[k] + 1]++,
+        ptr[j + 1]++;
+  std::partial_sum(ptr.begin(), ptr.end(), ptr.begin());
+
+  std::vector<size_t> adj(ptr[n]), next(ptr.begin(), ptr.end() - 1);
+  for (size_t j = 0; j < n; ++j)
+    for (auto k = cols[j]; k < cols[j + 1]; ++k)
+      if (rows[k] != j)
+        adj[next[rows[k]]++] = j,
+        adj[next[j]++] = rows[k];
+
+  // Remove duplicates from symmetric storage
+  std::vector<size_t> compact(n + 1, 0), mark(n, n);
+  size_t q = 0;
+  for (size_t i = 0; i < n; ++i) {
+    for (auto k = ptr[i]; k < ptr[i + 1]; ++k) {
+      if (mark[adj[k]] != i)
+        mark[adj[k]] = i,
+        adj[q++] = adj[k];
+    } compact[i + 1] = q;
+  }
+
+  adj.resize(q);
+  return graph{std::move(compact), std::move(adj)};
+}
+
+namespace detail {
+
+// Breadth-first level structure of the component of root, restricted to vertices with label[v] == tag
+// returns vertices in visiting order and the start of each level
+inline auto level_structure(const graph& g, size_t root, const std::vector<size_t>& label, size_t tag, std::vector<size_t>& mark, size_t stamp) {
+  std::vector<size_t> order{root}, levels{0};
+  mark[root] = stamp;
+  for (size_t first = 0; first < order.size(); ) {
+    auto last = order.size();
+    levels.push_back(last);
+    for (auto k = first; k < last; ++k) {
+      auto v = order[k];
+      for (auto p = g.ptr[v]; p < g.ptr[v + 1]; ++p) {
+        auto u = g.adj[p];
+        if (label[u] == tag && mark[u] != stamp)
+          mark[u] = stamp,
+          order.push_back(u);
+      }
+    } first = last;
+  } return std::make_pair(std::move(order), std::move(levels));
+}
+
+// Pseudo-peripheral vertex (George & Liu) of the component of root
+inline auto peripheral(const graph& g, size_t root, const std::vector<size_t>& label, size_t tag, std::vector<size_t>& mark, size_t& stamp) {
+  auto [order, levels] = level_structure(g, root, label, tag, mark, ++stamp);
+  for (;;) {
+    // Minimum degree vertex of the last level
+    auto next = order[levels[levels.size() - 2]];
+    for (auto k = levels[levels.size() - 2]; k < order.size(); ++k)
+      if (g.degree(order[k]) < g.degree(next)) next = order[k];
+
+    auto [o, l] = level_structure(g, next, label, tag, mark, ++stamp);
+    if (l.size() <= levels.size())
+      return std::make_tuple(root, std::move(order), std::move(levels));
+    root = next,
+    order = std::move(o),
+    levels = std::move(l);
+  }
+}
+
+} // namespace detail
+} // namespace lin
+} // namespace ig
+
+#endif // IG_MATH_REORDERGRAPH_H
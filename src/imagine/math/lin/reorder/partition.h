@@ -0,0 +1,153 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_PARTITION_H
+#define IG_MATH_PARTITION_H
+
+#include "imagine/math/lin/reorder/graph.h"
+
+namespace ig  {
+namespace lin {
+
+struct partitioning {
+  std::vector<size_t> perm; // perm[new] = old, vertices grouped by part
+  std::vector<size_t> part; // part of each (old) vertex
+  std::vector<size_t> ptr;  // part p holds perm[ptr[p] .. ptr[p + 1])
+};
+
+// Recursive graph bisection in parts of similar size, parts are contiguous in the returned order
+inline auto partition(const graph& g, size_t parts) -> partitioning {
+  auto n = g.size();
+  partitioning res;
+  res.part.assign(n, 0);
+  res.ptr.assign(1, 0);
+  if (n == 0) return res;
+
+  std::vector<size_t> label(n, 0), mark(n, 0), inlo(n, 0);
+  size_t stamp = 0, tag = 0;
+
+  std::vector<size_t> all(n);
+  std::iota(all.begin(), all.end(), 0);
+
+  // Depth-first recursion keeps neighbouring parts close in the final order
+  std::vector< std::pair<std::vector<size_t>, size_t> > stack;
+  stack.emplace_back(std::move(all), std::max<size_t>(parts, 1));
+  while (!stack.empty()) {
+    auto [vertices, k] = std::move(stack.back());
+    stack.pop_back();
+
+    ++tag;
+    for (auto v : vertices) label[v] = tag;
+
+    // Parts are laid out in breadth-first order of their components
+    if (k <= 1 || vertices.size() <= 1) {
+      auto id = res.ptr.size() - 1;
+      for (auto v : vertices) {
+        res.part[v] = id;
+        if (label[v] != tag) continue;
+        auto [root, order, levels] = detail::peripheral(g, v, label, tag, mark, stamp);
+        for (auto u : order) label[u] = 0;
+        res.perm.insert(res.perm.end(), order.begin(), order.end());
+      }
+      res.ptr.push_back(res.perm.size());
+      continue;
+    }
+
+    auto [root, order, levels] = detail::peripheral(g, vertices.front(), label, tag, mark, stamp);
+
+    // Split proportionally to the number of parts on each side, along the level structure
+    auto kl = k / 2;
+    auto cut = vertices.size() * kl / k;
+    std::vector<size_t> lo, hi;
+    lo.reserve(cut);
+    ++stamp;
+    for (size_t q = 0; q < order.size() && lo.size() < cut; ++q)
+      inlo[order[q]] = stamp,
+      lo.push_back(order[q]);
+    for (auto v : vertices)
+      if (lo.size() < cut && inlo[v] != stamp)
+        inlo[v] = stamp,
+        lo.push_back(v);
+    for (auto v : vertices)
+      if (inlo[v] != stamp) hi.push_back(v);
+
+    stack.emplace_back(std::move(hi), k - kl);
+    stack.emplace_back(std::move(lo), kl);
+  } return res;
+}
+
+// Nested dissection by level-structure vertex separators, separators are ordered last
+// subgraphs of at most leaf vertices are ordered by breadth-first search
+inline auto nested_dissection(const graph& g, size_t leaf = 64) -> std::vector<size_t> {
+  auto n = g.size();
+  std::vector<size_t> perm(n), label(n, 0), mark(n, 0);
+  size_t stamp = 0, tag = 0;
+
+  std::vector<size_t> all(n);
+  std::iota(all.begin(), all.end(), 0);
+
+  std::vector< std::pair<std::vector<size_t>, size_t> > stack;
+  if (n) stack.emplace_back(std::move(all), 0);
+  while (!stack.empty()) {
+    auto [vertices, lo] = std::move(stack.back());
+    stack.pop_back();
+
+    ++tag;
+    for (auto v : vertices) label[v] = tag;
+    auto [root, order, levels] = detail::peripheral(g, vertices.front(), label, tag, mark, stamp);
+    auto reached = order.size();
+
+    // Disconnected subgraph, the remaining components are dissected independently
+    if (reached < vertices.size()) {
+      std::vector<size_t> rest;
+      for (auto v : vertices)
+        if (mark[v] != stamp) rest.push_back(v);
+      stack.emplace_back(std::move(rest), lo + reached);
+      stack.emplace_back(std::move(order), lo);
+      continue;
+    }
+
+    auto nl = levels.size() - 1;
+    if (vertices.size() <= leaf || nl < 3) {
+      std::copy(order.begin(), order.end(), perm.begin() + lo);
+      continue;
+    }
+
+    // Smallest level around the median as separator
+    size_t sep = 1;
+    size_t best = std::numeric_limits<size_t>::max();
+    for (size_t l = 1; l + 1 < nl; ++l) {
+      auto before = levels[l], width = levels[l + 1] - levels[l];
+      if (before * 10 < reached * 4 || before * 10 > reached * 6) continue;
+      if (width < best) best = width, sep = l;
+    }
+    if (best == std::numeric_limits<size_t>::max()) {
+      sep = size_t(std::upper_bound(levels.begin(), levels.end(), reached / 2) - levels.begin()) - 1;
+      sep = std::clamp<size_t>(sep, 1, nl - 2);
+    }
+
+    std::vector<size_t> a(order.begin(), order.begin() + levels[sep]),
+                        b(order.begin() + levels[sep + 1], order.end());
+    std::copy(order.begin() + levels[sep], order.begin() + levels[sep + 1], perm.begin() + lo + a.size() + b.size());
+
+    auto la = a.size();
+    stack.emplace_back(std::move(b), lo + la);
+    stack.emplace_back(std::move(a), lo);
+  } return perm;
+}
+
+template <typename T>
+auto partition(const sparse<T>& mat, size_t parts)
+{ return partition(make_graph(mat), parts); }
+
+template <typename T>
+auto nested_dissection(const sparse<T>& mat, size_t leaf = 64)
+{ return nested_dissection(make_graph(mat), leaf); }
+
+} // namespace lin
+} // namespace ig
+
+#endif // IG_MATH_PARTITION_H
@@ -0,0 +1,89 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_PERMUTE_H
+#define IG_MATH_PERMUTE_H
+
+#include "imagine/math/theory/sparse.h"
+
+namespace ig  {
+namespace lin {
+
+// Permutations are stored as perm[new] = old
+inline auto inverse(const std::vector<size_t>& perm) {
+  std::vector<size_t> iperm(perm.size());
+  for (size_t k = 0; k < perm.size(); ++k) iperm[perm[k]] = k;
+  return iperm;
+}
+
+// Symmetric permutation PAP^T
+template <typename T>
+auto permute(const sparse<T>& mat, const std::vector<size_t>& perm) -> sparse<T> {
+  assert(
+    mat.square() &&
+    mat.cols() == perm.size()
+    && "Symmetric permutation requires a square matrix of the permutation size");
+
+  auto n = mat.cols();
+  auto iperm = inverse(perm);
+  auto& cols = mat.col_ptr();
+  auto& rows = mat.row_ind();
+  auto& vals = mat.values();
+
+  std::vector<typename sparse<T>::triplet> entries;
+  entries.reserve(mat.nnz());
+  for (size_t j = 0; j < n; ++j)
+    for (auto k = cols[j]; k < cols[j + 1]; ++k)
+      entries.emplace_back(iperm[rows[k]], iperm[j], vals[k]);
+  return sparse<T>{n, n, std::move(entries)};
+}
+
+// Vectors are gathered (y[new] = x[old]), square matrices are permuted symmetrically
+template <typename Mat>
+auto permute(const matrix_base<Mat>& mat, const std::vector<size_t>& perm) {
+  concrete_matrix<Mat> res{mat};
+  if (mat.vector()) {
+    assert(mat.size() == perm.size() && "Incoherent vector permutation");
+    for (size_t k = 0; k < perm.size(); ++k) res[k] = mat[perm[k]];
+  } else {
+    assert(
+      mat.square() &&
+      mat.rows() == perm.size()
+      && "Symmetric permutation requires a square matrix of the permutation size");
+    for (size_t i = 0; i < perm.size(); ++i)
+      for (size_t j = 0; j < perm.size(); ++j)
+        res(i, j) = mat(perm[i], perm[j]);
+  } return res;
+}
+
+// Scatter back to the original numbering (x[old] = y[new])
+template <typename Mat>
+auto unpermute(const matrix_base<Mat>& vec, const std::vector<size_t>& perm) {
+  assert(
+    vec.vector() &&
+    vec.size() == perm.size()
+    && "Incoherent vector permutation");
+
+  concrete_matrix<Mat> res{vec};
+  for (size_t k = 0; k < perm.size(); ++k) res[perm[k]] = vec[k];
+  return res;
+}
+
+// Reorders any random-access range of per-vertex data
+template
+< typename Container,
+  typename = std::enable_if_t< !std::is_base_of_v<xpr<Container>, Container> > >
+auto permute(const Container& data, const std::vector<size_t>& perm) -> Container {
+  assert(data.size() == perm.size() && "Incoherent permutation size");
+  Container res(data.size());
+  for (size_t k = 0; k < perm.size(); ++k) res[k] = data[perm[k]];
+  return res;
+}
+
+} // namespace lin
+} // namespace ig
+
+#endif // IG_MATH_PERMUTE_H
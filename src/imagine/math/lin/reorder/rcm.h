@@ -0,0 +1,55 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_RCM_H
+#define IG_MATH_RCM_H
+
+#include "imagine/math/lin/reorder/graph.h"
+
+namespace ig  {
+namespace lin {
+
+// Reverse Cuthill-McKee bandwidth reduction, each component starts from a pseudo-peripheral vertex
+// returns perm with perm[new] = old
+inline auto rcm(const graph& g) -> std::vector<size_t> {
+  auto n = g.size();
+  std::vector<size_t> perm, label(n, 0), mark(n, 0);
+  perm.reserve(n);
+
+  size_t stamp = 0;
+  std::vector<size_t> next;
+  for (size_t i = 0; i < n; ++i) {
+    if (mark[i]) continue;
+    auto [root, order, levels] = detail::peripheral(g, i, label, 0, mark, stamp);
+
+    // Cuthill-McKee, neighbours by increasing degree
+    auto first = perm.size();
+    perm.push_back(root);
+    mark[root] = ++stamp;
+    for (auto k = first; k < perm.size(); ++k) {
+      auto v = perm[k];
+      next.clear();
+      for (auto p = g.ptr[v]; p < g.ptr[v + 1]; ++p)
+        if (mark[g.adj[p]] != stamp)
+          mark[g.adj[p]] = stamp,
+          next.push_back(g.adj[p]);
+      std::sort(next.begin(), next.end(), [&g](auto lhs, auto rhs) { return g.degree(lhs) < g.degree(rhs); });
+      perm.insert(perm.end(), next.begin(), next.end());
+    }
+  }
+
+  std::reverse(perm.begin(), perm.end());
+  return perm;
+}
+
+template <typename T>
+auto rcm(const sparse<T>& mat)
+{ return rcm(make_graph(mat)); }
+
+} // namespace lin
+} // namespace ig
+
+#endif // IG_MATH_RCM_H
@@ -7,6 +7,8 @@
 #ifndef IG_MATH_ITERATIVE_H
 #define IG_MATH_ITERATIVE_H
 
+#include "imagine/math/lin/algebra.h"
+#include "imagine/math/lin/solver/monitor.h"
 #include "imagine/math/lin/solver/precondition.h"
 
 namespace ig  {
@@ -16,29 +18,51 @@ template
 < typename Mat,
   typename Rhs,
   typename Lhs,
-  typename Precond >
-void cg(const matrix_base<Mat>& A, const matrix_base<Rhs>& b, matrix_base<Lhs>& x, const Precond& pre, double tolerance = 1e-7) {
+  typename Precond,
+  typename Monitor = null_monitor >
+auto cg(const matrix_base<Mat>& A, const matrix_base<Rhs>& b, matrix_base<Lhs>& x, const Precond& pre, const solver_control& ctrl, Monitor&& monitor = Monitor{}) {
+  using value_type = typename Precond::value_type;
   using vector_type = typename Precond::vector_type;
 
-  auto n = A.diagsize();
-  vector_type r = b - A % x;
+  auto n = A.diag_size();
+  vector_type r{n}, p{n},
+              z{n}, v{n};
+  value_type ro, rr, pv;
+
+  monitor.template time<solver_phase::op>([&] { r = b - A % x; });
+  monitor.template time<solver_phase::precond>([&] { p = pre.solve(r); });
+  monitor.template time<solver_phase::reduction>([&] { ro = dot(r, p), rr = dot(r, r); });
+
+  detail::solver_guard guard{ctrl, std::sqrt(double(dot(b, b)))};
+  monitor.start(guard.relative(rr));
 
-  auto threshold = tolerance * tolerance * dot(b, b);
-  auto p = pre.solve(r);
-  auto ro = dot(r, p), no = dot(r, r);
+  size_t k = 0;
+  auto status = guard.check(monitor, k, rr);
+  while (!status) {
+    monitor.template time<solver_phase::op>([&] { v = A % p; });
+    monitor.template time<solver_phase::reduction>([&] { pv = dot(p, v); });
 
-  vector_type z{n}, v{n};
-  while (dot(r, r) > threshold) {
-    v = A % p;
-    auto a = ro / dot(p, v);
+    if (pv == 0) {
+      status = solver_status::breakdown;
+      break;
+    }
+
+    auto a = ro / pv;
     x += a * p;
     r -= a * v;
 
-    z = pre.solve(r);
+    monitor.template time<solver_phase::precond>([&] { z = pre.solve(r); });
 
     auto rn = ro;
-    ro = dot(r, z), p = z + (ro / rn) * p;
+    monitor.template time<solver_phase::reduction>([&] { ro = dot(r, z), rr = dot(r, r); });
+    p = z + (ro / rn) * p;
+
+    status = guard.check(monitor, ++k, rr);
   }
+
+  solver_result result{*status, k, guard.relative(rr)};
+  monitor.finish(result);
+  return result;
 }
 
 template
@@ -46,48 +70,91 @@ template
   typename Rhs,
   typename Lhs,
   typename Precond >
-void bicgstab(const matrix_base<Mat>& A, const matrix_base<Rhs>& b, matrix_base<Lhs>& x, const Precond& pre, double tolerance = 1e-7) {
+auto cg(const matrix_base<Mat>& A, const matrix_base<Rhs>& b, matrix_base<Lhs>& x, const Precond& pre, double tolerance = 1e-7)
+{ return cg(A, b, x, pre, solver_control{tolerance}); }
+
+template
+< typename Mat,
+  typename Rhs,
+  typename Lhs,
+  typename Precond,
+  typename Monitor = null_monitor >
+auto bicgstab(const matrix_base<Mat>& A, const matrix_base<Rhs>& b, matrix_base<Lhs>& x, const Precond& pre, const solver_control& ctrl, Monitor&& monitor = Monitor{}) {
   using value_type = typename Precond::value_type;
   using vector_type = typename Precond::vector_type;
 
-  auto n = A.diagsize();
-  vector_type r = b - A % x;
-  vector_type rn = r;
+  auto n = A.diag_size();
+  vector_type r{n}, rn{n};
+  value_type ro, rr;
+
+  monitor.template time<solver_phase::op>([&] { r = b - A % x; });
+  monitor.template time<solver_phase::reduction>([&] { ro = rr = dot(r, r); });
+  rn = r;
 
-  auto threshold = tolerance * tolerance * dot(b, b);
-  auto ro = dot(r, r);
   value_type no = 1, a = 1, w = 1;
 
   vector_type v{n}, p{n},
               y{n}, z{n}, s{n}, t{n};
 
-  while (dot(r, r) > threshold) {
+  detail::solver_guard guard{ctrl, std::sqrt(double(dot(b, b)))};
+  monitor.start(guard.relative(rr));
+
+  size_t k = 0;
+  auto status = guard.check(monitor, k, rr);
+  while (!status) {
     auto nn = no;
-    no = dot(rn, r);
+    monitor.template time<solver_phase::reduction>([&] { no = dot(rn, r); });
 
     if (std::abs(no) < std::numeric_limits<value_type>::epsilon() * ro) {
-      r = b - A % x;
-      rn = r, no = ro = dot(r, r);
+      // Restart with a new shadow residual
+      monitor.template time<solver_phase::op>([&] { r = b - A % x; });
+      monitor.template time<solver_phase::reduction>([&] { rn = r, no = ro = dot(r, r); });
     }
 
     auto c = (no / nn) * (a / w);
     p = r + c * (p - w * v);
 
-    y = pre.solve(p); v = A % y;
-    a = no / dot(rn, v);
+    monitor.template time<solver_phase::precond>([&] { y = pre.solve(p); });
+    monitor.template time<solver_phase::op>([&] { v = A % y; });
+    monitor.template time<solver_phase::reduction>([&] { a = dot(rn, v); });
+
+    if (a == 0) {
+      status = solver_status::breakdown;
+      break;
+    }
+
+    a = no / a;
     s = r - a * v;
-    z = pre.solve(s); t = A % z;
 
-    auto tt = dot(t, t);
+    monitor.template time<solver_phase::precond>([&] { z = pre.solve(s); });
+    monitor.template time<solver_phase::op>([&] { t = A % z; });
+
+    value_type tt, ts;
+    monitor.template time<solver_phase::reduction>([&] { tt = dot(t, t), ts = dot(t, s); });
     w = tt > 0
-      ? dot(t, s) / tt
+      ? ts / tt
       : 0;
 
     x += a * y + w * z;
     r  = s - w * t;
+
+    monitor.template time<solver_phase::reduction>([&] { rr = dot(r, r); });
+    status = guard.check(monitor, ++k, rr);
   }
+
+  solver_result result{*status, k, guard.relative(rr)};
+  monitor.finish(result);
+  return result;
 }
 
+template
+< typename Mat,
+  typename Rhs,
+  typename Lhs,
+  typename Precond >
+auto bicgstab(const matrix_base<Mat>& A, const matrix_base<Rhs>& b, matrix_base<Lhs>& x, const Precond& pre, double tolerance = 1e-7)
+{ return bicgstab(A, b, x, pre, solver_control{tolerance}); }
+
 } // namespace lin
 } // namespace ig
 
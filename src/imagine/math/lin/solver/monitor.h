@@ -0,0 +1,180 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_MONITOR_H
+#define IG_MATH_MONITOR_H
+
+#include "imagine/ig.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace ig  {
+namespace lin {
+
+enum class solver_status { converged, max_iterations, stagnation, aborted, breakdown };
+enum class solver_phase  { op, precond, reduction };
+
+// Stopping criteria shared by all iterative solvers
+struct solver_control {
+  explicit solver_control(
+    double tolerance = 1e-7,
+    size_t max_iterations = std::numeric_limits<size_t>::max(),
+    size_t stagnation = 0,
+    double stagnation_ratio = 1e-3)
+    : tolerance{tolerance}
+    , max_iterations{max_iterations}
+    , stagnation{stagnation}
+    , stagnation_ratio{stagnation_ratio} {}
+
+  double tolerance;
+  size_t max_iterations;
+  // stop after <stagnation> iterations without a relative residual decrease of <stagnation_ratio> (0 disables)
+  size_t stagnation;
+  double stagnation_ratio;
+};
+
+struct solver_result {
+  explicit operator bool() const { return status == solver_status::converged; }
+
+  solver_status status;
+  size_t iterations;
+  double residual;
+};
+
+// Monitoring disabled, every hook folds away at compile time
+class null_monitor {
+public:
+  static constexpr bool enabled = false;
+
+  template <solver_phase Phase, typename Callable>
+  void time(Callable&& fn) { std::forward<Callable>(fn)(); }
+
+  constexpr void start(double) {}
+  constexpr bool iterate(size_t, double) { return true; }
+  constexpr void finish(const solver_result&) {}
+};
+
+class solver_monitor {
+public:
+  using clock = std::chrono::steady_clock;
+  using duration = std::chrono::duration<double>;
+  using callback = std::function< bool(const solver_monitor&) >;
+  static constexpr bool enabled = true;
+
+  solver_monitor() = default;
+  explicit solver_monitor(callback fn)
+    : callback_{std::move(fn)} {}
+
+  template <solver_phase Phase, typename Callable>
+  void time(Callable&& fn);
+
+  void start(double residual);
+  bool iterate(size_t iteration, double residual);
+  void finish(const solver_result& result);
+
+  auto iterations() const { return iterations_; }
+  auto& residuals() const { return residuals_; }
+  auto& result() const    { return result_; }
+
+  auto op_time() const        { return timings_[size_t(solver_phase::op)]; }
+  auto precond_time() const   { return timings_[size_t(solver_phase::precond)]; }
+  auto reduction_time() const { return timings_[size_t(solver_phase::reduction)]; }
+  auto total_time() const     { return total_; }
+
+private:
+  callback callback_;
+  size_t iterations_ = 0;
+  std::vector<double> residuals_;
+  solver_result result_{};
+
+  clock::time_point begin_;
+  std::array<duration, 3> timings_{};
+  duration total_{};
+};
+
+template <solver_phase Phase, typename Callable>
+void solver_monitor::time(Callable&& fn) {
+  auto begin = clock::now();
+  std::forward<Callable>(fn)();
+  timings_[size_t(Phase)] += clock::now() - begin;
+}
+
+inline void solver_monitor::start(double residual) {
+  iterations_ = 0;
+  residuals_.clear();
+  residuals_.push_back(residual);
+  timings_.fill(duration{0});
+  begin_ = clock::now();
+}
+
+inline bool solver_monitor::iterate(size_t iteration, double residual) {
+  iterations_ = iteration;
+  residuals_.push_back(residual);
+  return callback_
+    ? callback_(*this)
+    : true;
+}
+
+inline void solver_monitor::finish(const solver_result& result) {
+  result_ = result;
+  total_ = clock::now() - begin_;
+}
+
+namespace detail {
+
+// Tracks the convergence criteria of a solve and produces the final result
+class solver_guard {
+public:
+  explicit solver_guard(const solver_control& ctrl, double norm)
+    : ctrl_{ctrl}
+    , norm_{norm > 0 ? norm : 1}
+    , best_{std::numeric_limits<double>::max()}
+    , last_{0} {}
+
+  auto relative(double rr) const { return std::sqrt(rr) / norm_; }
+
+  template <typename Monitor>
+  auto check(Monitor& monitor, size_t iteration, double rr) -> std::optional<solver_status>;
+
+private:
+  const solver_control& ctrl_;
+  double norm_, best_;
+  size_t last_;
+};
+
+template <typename Monitor>
+auto solver_guard::check(Monitor& monitor, size_t iteration, double rr) -> std::optional<solver_status> {
+  auto residual = relative(rr);
+  if (iteration > 0 && !monitor.iterate(iteration, residual))
+    return solver_status::aborted;
+
+  if (residual <= ctrl_.tolerance)
+    return solver_status::converged;
+  if (!std::isfinite(residual))
+    return solver_status::breakdown;
+  if (iteration >= ctrl_.max_iterations)
+    return solver_status::max_iterations;
+
+  if (ctrl_.stagnation) {
+    if (residual < best_ * (1 - ctrl_.stagnation_ratio))
+      best_ = residual,
+      last_ = iteration;
+    else if (iteration - last_ >= ctrl_.stagnation)
+      return solver_status::stagnation;
+  } return std::nullopt;
+}
+
+} // namespace detail
+} // namespace lin
+} // namespace ig
+
+#endif // IG_MATH_MONITOR_H
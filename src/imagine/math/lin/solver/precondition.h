@@ -21,9 +21,9 @@ public:
   static_assert(std::is_arithmetic<value_type>::value, "Jacobi preconditioner requires an arithmetic matrix");
 
   explicit jacobi_preconditioner(const matrix_type& mat)
-    : invdiag_{mat.diagsize()} {
+    : invdiag_{mat.diag_size()} {
 
-    for (size_t i = 0; i < mat.diagsize(); ++i)
+    for (size_t i = 0; i < mat.diag_size(); ++i)
       invdiag_[i] = mat(i, i) != 0
         ? 1 / mat(i, i)
         : 1;
@@ -0,0 +1,450 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_CONV_H
+#define IG_MATH_CONV_H
+
+#include "imagine/math/theory/ndarray.h"
+#include "imagine/math/theory/detail/gemm.h"
+#include "imagine/math/theory/quant.h"
+
+namespace ig {
+
+// direct: loops over the kernel taps, vectorized along the first spatial dimension
+// im2col: patches are unrolled in columns and multiplied by the weights
+enum class conv_method { automatic, direct, im2col };
+
+// Per spatial dimension, an empty stride is one and an empty padding is zero
+struct conv_params {
+  nd::shape_array stride;
+  nd::shape_array pad;
+  conv_method method = conv_method::automatic;
+
+  // Output of the input extent for odd kernels
+  template <typename Shape>
+  static auto same(const Shape& kernel) {
+    conv_params p;
+    for (auto k : kernel) p.pad.push_back(k / 2);
+    return p;
+  }
+};
+
+namespace detail {
+
+// Arrays are laid out (channels, spatial..., batch), the channel and batch axes are optional
+// planes are single channel, zero padded and dense copies of the spatial dimensions
+struct conv_geometry {
+  template <typename View>
+  conv_geometry(const View& v, const nd::shape_array& kernel, const conv_params& p, bool channels)
+    : dims{kernel.size()}
+    , kernel{kernel} {
+    assert(v.dims() >= dims + channels && v.dims() <= dims + 2 && "Invalid convolution input dimensions");
+    first = v.dims() > dims ? 1 : 0;
+    batched = v.dims() == dims + 2;
+    channel = first ? v.shape()[0] : 1;
+    batch = batched ? v.shape()[dims + 1] : 1;
+
+    for (size_t d = 0; d < dims; ++d) {
+      auto s = p.stride.empty() ? 1 : p.stride[d];
+      auto q = p.pad.empty()    ? 0 : p.pad[d];
+      auto n = v.shape()[first + d];
+      assert(s > 0 && n + 2 * q >= kernel[d] && "Invalid convolution, kernel larger than the padded input");
+
+      in.push_back(n);
+      stride.push_back(s);
+      pad.push_back(q);
+      padded.push_back(n + 2 * q);
+      out.push_back((n + 2 * q - kernel[d]) / s + 1);
+    }
+  }
+
+  static auto volume(const nd::shape_array& s) { return std::accumulate(s.begin(), s.end(), size_t(1), std::multiplies<>{}); }
+
+  // Output array of the given channels
+  auto shape(size_t channels) const {
+    nd::shape_array s;
+    if (first) s.push_back(channels);
+    for (auto o : out) s.push_back(o);
+    if (batched) s.push_back(batch);
+    return s;
+  }
+
+  size_t dims;
+  size_t first, channel, batch;
+  bool batched;
+  nd::shape_array kernel, in, out, stride, pad, padded;
+};
+
+// out(x) += w * in(x * stride)
+template <typename T>
+void conv_axpy(T* out, const T* in, T w, size_t n, size_t stride) {
+  size_t x = 0;
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<T, float>) {
+    if (stride == 1) {
+      packet pw{w};
+      for (; x + IG_PACKET_WIDE <= n; x += IG_PACKET_WIDE)
+        nd::store(out + x, nd::load(out + x) + pw * nd::load(in + x));
+    }
+  }
+#endif
+  for (; x < n; ++x) out[x] += w * in[x * stride];
+}
+
+// Padded plane q = channel + channels * batch
+template <typename T, typename View>
+void conv_plane(const View& v, const conv_geometry& g, size_t q, T* dst) {
+  std::fill_n(dst, g.volume(g.padded), T(0));
+
+  auto c = q % g.channel, n = q / g.channel;
+  auto base = v.buffer()
+    + (g.first   ? std::ptrdiff_t(c) * v.strides()[0] : 0)
+    + (g.batched ? std::ptrdiff_t(n) * v.strides()[g.dims + 1] : 0);
+
+  auto dense = nd::dense_strides(g.padded);
+  auto rows = g.volume(g.in) / g.in[0];
+  auto xs = v.strides()[g.first];
+  for (size_t r = 0; r < rows; ++r) {
+    std::ptrdiff_t src = 0, off = std::ptrdiff_t(g.pad[0]);
+    for (size_t d = 1, i = r; d < g.dims; ++d) {
+      auto x = i % g.in[d]; i /= g.in[d];
+      src += std::ptrdiff_t(x) * v.strides()[g.first + d];
+      off += std::ptrdiff_t(x + g.pad[d]) * dense[d];
+    }
+    for (size_t x = 0; x < g.in[0]; ++x)
+      dst[off + std::ptrdiff_t(x)] = T(base[src + std::ptrdiff_t(x) * xs]);
+  }
+}
+
+// Output planes are sums of input planes correlated with kernels, computed row by row across the job pool
+// the taps of the kernel (oc, ic) start at w + oc * os + ic * is and are ws apart
+template <typename T>
+void conv_direct(const T* planes, const conv_geometry& g, size_t outputs, bool depthwise, const T* w, size_t os, size_t is, size_t ws, T* out) {
+  auto size = g.volume(g.padded);
+  auto taps = g.volume(g.kernel);
+  auto rows = g.volume(g.out) / g.out[0];
+  auto dense = nd::dense_strides(g.padded);
+  auto inputs = depthwise ? 1 : g.channel;
+  auto cost = g.out[0] * taps * inputs;
+
+  parallel_for(0, outputs * g.batch * rows, std::max<size_t>(1, nd::parallel_grain / std::max<size_t>(cost, 1)), [&](size_t first, size_t last) {
+    std::vector<T> acc(g.out[0]);
+    for (auto id = first; id < last; ++id) {
+      auto r = id % rows, q = id / rows;
+      auto oc = q % outputs, n = q / outputs;
+
+      std::ptrdiff_t row = 0, dst = 0, po = std::ptrdiff_t(g.out[0]);
+      for (size_t d = 1, i = r; d < g.dims; ++d) {
+        auto o = i % g.out[d]; i /= g.out[d];
+        row += std::ptrdiff_t(o * g.stride[d]) * dense[d];
+        dst += std::ptrdiff_t(o) * po, po *= std::ptrdiff_t(g.out[d]);
+      }
+
+      std::fill(acc.begin(), acc.end(), T(0));
+      for (size_t i = 0; i < inputs; ++i) {
+        auto ic = depthwise ? oc : i;
+        auto plane = planes + (ic + g.channel * n) * size + row;
+        auto k = w + oc * os + ic * is;
+
+        for (size_t t = 0; t < taps; t += g.kernel[0]) {
+          std::ptrdiff_t off = 0;
+          for (size_t d = 1, j = t / g.kernel[0]; d < g.dims; ++d)
+            off += std::ptrdiff_t(j % g.kernel[d]) * dense[d],
+            j /= g.kernel[d];
+          for (size_t t0 = 0; t0 < g.kernel[0]; ++t0) {
+            auto wt = k[(t + t0) * ws];
+            if (wt != T(0)) conv_axpy(acc.data(), plane + off + std::ptrdiff_t(t0), wt, g.out[0], g.stride[0]);
+          }
+        }
+      }
+
+      auto o = out + std::ptrdiff_t(oc) + std::ptrdiff_t(outputs) * (dst + std::ptrdiff_t(n) * std::ptrdiff_t(g.volume(g.out)));
+      for (size_t x = 0; x < g.out[0]; ++x) o[std::ptrdiff_t(x * outputs)] = acc[x];
+    }
+  });
+}
+
+// One dimensional pass along an outer dimension d of a dense block, its extent goes from shape[d] to out
+// the taps are added as whole runs of the faster dimensions
+template <typename T>
+void conv_pass(const T* in, nd::shape_array& shape, size_t d, const std::vector<T>& u, size_t stride, size_t out, T* dst) {
+  auto inner = conv_geometry::volume(nd::shape_array{shape.begin(), shape.begin() + d});
+  auto outer = conv_geometry::volume(shape) / (inner * shape[d]);
+  auto n = shape[d];
+
+  parallel_for(0, outer * out, std::max<size_t>(1, nd::parallel_grain / std::max<size_t>(1, inner * u.size())), [&](size_t first, size_t last) {
+    for (auto id = first; id < last; ++id) {
+      auto o = id % out, r = id / out;
+      auto src = in + (r * n + o * stride) * inner;
+      auto res = dst + (r * out + o) * inner;
+      std::fill_n(res, inner, T(0));
+      for (size_t t = 0; t < u.size(); ++t) conv_axpy(res, src + t * inner, u[t], inner, 1);
+    }
+  });
+  shape[d] = out;
+}
+
+// Rows along the first dimension are filtered as a whole
+template <typename T>
+void conv_pass_rows(const T* in, nd::shape_array& shape, const std::vector<T>& u, size_t stride, size_t out, T* dst) {
+  auto rows = conv_geometry::volume(shape) / shape[0];
+  auto n = shape[0];
+  parallel_for(0, rows, std::max<size_t>(1, nd::parallel_grain / std::max<size_t>(1, out * u.size())), [&](size_t first, size_t last) {
+    for (auto r = first; r < last; ++r) {
+      auto res = dst + r * out;
+      std::fill_n(res, out, T(0));
+      for (size_t t = 0; t < u.size(); ++t) conv_axpy(res, in + r * n + t, u[t], out, stride);
+    }
+  });
+  shape[0] = out;
+}
+
+// Factors u(d) of a kernel that is their outer product, empty otherwise
+template <typename T>
+auto conv_rank1(const ndarray<T>& k) {
+  std::vector< std::vector<T> > u;
+  auto& shape = k.shape();
+  if (k.dims() < 2)
+    return u;
+
+  auto pivot = size_t(std::max_element(k.buffer(), k.buffer() + k.size(), [](auto a, auto b) { return std::abs(a) < std::abs(b); }) - k.buffer());
+  auto peak = k(pivot);
+  if (peak == T(0))
+    return u;
+
+  // Lines through the pivot, all but the first are normalized by it
+  auto dense = nd::dense_strides(shape);
+  for (size_t d = 0, p = pivot; d < k.dims(); ++d, p /= shape[d - 1]) {
+    auto at = pivot - (p % shape[d]) * size_t(dense[d]);
+    u.emplace_back(shape[d]);
+    for (size_t i = 0; i < shape[d]; ++i)
+      u[d][i] = k(at + i * size_t(dense[d])) / (d ? peak : T(1));
+  }
+
+  auto tol = std::abs(peak) * T(1e-5);
+  for (size_t i = 0; i < k.size(); ++i) {
+    T v = 1;
+    for (size_t d = 0, j = i; d < k.dims(); ++d)
+      v *= u[d][j % shape[d]],
+      j /= shape[d];
+    if (std::abs(v - k(i)) > tol) return decltype(u){};
+  } return u;
+}
+
+// Every plane is filtered by successive one dimensional passes
+template <typename T, typename View>
+void conv_separable(const View& v, const conv_geometry& g, const std::vector< std::vector<T> >& u, T* out) {
+  auto planes = g.channel * g.batch;
+  auto outs = g.volume(g.out);
+  parallel_for(0, planes, 1, [&](size_t first, size_t last) {
+    std::vector<T> a(g.volume(g.padded)), b(a.size());
+    for (auto q = first; q < last; ++q) {
+      conv_plane(v, g, q, a.data());
+      auto shape = g.padded;
+      for (size_t d = 0; d < g.dims; ++d) {
+        if (d == 0) conv_pass_rows(a.data(), shape, u[d], g.stride[d], g.out[d], b.data());
+        else        conv_pass(a.data(), shape, d, u[d], g.stride[d], g.out[d], b.data());
+        std::swap(a, b);
+      }
+
+      auto c = q % g.channel, n = q / g.channel;
+      auto o = out + c + g.channel * n * outs;
+      for (size_t i = 0; i < outs; ++i) o[i * g.channel] = a[i];
+    }
+  });
+}
+
+// Columns hold the patches of a range of output positions, channels first then taps
+// c(oc, p) = w(oc, ic + channels * tap) col(ic + channels * tap, p), with w and c channels first
+// product(col, k, p0, p1, n) multiplies the columns of positions [p0, p1) of batch n
+template <typename T, typename View, typename Product>
+void conv_im2col(const View& v, const conv_geometry& g, Product&& product) {
+  auto taps = g.volume(g.kernel);
+  auto k = g.channel * taps;
+  auto positions = g.volume(g.out);
+
+  // Columns of a task stay within a few cache blocks, and tasks are enough to keep every thread busy
+  auto threads = in_parallel() ? size_t(1) : pool().size() + 1;
+  auto chunk = std::max<size_t>(64, (size_t(1) << 18) / std::max<size_t>(k, 1));
+  chunk = std::min(chunk, std::max<size_t>(64, (positions * g.batch + threads - 1) / threads));
+  auto chunks = (positions + chunk - 1) / chunk;
+
+  auto cs = g.first ? v.strides()[0] : 0;
+  parallel_for(0, g.batch * chunks, 1, [&](size_t first, size_t last) {
+    std::vector<T> col(k * chunk);
+    for (auto id = first; id < last; ++id) {
+      auto n = id / chunks;
+      auto p0 = (id % chunks) * chunk, p1 = std::min(positions, p0 + chunk);
+      auto base = v.buffer() + (g.batched ? std::ptrdiff_t(n) * v.strides()[g.dims + 1] : 0);
+
+      for (auto p = p0; p < p1; ++p) {
+        auto dst = col.data() + (p - p0) * k;
+        for (size_t t = 0; t < taps; ++t, dst += g.channel) {
+          std::ptrdiff_t src = 0;
+          bool inside = true;
+          for (size_t d = 0, i = p, j = t; d < g.dims; ++d) {
+            auto x = std::ptrdiff_t((i % g.out[d]) * g.stride[d] + j % g.kernel[d]) - std::ptrdiff_t(g.pad[d]);
+            i /= g.out[d], j /= g.kernel[d];
+            inside = inside && x >= 0 && x < std::ptrdiff_t(g.in[d]);
+            src += x * v.strides()[g.first + d];
+          }
+
+          if (!inside) std::fill_n(dst, g.channel, T(0));
+          else for (size_t c = 0; c < g.channel; ++c) dst[c] = T(base[src + std::ptrdiff_t(c) * cs]);
+        }
+      }
+
+      product(col.data(), k, p0, p1, n);
+    }
+  });
+}
+
+template <typename T, typename View>
+void conv_im2col(const View& v, const conv_geometry& g, size_t outputs, const T* w, T* out) {
+  auto positions = g.volume(g.out);
+  conv_im2col<T>(v, g, [&](const T* col, size_t k, size_t p0, size_t p1, size_t n) {
+    gemm(outputs, p1 - p0, k, T(1),
+      gemm_operand<const T>{w, 1, std::ptrdiff_t(outputs)},
+      gemm_operand<const T>{col, 1, std::ptrdiff_t(k)},
+      T(0),
+      gemm_operand<T>{out + outputs * (p0 + positions * n), 1, std::ptrdiff_t(outputs)});
+  });
+}
+
+// Quantized layer through int8 columns, the output channels are rescaled by the scales of the weights
+template <typename Out, typename View>
+void conv_quant(const View& v, const conv_geometry& g, size_t outputs, const int8_t* w, const qgemm_scales& s, Out* out) {
+  auto positions = g.volume(g.out);
+  conv_im2col<int8_t>(v, g, [&](const int8_t* col, size_t k, size_t p0, size_t p1, size_t n) {
+    qgemm(outputs, p1 - p0, k,
+      gemm_operand<const int8_t>{w, 1, std::ptrdiff_t(outputs)},
+      gemm_operand<const int8_t>{col, 1, std::ptrdiff_t(k)},
+      s,
+      gemm_operand<Out>{out + outputs * (p0 + positions * n), 1, std::ptrdiff_t(outputs)});
+  });
+}
+
+template <typename View, typename T>
+auto conv_planes(const View& v, const conv_geometry& g, std::vector<T>& planes) {
+  auto size = g.volume(g.padded);
+  planes.resize(size * g.channel * g.batch);
+  parallel_for(0, g.channel * g.batch, 1, [&](size_t first, size_t last) {
+    for (auto q = first; q < last; ++q) conv_plane(v, g, q, planes.data() + q * size);
+  });
+}
+
+template <typename Out>
+auto conv_quant(const quantized& in, const quantized& weights, const conv_params& params, float out) {
+  assert(weights.values.dims() >= 3 && "Invalid convolution weights, expected (out channels, in channels, kernel...)");
+  assert(in.scales.size() == 1 && (weights.scales.size() == 1 || weights.axis == 0) && "Invalid quantized convolution, scales must be per tensor for the input and per output channel for the weights");
+
+  auto outputs = weights.shape()[0];
+  nd::shape_array kernel{weights.shape().begin() + 2, weights.shape().end()};
+
+  auto v = nd::as_view(in.values);
+  conv_geometry g{v, kernel, params, true};
+  assert(weights.shape()[1] == g.channel && "Invalid convolution weights, input channels mismatch");
+  ndarray<Out> res{g.shape(outputs)};
+
+  qgemm_scales s{weights.scales.data(), weights.stride(), in.scales.data(), 0};
+  s.out = out;
+  conv_quant(v, g, outputs, weights.values.buffer(), s, res.buffer());
+  return res;
+}
+
+template <typename... Arrs>
+using conv_t = std::common_type_t<ndarray_t<Arrs>..., float>;
+
+} // namespace detail
+
+// Correlation of every channel with the same kernel (flip it for a convolution)
+// the input is (channels, spatial..., batch) with as many spatial dimensions as the kernel, channels and batch are optional
+// kernels that are outer products of vectors are applied as successive one dimensional passes
+template <typename Arr, typename Ker>
+auto filter(const ndarray_base<Arr>& arr, const ndarray_base<Ker>& kernel, const conv_params& params = {}) {
+  using T = detail::conv_t<Arr, Ker>;
+
+  const ndarray<T> k{kernel};
+  return nd::detail::with_layout(arr, [&](const auto& v) {
+    detail::conv_geometry g{v, k.shape(), params, false};
+    ndarray<T> res{g.shape(g.channel)};
+
+    auto u = detail::conv_rank1(k);
+    if (!u.empty()) {
+      detail::conv_separable(v, g, u, res.buffer());
+    } else {
+      std::vector<T> planes;
+      detail::conv_planes(v, g, planes);
+      detail::conv_direct(planes.data(), g, g.channel, true, k.buffer(), 0, 0, 1, res.buffer());
+    } return res;
+  });
+}
+
+// Separable correlation with one kernel per spatial dimension
+template <typename Arr, typename K>
+auto filter(const ndarray_base<Arr>& arr, const std::vector< std::vector<K> >& kernels, const conv_params& params = {}) {
+  using T = std::common_type_t<ndarray_t<Arr>, K, float>;
+
+  nd::shape_array extent;
+  std::vector< std::vector<T> > u;
+  for (auto& k : kernels)
+    extent.push_back(k.size()),
+    u.emplace_back(k.begin(), k.end());
+
+  return nd::detail::with_layout(arr, [&](const auto& v) {
+    detail::conv_geometry g{v, extent, params, false};
+    ndarray<T> res{g.shape(g.channel)};
+    detail::conv_separable(v, g, u, res.buffer());
+    return res;
+  });
+}
+
+// Layer of a convolutional network, out(oc) = sum over ic of in(ic) correlated with weights(oc, ic)
+// the input is (in channels, spatial..., batch) with an optional batch, the weights are (out channels, in channels, kernel...)
+// few channels are correlated directly plane by plane, the others are unrolled and multiplied
+template <typename Arr, typename Wgt>
+auto conv(const ndarray_base<Arr>& arr, const ndarray_base<Wgt>& weights, const conv_params& params = {}) {
+  using T = detail::conv_t<Arr, Wgt>;
+  assert(weights.dims() >= 3 && "Invalid convolution weights, expected (out channels, in channels, kernel...)");
+
+  const ndarray<T> w{weights};
+  auto outputs = w.shape()[0];
+  nd::shape_array kernel{w.shape().begin() + 2, w.shape().end()};
+
+  return nd::detail::with_layout(arr, [&](const auto& v) {
+    detail::conv_geometry g{v, kernel, params, true};
+    assert(w.shape()[1] == g.channel && "Invalid convolution weights, input channels mismatch");
+    ndarray<T> res{g.shape(outputs)};
+
+    auto method = params.method;
+    if (method == conv_method::automatic)
+      method = g.channel * outputs <= 16 ? conv_method::direct : conv_method::im2col;
+
+    // Dense weights are (oc + outputs * (ic + channels * tap))
+    if (method == conv_method::direct) {
+      std::vector<T> planes;
+      detail::conv_planes(v, g, planes);
+      detail::conv_direct(planes.data(), g, outputs, false, w.buffer(), 1, outputs, outputs * g.channel, res.buffer());
+    } else {
+      detail::conv_im2col(v, g, outputs, w.buffer(), res.buffer());
+    } return res;
+  });
+}
+
+// Quantized layer, the input has a single scale and the weights one per tensor or per output channel
+// patches are always unrolled, the int8 products accumulate in 32 bits and are rescaled to float
+inline auto conv(const quantized& in, const quantized& weights, const conv_params& params = {}) {
+  return detail::conv_quant<float>(in, weights, params, 1.f);
+}
+
+// Quantized layer requantized at the scale of the output
+inline auto conv(const quantized& in, const quantized& weights, float out, const conv_params& params = {}) {
+  return quantized{detail::conv_quant<int8_t>(in, weights, params, out), {out}, 0};
+}
+
+} // namespace ig
+
+#endif // IG_MATH_CONV_H
@@ -0,0 +1,647 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_FFT_H
+#define IG_MATH_FFT_H
+
+#include "imagine/math/basis.h"
+#include "imagine/math/theory/detail/ndarray/reduce.h"
+#include "imagine/core/net/distribute.h"
+
+#include <complex>
+#include <memory>
+
+namespace ig {
+
+// Discrete Fourier transforms, X(k) = sum of x(j) e^(-2 pi i jk / n)
+// lengths with factors 2, 3 and 5 run mixed radix stockham passes, the others use bluestein chirp convolutions
+// plans are unnormalized, ifft and irfft on ndarrays divide by n like numpy
+template <typename T>
+class fft_plan {
+public:
+  static_assert(std::is_floating_point_v<T>, "Unsupported fft element type");
+
+  explicit fft_plan(size_t n);
+
+  auto size() const { return n_; }
+  // Scratch elements of each component required by run
+  auto work() const { return sub_ ? 2 * sub_->size() : n_; }
+
+  // Transforms lanes of split complex data in place, V is either T or a packet of T
+  // re and im hold n elements, tr and ti hold work() elements
+  template <typename V>
+  void run(V* re, V* im, V* tr, V* ti, bool inverse = false) const;
+
+  // Single contiguous line
+  void operator()(std::complex<T>* data, bool inverse = false) const;
+
+private:
+  template <typename V> void stockham(V* re, V* im, V* tr, V* ti) const;
+  template <typename V> void bluestein(V* re, V* im, V* tr, V* ti) const;
+
+  size_t n_;
+  std::vector<size_t> radices_;
+  // Twiddles of every pass, (radix - 1) factors for each butterfly span offset
+  std::vector<size_t> passes_;
+  std::vector<T> wr_, wi_;
+
+  // Chirp, transformed kernel and smooth length convolution plan of bluestein
+  std::shared_ptr<const fft_plan> sub_;
+  std::vector<T> cr_, ci_, kr_, ki_;
+};
+
+// Real input transform, n / 2 + 1 bins, even lengths are computed through a half length complex transform
+template <typename T>
+class rfft_plan {
+public:
+  explicit rfft_plan(size_t n);
+
+  auto size() const { return n_; }
+  auto bins() const { return n_ / 2 + 1; }
+  // Elements of each spectrum component and of each scratch component
+  auto span() const { return std::max(bins(), half_.size()); }
+  auto work() const { return half_.work(); }
+
+  // x holds n reals, re and im hold span() elements and receive the bins
+  template <typename V>
+  void forward(const V* x, V* re, V* im, V* tr, V* ti) const;
+  // The bins of re and im are overwritten, x receives n times the signal
+  template <typename V>
+  void inverse(V* re, V* im, V* x, V* tr, V* ti) const;
+
+private:
+  size_t n_;
+  fft_plan<T> half_;
+  std::vector<T> wr_, wi_;
+};
+
+namespace detail {
+
+// Lowest 2, 3, 5-smooth number that is not less than n
+inline auto fft_smooth(size_t n) {
+  for (;; ++n) {
+    auto m = n;
+    for (size_t p : {2, 3, 5})
+      while (m % p == 0) m /= p;
+    if (m == 1) return n;
+  }
+}
+
+template <typename V, typename T>
+auto fft_splat(T v) {
+  if constexpr (std::is_same_v<V, T>) return v;
+  else return V{v};
+}
+
+// (ar + i ai) * (br + i bi)
+template <typename V>
+void fft_mul(V& ar, V& ai, const V& br, const V& bi) {
+  auto r = ar * br - ai * bi;
+  ai = ar * bi + ai * br;
+  ar = r;
+}
+
+// Forward butterflies, y(k) = sum of a(r) e^(-2 pi i rk / R)
+template <size_t R, typename T, typename V>
+void fft_butterfly(V (&re)[R], V (&im)[R]) {
+  if constexpr (R == 2) {
+    auto r = re[0] - re[1], i = im[0] - im[1];
+    re[0] = re[0] + re[1], im[0] = im[0] + im[1];
+    re[1] = r, im[1] = i;
+  } else if constexpr (R == 3) {
+    auto h = fft_splat<V>(T(0.5)), s = fft_splat<V>(T(0.86602540378443864676));
+    auto t1r = re[1] + re[2], t1i = im[1] + im[2];
+    auto t2r = (re[1] - re[2]) * s, t2i = (im[1] - im[2]) * s;
+    auto mr = re[0] - t1r * h, mi = im[0] - t1i * h;
+    re[0] = re[0] + t1r, im[0] = im[0] + t1i;
+    re[1] = mr + t2i, im[1] = mi - t2r;
+    re[2] = mr - t2i, im[2] = mi + t2r;
+  } else if constexpr (R == 4) {
+    auto t0r = re[0] + re[2], t0i = im[0] + im[2];
+    auto t1r = re[0] - re[2], t1i = im[0] - im[2];
+    auto t2r = re[1] + re[3], t2i = im[1] + im[3];
+    auto t3r = re[1] - re[3], t3i = im[1] - im[3];
+    re[0] = t0r + t2r, im[0] = t0i + t2i;
+    re[2] = t0r - t2r, im[2] = t0i - t2i;
+    re[1] = t1r + t3i, im[1] = t1i - t3r;
+    re[3] = t1r - t3i, im[3] = t1i + t3r;
+  } else if constexpr (R == 5) {
+    auto c1 = fft_splat<V>(T( 0.30901699437494742410)), s1 = fft_splat<V>(T(0.95105651629515357212));
+    auto c2 = fft_splat<V>(T(-0.80901699437494742410)), s2 = fft_splat<V>(T(0.58778525229247312917));
+    auto t1r = re[1] + re[4], t1i = im[1] + im[4];
+    auto t2r = re[2] + re[3], t2i = im[2] + im[3];
+    auto t3r = re[1] - re[4], t3i = im[1] - im[4];
+    auto t4r = re[2] - re[3], t4i = im[2] - im[3];
+    auto m1r = re[0] + c1 * t1r + c2 * t2r, m1i = im[0] + c1 * t1i + c2 * t2i;
+    auto m2r = re[0] + c2 * t1r + c1 * t2r, m2i = im[0] + c2 * t1i + c1 * t2i;
+    auto n1r = s1 * t3r + s2 * t4r, n1i = s1 * t3i + s2 * t4i;
+    auto n2r = s2 * t3r - s1 * t4r, n2i = s2 * t3i - s1 * t4i;
+    re[0] = re[0] + t1r + t2r, im[0] = im[0] + t1i + t2i;
+    re[1] = m1r + n1i, im[1] = m1i - n1r;
+    re[4] = m1r - n1i, im[4] = m1i + n1r;
+    re[2] = m2r + n2i, im[2] = m2i - n2r;
+    re[3] = m2r - n2i, im[3] = m2i + n2r;
+  }
+}
+
+// Self-sorting pass over butterflies of span ns, inputs are n / R apart and outputs ns apart
+template <size_t R, typename T, typename V>
+void fft_pass(size_t n, size_t ns, const T* wr, const T* wi, const V* xr, const V* xi, V* yr, V* yi) {
+  auto m = n / R;
+  for (size_t k = 0; k < ns; ++k) {
+    V twr[R], twi[R];
+    for (size_t r = 1; r < R; ++r)
+      twr[r] = fft_splat<V>(wr[k * (R - 1) + r - 1]),
+      twi[r] = fft_splat<V>(wi[k * (R - 1) + r - 1]);
+
+    for (size_t q = 0; q < m / ns; ++q) {
+      auto j = q * ns + k;
+      V ar[R], ai[R];
+      for (size_t r = 0; r < R; ++r)
+        ar[r] = xr[j + r * m],
+        ai[r] = xi[j + r * m];
+      if (k)
+        for (size_t r = 1; r < R; ++r) fft_mul(ar[r], ai[r], twr[r], twi[r]);
+
+      fft_butterfly<R, T>(ar, ai);
+      auto o = q * ns * R + k;
+      for (size_t r = 0; r < R; ++r)
+        yr[o + r * ns] = ar[r],
+        yi[o + r * ns] = ai[r];
+    }
+  }
+}
+
+} // namespace detail
+
+template <typename T>
+fft_plan<T>::fft_plan(size_t n) : n_{n} {
+  assert(n > 0 && "Invalid fft length");
+
+  auto m = n;
+  while (m % 4 == 0) radices_.push_back(4), m /= 4;
+  for (size_t p : {2, 3, 5})
+    while (m % p == 0) radices_.push_back(p), m /= p;
+
+  if (m == 1) {
+    size_t ns = 1;
+    for (auto r : radices_) {
+      passes_.push_back(wr_.size());
+      for (size_t k = 0; k < ns; ++k)
+        for (size_t q = 1; q < r; ++q) {
+          auto a = -two_pi<double> * double(k * q) / double(ns * r);
+          wr_.push_back(T(std::cos(a)));
+          wi_.push_back(T(std::sin(a)));
+        }
+      ns *= r;
+    } return;
+  }
+
+  radices_.clear();
+  auto len = detail::fft_smooth(2 * n - 1);
+  sub_ = std::make_shared<const fft_plan>(len);
+
+  // Chirp w(j) = e^(-i pi j^2 / n), the kernel is the transform of its conjugate wrapped around len
+  cr_.resize(n), ci_.resize(n);
+  kr_.assign(len, 0), ki_.assign(len, 0);
+  for (size_t j = 0; j < n; ++j) {
+    auto a = pi<double> * double((j * j) % (2 * n)) / double(n);
+    cr_[j] = T(std::cos(a));
+    ci_[j] = T(-std::sin(a));
+    kr_[j] = cr_[j], ki_[j] = -ci_[j];
+    if (j) kr_[len - j] = kr_[j], ki_[len - j] = ki_[j];
+  }
+
+  std::vector<T> tr(len), ti(len);
+  sub_->run(kr_.data(), ki_.data(), tr.data(), ti.data());
+  for (size_t k = 0; k < len; ++k)
+    kr_[k] /= T(len),
+    ki_[k] /= T(len);
+}
+
+template <typename T> template <typename V>
+void fft_plan<T>::run(V* re, V* im, V* tr, V* ti, bool inverse) const {
+  // Inverses conjugate the input and output of the forward transform
+  auto zero = detail::fft_splat<V>(T(0));
+  if (inverse)
+    for (size_t j = 0; j < n_; ++j) im[j] = zero - im[j];
+
+  if (sub_) bluestein(re, im, tr, ti);
+  else      stockham (re, im, tr, ti);
+
+  if (inverse)
+    for (size_t j = 0; j < n_; ++j) im[j] = zero - im[j];
+}
+
+template <typename T> template <typename V>
+void fft_plan<T>::stockham(V* re, V* im, V* tr, V* ti) const {
+  auto xr = re, xi = im, yr = tr, yi = ti;
+  size_t ns = 1;
+  for (size_t s = 0; s < radices_.size(); ++s) {
+    auto wr = wr_.data() + passes_[s], wi = wi_.data() + passes_[s];
+    switch (radices_[s]) {
+    case 2: detail::fft_pass<2>(n_, ns, wr, wi, xr, xi, yr, yi); break;
+    case 3: detail::fft_pass<3>(n_, ns, wr, wi, xr, xi, yr, yi); break;
+    case 4: detail::fft_pass<4>(n_, ns, wr, wi, xr, xi, yr, yi); break;
+    case 5: detail::fft_pass<5>(n_, ns, wr, wi, xr, xi, yr, yi); break;
+    }
+
+    std::swap(xr, yr), std::swap(xi, yi);
+    ns *= radices_[s];
+  }
+
+  if (xr != re)
+    std::copy(xr, xr + n_, re),
+    std::copy(xi, xi + n_, im);
+}
+
+template <typename T> template <typename V>
+void fft_plan<T>::bluestein(V* re, V* im, V* tr, V* ti) const {
+  using detail::fft_splat;
+
+  auto len = sub_->size();
+  auto zero = fft_splat<V>(T(0));
+  for (size_t j = 0; j < n_; ++j) {
+    tr[j] = re[j], ti[j] = im[j];
+    detail::fft_mul(tr[j], ti[j], fft_splat<V>(cr_[j]), fft_splat<V>(ci_[j]));
+  }
+  std::fill(tr + n_, tr + len, zero);
+  std::fill(ti + n_, ti + len, zero);
+
+  sub_->run(tr, ti, tr + len, ti + len);
+  for (size_t k = 0; k < len; ++k)
+    detail::fft_mul(tr[k], ti[k], fft_splat<V>(kr_[k]), fft_splat<V>(ki_[k]));
+  sub_->run(tr, ti, tr + len, ti + len, true);
+
+  for (size_t k = 0; k < n_; ++k) {
+    re[k] = tr[k], im[k] = ti[k];
+    detail::fft_mul(re[k], im[k], fft_splat<V>(cr_[k]), fft_splat<V>(ci_[k]));
+  }
+}
+
+template <typename T>
+void fft_plan<T>::operator()(std::complex<T>* data, bool inverse) const {
+  std::vector<T> buf(2 * n_ + 2 * work());
+  auto re = buf.data(), im = re + n_, tr = im + n_, ti = tr + work();
+  for (size_t j = 0; j < n_; ++j)
+    re[j] = data[j].real(),
+    im[j] = data[j].imag();
+
+  run(re, im, tr, ti, inverse);
+  for (size_t j = 0; j < n_; ++j)
+    data[j] = {re[j], im[j]};
+}
+
+template <typename T>
+rfft_plan<T>::rfft_plan(size_t n)
+  : n_{n}
+  , half_{n % 2 ? n : n / 2} {
+  if (n % 2)
+    return;
+
+  for (size_t k = 0; k <= n / 2; ++k) {
+    auto a = -two_pi<double> * double(k) / double(n);
+    wr_.push_back(T(std::cos(a)));
+    wi_.push_back(T(std::sin(a)));
+  }
+}
+
+// Even lengths pack x(2j) + i x(2j + 1), the bins k and h - k are split from the half transform Z
+// X(k) = E(k) + w^k O(k), with E(k) = (Z(k) + Z*(h - k)) / 2 and O(k) = (Z(k) - Z*(h - k)) / 2i
+template <typename T> template <typename V>
+void rfft_plan<T>::forward(const V* x, V* re, V* im, V* tr, V* ti) const {
+  using detail::fft_splat;
+
+  auto zero = fft_splat<V>(T(0));
+  if (n_ % 2) {
+    for (size_t j = 0; j < n_; ++j) re[j] = x[j], im[j] = zero;
+    half_.run(re, im, tr, ti);
+    return;
+  }
+
+  auto h = n_ / 2;
+  for (size_t j = 0; j < h; ++j)
+    re[j] = x[2 * j],
+    im[j] = x[2 * j + 1];
+  half_.run(re, im, tr, ti);
+
+  auto half = fft_splat<V>(T(0.5));
+  re[h] = re[0] - im[0], im[h] = zero;
+  re[0] = re[0] + im[0], im[0] = zero;
+  for (size_t k = 1; k <= h / 2; ++k) {
+    auto m = h - k;
+    auto er = (re[k] + re[m]) * half, ei = (im[k] - im[m]) * half;
+    auto or_ = (im[k] + im[m]) * half, oi = (re[m] - re[k]) * half;
+
+    // E(m) = E*(k) and O(m) = O*(k)
+    auto xkr = or_, xki = oi;
+    detail::fft_mul(xkr, xki, fft_splat<V>(wr_[k]), fft_splat<V>(wi_[k]));
+    auto xmr = or_, xmi = zero - oi;
+    detail::fft_mul(xmr, xmi, fft_splat<V>(wr_[m]), fft_splat<V>(wi_[m]));
+
+    re[k] = er + xkr, im[k] = ei + xki;
+    re[m] = er + xmr, im[m] = xmi - ei;
+  }
+}
+
+template <typename T> template <typename V>
+void rfft_plan<T>::inverse(V* re, V* im, V* x, V* tr, V* ti) const {
+  using detail::fft_splat;
+
+  // Imaginary parts of the real bins are ignored
+  auto zero = fft_splat<V>(T(0));
+  im[0] = zero;
+  if (n_ % 2 == 0)
+    im[n_ / 2] = zero;
+
+  if (n_ % 2) {
+    for (size_t k = bins(); k < n_; ++k)
+      re[k] = re[n_ - k],
+      im[k] = zero - im[n_ - k];
+    half_.run(re, im, tr, ti, true);
+    for (size_t j = 0; j < n_; ++j) x[j] = re[j];
+    return;
+  }
+
+  // Z(k) = E(k) + i O(k), scaled by 2 so that the result is n times the signal
+  auto h = n_ / 2;
+  auto e0 = re[0] + re[h], o0 = re[0] - re[h];
+  re[0] = e0, im[0] = o0;
+  for (size_t k = 1; k <= h / 2; ++k) {
+    auto m = h - k;
+    auto er = re[k] + re[m], ei = im[k] - im[m];
+    auto okr = re[k] - re[m], oki = im[k] + im[m];
+    auto omr = zero - okr, omi = oki;
+    detail::fft_mul(okr, oki, fft_splat<V>(wr_[k]), fft_splat<V>(-wi_[k]));
+    detail::fft_mul(omr, omi, fft_splat<V>(wr_[m]), fft_splat<V>(-wi_[m]));
+
+    re[k] = er - oki, im[k] = ei + okr;
+    re[m] = er - omi, im[m] = omr - ei;
+  }
+  half_.run(re, im, tr, ti, true);
+
+  for (size_t j = 0; j < h; ++j)
+    x[2 * j] = re[j],
+    x[2 * j + 1] = im[j];
+}
+
+namespace detail {
+
+template <typename S> struct fft_real                  { using type = S; };
+template <typename S> struct fft_real<std::complex<S>> { using type = S; };
+template <typename S> using fft_real_t = typename fft_real<S>::type;
+
+// Lanes of the butterflies, lines of float are transformed a packet at a time
+template <typename T> struct fft_lanes { using type = T; };
+#if defined(IG_SSE)
+template <> struct fft_lanes<float> { using type = packet; };
+#endif
+
+// Lines along an axis, enumerated over the other dimensions with the first as the fastest
+struct fft_lines {
+  template <typename View>
+  fft_lines(const View& v, size_t axis)
+    : len{v.shape()[axis]}
+    , stride{v.strides()[axis]}
+    , count{1} {
+    assert(axis < v.dims() && "Invalid fft axis");
+    for (size_t k = 0; k < v.dims(); ++k)
+      if (k != axis)
+        shape.push_back(v.shape()[k]),
+        strides.push_back(v.strides()[k]),
+        count *= v.shape()[k];
+  }
+
+  auto offset(size_t id) const {
+    std::ptrdiff_t off = 0;
+    for (size_t k = 0; k < shape.size(); ++k)
+      off += std::ptrdiff_t(id % shape[k]) * strides[k],
+      id /= shape[k];
+    return off;
+  }
+
+  size_t len;
+  std::ptrdiff_t stride;
+  size_t count;
+  nd::shape_array shape;
+  nd::stride_array strides;
+};
+
+// Lanes of the lines [first, first + lanes) are read in elements j * L + l, up to n elements padded with zeros
+// lanes are interleaved in the inner loop, lines along an outer axis are adjacent in memory
+template <size_t L, typename S, typename T>
+void fft_gather(const S* src, const fft_lines& ln, size_t first, size_t lanes, size_t n, T* re, T* im) {
+  std::ptrdiff_t off[L];
+  for (size_t l = 0; l < lanes; ++l) off[l] = ln.offset(first + l);
+
+  auto count = std::min(ln.len, n);
+  for (size_t j = 0; j < count; ++j) {
+    auto p = src + std::ptrdiff_t(j) * ln.stride;
+    for (size_t l = 0; l < L; ++l) {
+      auto v = l < lanes ? p[off[l]] : S{};
+      re[j * L + l] = T(std::real(v));
+      if (im) im[j * L + l] = T(std::imag(v));
+    }
+  }
+
+  std::fill(re + count * L, re + n * L, T(0));
+  if (im)
+    std::fill(im + count * L, im + n * L, T(0));
+}
+
+template <size_t L, typename D, typename T>
+void fft_scatter(D* dst, const fft_lines& ln, size_t first, size_t lanes, const T* re, const T* im, T scale) {
+  std::ptrdiff_t off[L];
+  for (size_t l = 0; l < lanes; ++l) off[l] = ln.offset(first + l);
+
+  for (size_t j = 0; j < ln.len; ++j) {
+    auto p = dst + std::ptrdiff_t(j) * ln.stride;
+    for (size_t l = 0; l < lanes; ++l) {
+      if constexpr (std::is_same_v<D, T>) p[off[l]] = re[j * L + l] * scale;
+      else p[off[l]] = D{re[j * L + l] * scale, im[j * L + l] * scale};
+    }
+  }
+}
+
+// Batches of lines are spread across the job pool, fn(batch, first line, lanes) runs with per range buffers
+template <typename V, typename T, typename Fn>
+void fft_batches(size_t count, size_t cost, size_t buffer, Fn&& fn) {
+  constexpr size_t L = sizeof(V) / sizeof(T);
+  auto batches = (count + L - 1) / L;
+  parallel_for(0, batches, std::max<size_t>(1, nd::parallel_grain / std::max<size_t>(1, cost * L)), [&](size_t first, size_t last) {
+    std::vector<V> buf(buffer);
+    for (auto b = first; b < last; ++b)
+      fn(buf.data(), b * L, std::min(L, count - b * L));
+  });
+}
+
+// Lines are transformed a packet of lanes at a time when there are enough of them
+template <typename T, typename Fn>
+void fft_dispatch(size_t count, Fn&& fn) {
+  using V = typename fft_lanes<T>::type;
+  if (count >= sizeof(V) / sizeof(T)) fn(V{});
+  else                                fn(T{});
+}
+
+template <typename T, typename Src, typename Dst>
+void fft_axis(const fft_plan<T>& plan, const Src& src, Dst& dst, size_t axis, bool inverse, T scale) {
+  fft_lines in{src, axis}, out{dst, axis};
+  auto n = plan.size(), w = plan.work();
+
+  fft_dispatch<T>(in.count, [&](auto lane) {
+    using V = decltype(lane);
+    constexpr size_t L = sizeof(V) / sizeof(T);
+    fft_batches<V, T>(in.count, n, 2 * (n + w), [&](V* buf, size_t first, size_t lanes) {
+      auto re = buf, im = re + n, tr = im + n, ti = tr + w;
+      fft_gather<L>(src.buffer(), in, first, lanes, n, reinterpret_cast<T*>(re), reinterpret_cast<T*>(im));
+      plan.run(re, im, tr, ti, inverse);
+      fft_scatter<L>(dst.buffer(), out, first, lanes, reinterpret_cast<const T*>(re), reinterpret_cast<const T*>(im), scale);
+    });
+  });
+}
+
+template <typename T, typename Src, typename Dst>
+void rfft_axis(const rfft_plan<T>& plan, const Src& src, Dst& dst, size_t axis) {
+  fft_lines in{src, axis}, out{dst, axis};
+  auto n = plan.size(), s = plan.span(), w = plan.work();
+
+  fft_dispatch<T>(in.count, [&](auto lane) {
+    using V = decltype(lane);
+    constexpr size_t L = sizeof(V) / sizeof(T);
+    fft_batches<V, T>(in.count, n, n + 2 * (s + w), [&](V* buf, size_t first, size_t lanes) {
+      auto x = buf, re = x + n, im = re + s, tr = im + s, ti = tr + w;
+      fft_gather<L>(src.buffer(), in, first, lanes, n, reinterpret_cast<T*>(x), static_cast<T*>(nullptr));
+      plan.forward(x, re, im, tr, ti);
+      fft_scatter<L>(dst.buffer(), out, first, lanes, reinterpret_cast<const T*>(re), reinterpret_cast<const T*>(im), T(1));
+    });
+  });
+}
+
+template <typename T, typename Src, typename Dst>
+void irfft_axis(const rfft_plan<T>& plan, const Src& src, Dst& dst, size_t axis) {
+  fft_lines in{src, axis}, out{dst, axis};
+  auto n = plan.size(), s = plan.span(), w = plan.work();
+
+  fft_dispatch<T>(in.count, [&](auto lane) {
+    using V = decltype(lane);
+    constexpr size_t L = sizeof(V) / sizeof(T);
+    fft_batches<V, T>(in.count, n, n + 2 * (s + w), [&](V* buf, size_t first, size_t lanes) {
+      auto x = buf, re = x + n, im = re + s, tr = im + s, ti = tr + w;
+      fft_gather<L>(src.buffer(), in, first, lanes, plan.bins(), reinterpret_cast<T*>(re), reinterpret_cast<T*>(im));
+      plan.inverse(re, im, x, tr, ti);
+      fft_scatter<L>(dst.buffer(), out, first, lanes, reinterpret_cast<const T*>(x), static_cast<const T*>(nullptr), T(1) / T(n));
+    });
+  });
+}
+
+template <typename Arr>
+auto fft_shape(const ndarray_base<Arr>& arr, size_t axis, size_t n) {
+  assert(axis < arr.dims() && "Invalid fft axis");
+  nd::shape_array shape{arr.shape().begin(), arr.shape().end()};
+  shape[axis] = n;
+  return shape;
+}
+
+} // namespace detail
+
+// Transforms along one axis, the lines are cropped or padded with zeros to the plan length
+template <typename T, typename Arr>
+auto fft(const fft_plan<T>& plan, const ndarray_base<Arr>& arr, size_t axis = 0) {
+  ndarray< std::complex<T> > res{detail::fft_shape(arr, axis, plan.size())};
+  nd::detail::with_layout(arr, [&](const auto& v) {
+    auto out = nd::as_view(res);
+    detail::fft_axis(plan, v, out, axis, false, T(1));
+    return 0;
+  });
+  return res;
+}
+
+template <typename T, typename Arr>
+auto ifft(const fft_plan<T>& plan, const ndarray_base<Arr>& arr, size_t axis = 0) {
+  ndarray< std::complex<T> > res{detail::fft_shape(arr, axis, plan.size())};
+  nd::detail::with_layout(arr, [&](const auto& v) {
+    auto out = nd::as_view(res);
+    detail::fft_axis(plan, v, out, axis, true, T(1) / T(plan.size()));
+    return 0;
+  });
+  return res;
+}
+
+template <typename Arr>
+auto fft(const ndarray_base<Arr>& arr, size_t axis = 0, size_t n = 0) {
+  using T = detail::fft_real_t< ndarray_t<Arr> >;
+  return fft(fft_plan<T>{n ? n : arr.shape()[axis]}, arr, axis);
+}
+
+template <typename Arr>
+auto ifft(const ndarray_base<Arr>& arr, size_t axis = 0, size_t n = 0) {
+  using T = detail::fft_real_t< ndarray_t<Arr> >;
+  return ifft(fft_plan<T>{n ? n : arr.shape()[axis]}, arr, axis);
+}
+
+// Real input, n / 2 + 1 bins along the axis
+template <typename T, typename Arr>
+auto rfft(const rfft_plan<T>& plan, const ndarray_base<Arr>& arr, size_t axis = 0) {
+  static_assert(std::is_floating_point_v< ndarray_t<Arr> >, "Invalid rfft, input must be real");
+
+  ndarray< std::complex<T> > res{detail::fft_shape(arr, axis, plan.bins())};
+  nd::detail::with_layout(arr, [&](const auto& v) {
+    auto out = nd::as_view(res);
+    detail::rfft_axis(plan, v, out, axis);
+    return 0;
+  });
+  return res;
+}
+
+// Real output of n elements along the axis from its first n / 2 + 1 bins
+template <typename T, typename Arr>
+auto irfft(const rfft_plan<T>& plan, const ndarray_base<Arr>& arr, size_t axis = 0) {
+  ndarray<T> res{detail::fft_shape(arr, axis, plan.size())};
+  nd::detail::with_layout(arr, [&](const auto& v) {
+    auto out = nd::as_view(res);
+    detail::irfft_axis(plan, v, out, axis);
+    return 0;
+  });
+  return res;
+}
+
+template <typename Arr>
+auto rfft(const ndarray_base<Arr>& arr, size_t axis = 0, size_t n = 0) {
+  using T = ndarray_t<Arr>;
+  return rfft(rfft_plan<T>{n ? n : arr.shape()[axis]}, arr, axis);
+}
+
+// The default output length is 2 * (bins - 1)
+template <typename Arr>
+auto irfft(const ndarray_base<Arr>& arr, size_t axis = 0, size_t n = 0) {
+  using T = detail::fft_real_t< ndarray_t<Arr> >;
+  return irfft(rfft_plan<T>{n ? n : 2 * (arr.shape()[axis] - 1)}, arr, axis);
+}
+
+// Transforms over every axis, in place after the first one
+template <typename Arr>
+auto fftn(const ndarray_base<Arr>& arr) {
+  using T = detail::fft_real_t< ndarray_t<Arr> >;
+  auto res = fft(arr, 0);
+  for (size_t k = 1; k < res.dims(); ++k) {
+    auto v = nd::as_view(res);
+    detail::fft_axis(fft_plan<T>{res.shape()[k]}, v, v, k, false, T(1));
+  } return res;
+}
+
+template <typename Arr>
+auto ifftn(const ndarray_base<Arr>& arr) {
+  using T = detail::fft_real_t< ndarray_t<Arr> >;
+  auto res = ifft(arr, 0);
+  for (size_t k = 1; k < res.dims(); ++k) {
+    auto v = nd::as_view(res);
+    detail::fft_axis(fft_plan<T>{res.shape()[k]}, v, v, k, true, T(1) / T(res.shape()[k]));
+  } return res;
+}
+
+} // namespace ig
+
+#endif // IG_MATH_FFT_H
@@ -0,0 +1,265 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_ANYNDARRAY_H
+#define IG_MATH_ANYNDARRAY_H
+
+#include "imagine/math/theory/ndarray.h"
+
+#include <limits>
+#include <memory>
+
+namespace ig {
+
+// Element types known at runtime
+enum class dtype : uint8_t { u8, i8, u16, i16, u32, i32, u64, i64, f16, bf16, f32, f64 };
+
+template <typename T> struct dtype_tag { using type = T; };
+
+template <typename T>
+constexpr auto dtype_of() {
+  using U = std::remove_cv_t<T>;
+  if constexpr      (std::is_same_v<U, uint8_t>)  return dtype::u8;
+  else if constexpr (std::is_same_v<U, int8_t>)   return dtype::i8;
+  else if constexpr (std::is_same_v<U, uint16_t>) return dtype::u16;
+  else if constexpr (std::is_same_v<U, int16_t>)  return dtype::i16;
+  else if constexpr (std::is_same_v<U, uint32_t>) return dtype::u32;
+  else if constexpr (std::is_same_v<U, int32_t>)  return dtype::i32;
+  else if constexpr (std::is_same_v<U, uint64_t>) return dtype::u64;
+  else if constexpr (std::is_same_v<U, int64_t>)  return dtype::i64;
+  else if constexpr (std::is_same_v<U, float16>)  return dtype::f16;
+  else if constexpr (std::is_same_v<U, bfloat16>) return dtype::bf16;
+  else if constexpr (std::is_same_v<U, float>)    return dtype::f32;
+  else if constexpr (std::is_same_v<U, double>)   return dtype::f64;
+  else static_assert(!sizeof(U), "Unsupported ndarray element type");
+}
+
+// fn(dtype_tag<T>{}) with the element type T of type
+template <typename Fn>
+decltype(auto) dtype_visit(dtype type, Fn&& fn) {
+  switch (type) {
+  case dtype::u8:   return fn(dtype_tag<uint8_t>{});
+  case dtype::i8:   return fn(dtype_tag<int8_t>{});
+  case dtype::u16:  return fn(dtype_tag<uint16_t>{});
+  case dtype::i16:  return fn(dtype_tag<int16_t>{});
+  case dtype::u32:  return fn(dtype_tag<uint32_t>{});
+  case dtype::i32:  return fn(dtype_tag<int32_t>{});
+  case dtype::u64:  return fn(dtype_tag<uint64_t>{});
+  case dtype::i64:  return fn(dtype_tag<int64_t>{});
+  case dtype::f16:  return fn(dtype_tag<float16>{});
+  case dtype::bf16: return fn(dtype_tag<bfloat16>{});
+  case dtype::f32:  return fn(dtype_tag<float>{});
+  case dtype::f64:  return fn(dtype_tag<double>{});
+  } throw std::invalid_argument{"[Ndarray] Invalid element type"};
+}
+
+inline auto dtype_size(dtype type) { return dtype_visit(type, [](auto tag) { return sizeof(typename decltype(tag)::type); }); }
+
+namespace nd {
+
+// Scalar conversion, floating values are truncated and saturated to integers (nan gives zero), integers wrap like static_cast
+template <typename D, typename S>
+D element_cast(S v) {
+  if constexpr (is_half_v<S>) {
+    return element_cast<D>(float(v));
+  } else if constexpr (is_half_v<D>) {
+    return D(float(v));
+  } else if constexpr (std::is_floating_point_v<S> && std::is_integral_v<D>) {
+    if (v != v) return D(0);
+    if (v <= S(std::numeric_limits<D>::lowest())) return std::numeric_limits<D>::lowest();
+    if (v >= S(std::numeric_limits<D>::max()))    return std::numeric_limits<D>::max();
+    return D(v);
+  } else {
+    return static_cast<D>(v);
+  }
+}
+
+namespace detail {
+
+#if defined(IG_SSE)
+// Packet kernels of the common conversions, n elements are converted from the start and the count done is returned
+template <typename S>
+size_t convert_packets(const S* src, float* dst, size_t n) {
+  size_t j = 0;
+  if constexpr (std::is_same_v<S, uint8_t> || std::is_same_v<S, int8_t>) {
+    for (; j + 16 <= n; j += 16) {
+      auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j));
+      __m128i h[2], w[4];
+      if constexpr (std::is_signed_v<S>)
+        h[0] = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8), h[1] = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+      else
+        h[0] = _mm_unpacklo_epi8(v, _mm_setzero_si128()), h[1] = _mm_unpackhi_epi8(v, _mm_setzero_si128());
+      for (size_t k = 0; k < 2; ++k)
+        w[2 * k]     = _mm_srai_epi32(_mm_unpacklo_epi16(h[k], h[k]), 16),
+        w[2 * k + 1] = _mm_srai_epi32(_mm_unpackhi_epi16(h[k], h[k]), 16);
+      for (size_t k = 0; k < 4; ++k) _mm_storeu_ps(dst + j + 4 * k, _mm_cvtepi32_ps(w[k]));
+    }
+  } else if constexpr (std::is_same_v<S, uint16_t> || std::is_same_v<S, int16_t>) {
+    for (; j + 8 <= n; j += 8) {
+      auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j));
+      __m128i lo, hi;
+      if constexpr (std::is_signed_v<S>)
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+      else
+        lo = _mm_unpacklo_epi16(v, _mm_setzero_si128()), hi = _mm_unpackhi_epi16(v, _mm_setzero_si128());
+      _mm_storeu_ps(dst + j,     _mm_cvtepi32_ps(lo));
+      _mm_storeu_ps(dst + j + 4, _mm_cvtepi32_ps(hi));
+    }
+  } else if constexpr (std::is_same_v<S, int32_t>) {
+    for (; j + 4 <= n; j += 4)
+      _mm_storeu_ps(dst + j, _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j))));
+  } else if constexpr (std::is_same_v<S, double>) {
+    for (; j + 4 <= n; j += 4)
+      _mm_storeu_ps(dst + j, _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(src + j)), _mm_cvtpd_ps(_mm_loadu_pd(src + j + 2))));
+  } return j;
+}
+
+// Float to integer, clamped to the range of D and truncated like element_cast
+template <typename D>
+size_t convert_packets(const float* src, D* dst, size_t n) {
+  size_t j = 0;
+  auto number = [](__m128 v) { return _mm_and_ps(v, _mm_cmpord_ps(v, v)); };
+  auto clamp = [number](__m128 v, float lo, float hi) { return _mm_min_ps(_mm_max_ps(number(v), _mm_set1_ps(lo)), _mm_set1_ps(hi)); };
+  if constexpr (std::is_same_v<D, uint8_t>) {
+    for (; j + 16 <= n; j += 16) {
+      __m128i w[4];
+      for (size_t k = 0; k < 4; ++k) w[k] = _mm_cvttps_epi32(clamp(_mm_loadu_ps(src + j + 4 * k), 0.f, 255.f));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j), _mm_packus_epi16(_mm_packs_epi32(w[0], w[1]), _mm_packs_epi32(w[2], w[3])));
+    }
+  } else if constexpr (std::is_same_v<D, int16_t>) {
+    for (; j + 8 <= n; j += 8) {
+      auto lo = _mm_cvttps_epi32(clamp(_mm_loadu_ps(src + j),     -32768.f, 32767.f)),
+           hi = _mm_cvttps_epi32(clamp(_mm_loadu_ps(src + j + 4), -32768.f, 32767.f));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j), _mm_packs_epi32(lo, hi));
+    }
+  } else if constexpr (std::is_same_v<D, uint16_t>) {
+    // Biased to the signed range, packed with signed saturation and unbiased
+    auto bias = _mm_set1_epi32(32768);
+    for (; j + 8 <= n; j += 8) {
+      auto lo = _mm_sub_epi32(_mm_cvttps_epi32(clamp(_mm_loadu_ps(src + j),     0.f, 65535.f)), bias),
+           hi = _mm_sub_epi32(_mm_cvttps_epi32(clamp(_mm_loadu_ps(src + j + 4), 0.f, 65535.f)), bias);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j), _mm_xor_si128(_mm_packs_epi32(lo, hi), _mm_set1_epi16(-32768)));
+    }
+  } else if constexpr (std::is_same_v<D, int32_t>) {
+    // Values from 2^31 overflow to the lowest integer, they are replaced by the largest
+    for (; j + 4 <= n; j += 4) {
+      auto v = _mm_max_ps(number(_mm_loadu_ps(src + j)), _mm_set1_ps(-2147483648.f));
+      auto over = _mm_castps_si128(_mm_cmpge_ps(v, _mm_set1_ps(2147483648.f)));
+      auto w = _mm_cvttps_epi32(v);
+      w = _mm_or_si128(_mm_andnot_si128(over, w), _mm_and_si128(over, _mm_set1_epi32(std::numeric_limits<int32_t>::max())));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j), w);
+    }
+  } else if constexpr (std::is_same_v<D, double>) {
+    for (; j + 4 <= n; j += 4) {
+      auto v = _mm_loadu_ps(src + j);
+      _mm_storeu_pd(dst + j,     _mm_cvtps_pd(v));
+      _mm_storeu_pd(dst + j + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+  } return j;
+}
+#endif
+
+} // namespace detail
+
+// Converts n elements of a line, packet kernels cover the conversions from and to float
+template <typename S, typename D>
+void astype(const S* src, D* dst, size_t n) {
+  size_t j = 0;
+  if constexpr (std::is_same_v<S, D>) {
+    std::copy(src, src + n, dst);
+    return;
+  } else if constexpr (is_half_v<S> && std::is_same_v<D, float>) {
+    return convert(src, dst, n);
+  } else if constexpr (std::is_same_v<S, float> && is_half_v<D>) {
+    return convert(src, dst, n);
+#if defined(IG_SSE)
+  } else if constexpr (std::is_same_v<D, float> || std::is_same_v<S, float>) {
+    j = detail::convert_packets(src, dst, n);
+#endif
+  }
+  for (; j < n; ++j) dst[j] = element_cast<D>(src[j]);
+}
+
+} // namespace nd
+
+// Runtime typed ndarray, the elements of a dtype live in a dense buffer shared between copies
+// typed arrays are views of the same elements, conversions only happen through astype
+class any_ndarray {
+public:
+  any_ndarray() = default;
+
+  // Zero initialized elements
+  explicit any_ndarray(dtype type, const nd::shape_array& shape)
+    : any_ndarray{dtype_visit(type, [&shape](auto tag) { return any_ndarray{ndarray<typename decltype(tag)::type>{shape}}; })} {}
+
+  // Elements living outside (e.g. a decoder buffer or a file mapping), kept alive by owner
+  explicit any_ndarray(dtype type, const nd::shape_array& shape, void* data, std::shared_ptr<void> owner)
+    : type_{type}
+    , shape_{shape}
+    , data_{data}
+    , owner_{std::move(owner)} {}
+
+  // Takes the elements of arr without copy
+  template <typename T, size_t... D>
+  any_ndarray(ndarray<T, D...>&& arr) {
+    auto held = std::make_shared< ndarray<T, D...> >(std::move(arr));
+    type_  = dtype_of<T>();
+    shape_ = nd::shape_array{held->shape().begin(), held->shape().end()};
+    data_  = held->buffer();
+    owner_ = std::move(held);
+  }
+
+  auto type() const   { return type_; }
+  auto item() const   { return dtype_size(type_); }
+  auto dims() const   { return shape_.size(); }
+  auto& shape() const { return shape_; }
+  auto size() const   { return std::accumulate(shape_.begin(), shape_.end(), size_t(1), std::multiplies<>{}); }
+  auto bytes() const  { return size() * item(); }
+  auto empty() const  { return data_ == nullptr; }
+
+  auto data() const -> const void* { return data_; }
+  auto data()       -> void*       { return data_; }
+  auto& owner() const { return owner_; }
+
+  template <typename T> auto is() const { return type_ == dtype_of<T>(); }
+
+  // Typed array over the shared elements, T must be their type
+  template <typename T>
+  auto as() const {
+    if (!is<T>())
+      throw std::invalid_argument{"[Ndarray] Invalid typed view, element types differ"};
+    return ndarray<T>{nd::dynamic_storage<T>{shape_, static_cast<T*>(data_), owner_}};
+  }
+
+  // Converted copy, or a view when T is already the element type
+  template <typename T>
+  auto astype() const {
+    if (is<T>())
+      return as<T>();
+
+    ndarray<T> arr{shape_};
+    dtype_visit(type_, [&](auto tag) {
+      using S = typename decltype(tag)::type;
+      auto src = static_cast<const S*>(data_);
+      parallel_for(0, size(), nd::parallel_grain, [&](size_t first, size_t last) { nd::astype(src + first, arr.buffer() + first, last - first); });
+    }); return arr;
+  }
+
+  auto astype(dtype type) const {
+    return dtype_visit(type, [this](auto tag) { return any_ndarray{astype<typename decltype(tag)::type>()}; });
+  }
+
+private:
+  dtype type_ = dtype::u8;
+  nd::shape_array shape_;
+
+  void* data_ = nullptr;
+  std::shared_ptr<void> owner_;
+};
+
+} // namespace ig
+
+#endif // IG_MATH_ANYNDARRAY_H
@@ -0,0 +1,70 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_ACCUMULATE_H
+#define IG_MATH_ACCUMULATE_H
+
+#include "imagine/math/theory/simd_accel/intrinsics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ig {
+
+// Accuracy of sums
+// pairwise: blocks summed in order and combined as a balanced tree, the error grows as log n
+// compensated: the rounding error of every addition is carried along, the error does not grow with n
+enum class summation { pairwise, compensated };
+
+// Accumulator carrying the exact rounding error of its additions (Knuth two-sum, as accurate as Neumaier without branches)
+template <typename T>
+struct compensated {
+  constexpr compensated(T v = T(0)) : s{v}, c{T(0)} {}
+
+  constexpr auto& operator+=(T x) {
+    auto t = s + x, z = t - s;
+    c += (s - (t - z)) + (x - z);
+    s = t;
+    return *this;
+  }
+
+  constexpr auto& operator+=(const compensated& o) { *this += o.s; c += o.c; return *this; }
+  constexpr operator T() const { return s + c; }
+
+  T s, c;
+};
+
+template <typename T> constexpr auto operator+(compensated<T> lhs, const compensated<T>& rhs) { return lhs += rhs; }
+
+#if defined(IG_SSE)
+// Lanes of packet accumulators with their errors
+struct compensated_packet {
+  packet s = packet{0.f}, c = packet{0.f};
+
+  void add(const packet& x) {
+    auto t = s + x, z = t - s;
+    c = c + ((s - (t - z)) + (x - z));
+    s = t;
+  }
+};
+#endif
+
+// Pairwise reduction of [first, last) into init, leaf(first, last, acc) accumulates runs of at most Block elements in order
+template <size_t Block, typename T, typename Leaf, typename Op>
+T pairwise_reduce(size_t first, size_t last, T init, const T& identity, Leaf&& leaf, Op&& op) {
+  if (last - first <= Block)
+    return leaf(first, last, init);
+
+  // Halves are split on block boundaries
+  auto mid = first + std::max<size_t>(1, (last - first) / 2 / Block) * Block;
+  return op(
+    pairwise_reduce<Block>(first, mid, init,     identity, leaf, op),
+    pairwise_reduce<Block>(mid,   last, identity, identity, leaf, op));
+}
+
+} // namespace ig
+
+#endif // IG_MATH_ACCUMULATE_H
@@ -0,0 +1,305 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_GEMM_H
+#define IG_MATH_GEMM_H
+
+#include "imagine/math/theory/detail/ndarray/eval.h"
+#include "imagine/core/net/distribute.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace ig {
+
+// Operand of a general product, element (i, j) is at data[i * rs + j * cs]
+template <typename T>
+struct gemm_operand {
+  T* data;
+  std::ptrdiff_t rs, cs;
+
+  decltype(auto) operator()(size_t i, size_t j) const { return data[std::ptrdiff_t(i) * rs + std::ptrdiff_t(j) * cs]; }
+};
+
+namespace detail {
+
+// Register tile of the micro kernel and cache blocks of the packed panels
+template <typename T>
+struct gemm_blocking {
+  static constexpr size_t mr = 4, nr = 4;
+  static constexpr size_t mc = 64, kc = 256, nc = 2048;
+};
+
+#if defined(IG_SSE)
+template <>
+struct gemm_blocking<float> {
+  static constexpr size_t mr = 6, nr = 2 * IG_PACKET_WIDE;
+  static constexpr size_t mc = 96, kc = 256, nc = 4096;
+};
+#endif
+
+// mr x kc panel of a, mr elements per step with zeros past the rows
+template <typename T>
+void gemm_pack_a(const gemm_operand<const T>& a, size_t i0, size_t m, size_t p0, size_t k, T* dst) {
+  constexpr auto mr = gemm_blocking<T>::mr;
+  for (size_t ir = 0; ir < m; ir += mr) {
+    auto rows = std::min(mr, m - ir);
+    for (size_t p = 0; p < k; ++p, dst += mr) {
+      size_t i = 0;
+      for (; i < rows; ++i) dst[i] = a(i0 + ir + i, p0 + p);
+      for (; i < mr; ++i)   dst[i] = T(0);
+    }
+  }
+}
+
+// kc x nr panel of b, nr elements per step with zeros past the columns
+template <typename T>
+void gemm_pack_b(const gemm_operand<const T>& b, size_t p0, size_t k, size_t j0, size_t n, T* dst) {
+  constexpr auto nr = gemm_blocking<T>::nr;
+  for (size_t jr = 0; jr < n; jr += nr) {
+    auto cols = std::min(nr, n - jr);
+    for (size_t p = 0; p < k; ++p, dst += nr) {
+      size_t j = 0;
+      if (b.cs == 1)
+        for (; j < cols; ++j) dst[j] = b.data[std::ptrdiff_t(p0 + p) * b.rs + std::ptrdiff_t(j0 + jr + j)];
+      else
+        for (; j < cols; ++j) dst[j] = b(p0 + p, j0 + jr + j);
+      for (; j < nr; ++j) dst[j] = T(0);
+    }
+  }
+}
+
+// c(m x n) += alpha * a b over packed panels, m <= mr and n <= nr
+template <typename T>
+void gemm_micro(size_t k, T alpha, const T* a, const T* b, const gemm_operand<T>& c, size_t m, size_t n) {
+  constexpr auto mr = gemm_blocking<T>::mr, nr = gemm_blocking<T>::nr;
+  T acc[mr][nr] = {};
+
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<T, float>) {
+    constexpr size_t w = IG_PACKET_WIDE;
+    packet r[mr][2];
+    for (size_t i = 0; i < mr; ++i) r[i][0] = r[i][1] = packet{0.f};
+
+    for (size_t p = 0; p < k; ++p, a += mr, b += nr) {
+      auto b0 = nd::load(b), b1 = nd::load(b + w);
+      for (size_t i = 0; i < mr; ++i) {
+        auto ai = packet{a[i]};
+        r[i][0] = r[i][0] + ai * b0;
+        r[i][1] = r[i][1] + ai * b1;
+      }
+    }
+
+    for (size_t i = 0; i < mr; ++i)
+      nd::store(acc[i], r[i][0]),
+      nd::store(acc[i] + w, r[i][1]);
+  } else
+#endif
+  {
+    for (size_t p = 0; p < k; ++p, a += mr, b += nr)
+      for (size_t i = 0; i < mr; ++i)
+        for (size_t j = 0; j < nr; ++j) acc[i][j] += a[i] * b[j];
+  }
+
+  for (size_t i = 0; i < m; ++i)
+    for (size_t j = 0; j < n; ++j) c(i, j) += alpha * acc[i][j];
+}
+
+// Macro kernel over a packed mc x kc block of a and kc x nc panel of b
+template <typename T>
+void gemm_macro(size_t m, size_t n, size_t k, T alpha, const T* pa, const T* pb, const gemm_operand<T>& c) {
+  constexpr auto mr = gemm_blocking<T>::mr, nr = gemm_blocking<T>::nr;
+  for (size_t jr = 0; jr < n; jr += nr)
+    for (size_t ir = 0; ir < m; ir += mr) {
+      auto tile = gemm_operand<T>{c.data + std::ptrdiff_t(ir) * c.rs + std::ptrdiff_t(jr) * c.cs, c.rs, c.cs};
+      gemm_micro(k, alpha, pa + ir * k, pb + jr * k, tile, std::min(mr, m - ir), std::min(nr, n - jr));
+    }
+}
+
+} // namespace detail
+
+// c(m x n) = alpha * a(m x k) b(k x n) + beta * c, operands of any strides so that transposed or permuted views are not copied
+// panels of b are packed once per block and shared, blocks of rows of a are spread across the job pool
+template <typename T>
+void gemm(size_t m, size_t n, size_t k, T alpha, const gemm_operand<const T>& a, const gemm_operand<const T>& b, T beta, const gemm_operand<T>& c) {
+  using blocking = detail::gemm_blocking<T>;
+  constexpr auto mc = blocking::mc, kc = blocking::kc, nc = blocking::nc;
+
+  if (beta != T(1))
+    for (size_t i = 0; i < m; ++i)
+      for (size_t j = 0; j < n; ++j) c(i, j) = beta == T(0) ? T(0) : beta * c(i, j);
+  if (m == 0 || n == 0 || k == 0 || alpha == T(0))
+    return;
+
+  // Tasks split the rows, then the columns of a panel when there are too few row blocks
+  auto threads = in_parallel() ? size_t(1) : pool().size() + 1;
+  auto blocks = (m + mc - 1) / mc;
+  std::vector<T> pb(std::min(kc, k) * std::min(nc, n + blocking::nr));
+
+  for (size_t jc = 0; jc < n; jc += nc) {
+    auto nb = std::min(nc, n - jc);
+    auto parts = std::min((threads + blocks - 1) / blocks, (nb + blocking::nr - 1) / blocking::nr);
+    auto span = ((nb + parts - 1) / parts + blocking::nr - 1) / blocking::nr * blocking::nr;
+    for (size_t pc = 0; pc < k; pc += kc) {
+      auto kb = std::min(kc, k - pc);
+      detail::gemm_pack_b(b, pc, kb, jc, nb, pb.data());
+
+      auto work = m * nb * kb;
+      parallel_for(0, blocks * parts, std::max<size_t>(1, nd::parallel_grain * 8 / std::max<size_t>(1, work / (blocks * parts))), [&](size_t first, size_t last) {
+        std::vector<T> pa(mc * kb);
+        for (auto t = first; t < last; ++t) {
+          auto ic = (t / parts) * mc, j0 = (t % parts) * span;
+          if (j0 >= nb) continue;
+
+          auto mb = std::min(mc, m - ic);
+          detail::gemm_pack_a(a, ic, mb, pc, kb, pa.data());
+          auto tile = gemm_operand<T>{c.data + std::ptrdiff_t(ic) * c.rs + std::ptrdiff_t(jc + j0) * c.cs, c.rs, c.cs};
+          detail::gemm_macro(mb, std::min(span, nb - j0), kb, alpha, pa.data(), pb.data() + j0 * kb, tile);
+        }
+      });
+    }
+  }
+}
+
+// Rescaling of the 32-bit sums of an int8 product, c(i, j) = acc(i, j) * a[i * as] * b[j * bs] + bias(i, j)
+// int8 outputs are requantized at scale out, rounded to nearest and saturated to [-127, 127]
+struct qgemm_scales {
+  const float* a; std::ptrdiff_t as;
+  const float* b; std::ptrdiff_t bs;
+  gemm_operand<const float> bias = {nullptr, 0, 0};
+  float out = 1.f;
+};
+
+namespace detail {
+
+// Register tile of the int8 micro kernel, k is consumed by groups of four bytes
+struct qgemm_blocking {
+#if defined(IG_AVX) && defined(__AVX2__)
+  static constexpr size_t mr = 4, nr = 16;
+#else
+  static constexpr size_t mr = 4, nr = 4;
+#endif
+  static constexpr size_t mc = 128, nc = 4096;
+};
+
+// mr rows of a per group of k, four bytes each with zeros past the rows and the depth
+inline void qgemm_pack_a(const gemm_operand<const int8_t>& a, size_t i0, size_t m, size_t k, int8_t* dst) {
+  constexpr auto mr = qgemm_blocking::mr;
+  for (size_t ir = 0; ir < m; ir += mr) {
+    auto rows = std::min(mr, m - ir);
+    for (size_t p = 0; p < k; p += 4)
+      for (size_t i = 0; i < mr; ++i)
+        for (size_t q = 0; q < 4; ++q)
+          *dst++ = i < rows && p + q < k ? a(i0 + ir + i, p + q) : int8_t(0);
+  }
+}
+
+// nr columns of b per group of k, the four bytes of a column are adjacent
+inline void qgemm_pack_b(const gemm_operand<const int8_t>& b, size_t j0, size_t n, size_t k, int8_t* dst) {
+  constexpr auto nr = qgemm_blocking::nr;
+  for (size_t jr = 0; jr < n; jr += nr) {
+    auto cols = std::min(nr, n - jr);
+    for (size_t p = 0; p < k; p += 4)
+      for (size_t j = 0; j < nr; ++j)
+        for (size_t q = 0; q < 4; ++q)
+          *dst++ = j < cols && p + q < k ? b(p + q, j0 + jr + j) : int8_t(0);
+  }
+}
+
+// Sums of the whole depth are kept in registers, then rescaled into c(m x n) with m <= mr and n <= nr
+template <typename Out>
+void qgemm_micro(size_t groups, const int8_t* a, const int8_t* b, const qgemm_scales& s, size_t i0, size_t j0, const gemm_operand<Out>& c, size_t m, size_t n) {
+  constexpr auto mr = qgemm_blocking::mr, nr = qgemm_blocking::nr;
+  alignas(32) int32_t acc[mr][nr] = {};
+
+#if defined(IG_AVX) && defined(__AVX2__)
+  int8 r[mr][2];
+  for (size_t i = 0; i < mr; ++i) r[i][0] = r[i][1] = int8{0};
+
+  for (size_t g = 0; g < groups; ++g, a += 4 * mr, b += 4 * nr) {
+    auto b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    auto b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 32));
+    for (size_t i = 0; i < mr; ++i) {
+      int32_t word; std::memcpy(&word, a + 4 * i, 4);
+      auto ai = int8{word};
+      r[i][0] = dot4(r[i][0], ai, b0);
+      r[i][1] = dot4(r[i][1], ai, b1);
+    }
+  }
+
+  for (size_t i = 0; i < mr; ++i)
+    _mm256_store_si256(reinterpret_cast<__m256i*>(acc[i]), r[i][0]),
+    _mm256_store_si256(reinterpret_cast<__m256i*>(acc[i] + 8), r[i][1]);
+#else
+  for (size_t g = 0; g < groups; ++g, a += 4 * mr, b += 4 * nr)
+    for (size_t i = 0; i < mr; ++i)
+      for (size_t j = 0; j < nr; ++j)
+        for (size_t q = 0; q < 4; ++q) acc[i][j] += int32_t(a[4 * i + q]) * int32_t(b[4 * j + q]);
+#endif
+
+  auto inv = 1.f / s.out;
+  for (size_t i = 0; i < m; ++i) {
+    auto sa = s.a[std::ptrdiff_t(i0 + i) * s.as];
+    for (size_t j = 0; j < n; ++j) {
+      auto v = float(acc[i][j]) * sa * s.b[std::ptrdiff_t(j0 + j) * s.bs];
+      if (s.bias.data) v += s.bias(i0 + i, j0 + j);
+      if constexpr (std::is_same_v<Out, int8_t>)
+        c(i, j) = int8_t(std::clamp(std::nearbyint(v * inv), -127.f, 127.f));
+      else
+        c(i, j) = v;
+    }
+  }
+}
+
+} // namespace detail
+
+// c(m x n) = a(m x k) b(k x n) over int8 operands in [-127, 127], sums are exact in 32 bits and rescaled once per element
+// the output is float, or int8 requantized at the output scale; b is packed once and blocks of rows of a are spread across the job pool
+template <typename Out>
+void qgemm(size_t m, size_t n, size_t k, const gemm_operand<const int8_t>& a, const gemm_operand<const int8_t>& b, const qgemm_scales& s, const gemm_operand<Out>& c) {
+  static_assert(std::is_same_v<Out, float> || std::is_same_v<Out, int8_t>, "Invalid int8 product output, expected float or int8_t");
+  using blocking = detail::qgemm_blocking;
+  constexpr auto mr = blocking::mr, nr = blocking::nr, mc = blocking::mc, nc = blocking::nc;
+
+  if (m == 0 || n == 0)
+    return;
+
+  auto depth = (k + 3) / 4 * 4;
+  auto threads = in_parallel() ? size_t(1) : pool().size() + 1;
+  auto blocks = (m + mc - 1) / mc;
+  std::vector<int8_t> pb(depth * std::min(nc, (n + nr - 1) / nr * nr));
+
+  for (size_t jc = 0; jc < n; jc += nc) {
+    auto nb = std::min(nc, n - jc);
+    auto parts = std::min((threads + blocks - 1) / blocks, (nb + nr - 1) / nr);
+    auto span = ((nb + parts - 1) / parts + nr - 1) / nr * nr;
+    detail::qgemm_pack_b(b, jc, nb, k, pb.data());
+
+    auto work = m * nb * std::max<size_t>(k, 1) / 4;
+    parallel_for(0, blocks * parts, std::max<size_t>(1, nd::parallel_grain * 8 / std::max<size_t>(1, work / (blocks * parts))), [&](size_t first, size_t last) {
+      std::vector<int8_t> pa(mc * depth);
+      for (auto t = first; t < last; ++t) {
+        auto ic = (t / parts) * mc, j0 = (t % parts) * span;
+        if (j0 >= nb) continue;
+
+        auto mb = std::min(mc, m - ic), ns = std::min(span, nb - j0);
+        detail::qgemm_pack_a(a, ic, mb, k, pa.data());
+        for (size_t jr = 0; jr < ns; jr += nr)
+          for (size_t ir = 0; ir < mb; ir += mr) {
+            auto i = ic + ir, j = jc + j0 + jr;
+            auto tile = gemm_operand<Out>{c.data + std::ptrdiff_t(i) * c.rs + std::ptrdiff_t(j) * c.cs, c.rs, c.cs};
+            detail::qgemm_micro(depth / 4, pa.data() + ir * depth, pb.data() + (j0 + jr) * depth, s, i, j, tile, std::min(mr, mb - ir), std::min(nr, ns - jr));
+          }
+      }
+    });
+  }
+}
+
+} // namespace ig
+
+#endif // IG_MATH_GEMM_H
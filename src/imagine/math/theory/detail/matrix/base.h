@@ -9,6 +9,10 @@
 
 #include "imagine/math/basis.h"
 #include "imagine/math/theory/detail/relational.h"
+#include "imagine/math/theory/simd_accel/intrinsics.h"
+#include "imagine/math/theory/detail/accumulate.h"
+#include "imagine/math/theory/half.h"
+#include "imagine/core/mt/unroll.h"
 
 #include <vector>
 #include <array>
@@ -60,6 +64,17 @@ template <typename Mat> using concrete_matrix =
     matrix_traits<Mat>::n_rows, matrix_traits<Mat>::n_cols
   >;
 
+// Static shapes up to 8 x 8 are evaluated by fully unrolled kernels
+// blocks keep the static shape of their parent, so the unrolled paths also check the actual size
+constexpr size_t unrolled_size = 8;
+template <typename Mat> constexpr bool is_unrolled =
+  matrix_traits<Mat>::n_rows != dynamic_size && matrix_traits<Mat>::n_rows <= unrolled_size &&
+  matrix_traits<Mat>::n_cols != dynamic_size && matrix_traits<Mat>::n_cols <= unrolled_size;
+template <typename Mat> constexpr size_t static_size = matrix_traits<Mat>::n_rows * matrix_traits<Mat>::n_cols;
+
+template <typename Mat>                     struct is_dense_matrix                     : std::false_type {};
+template <typename T, size_t M, size_t N>   struct is_dense_matrix< matrix<T, M, N> > : std::true_type {};
+
 template <typename D>
 class matrix_base : public xpr<D> {
 public:
@@ -129,9 +144,10 @@ public:
   template <typename Mat>
   auto& operator%=(const matrix_base<Mat>& mat) { return derived() = std::move(*this) % mat; }
 
-  auto sum() const  -> value_type;
-  auto prod() const -> value_type;
-  auto mean() const -> value_type;
+  // Reductions are carried and returned in accum_t, float for 16-bit elements
+  auto sum(summation mode = summation::pairwise) const -> accum_t<value_type>;
+  auto prod() const -> accum_t<value_type>;
+  auto mean() const -> accum_t<value_type>;
 
   class initializer {
   public:
@@ -165,6 +181,11 @@ void eval_helper(matrix_base<Gen>& ev, const matrix_base<Mat>& mat) {
     ev.cols() == mat.cols()
     && "Incoherent algebraic evaluation");
 
+  if constexpr (is_unrolled<Gen>) {
+    if (ev.size() == static_size<Gen>)
+      return unroll< static_size<Gen> >([&](auto i) { ev[i] = mat[i]; });
+  }
+
   for (size_t i = 0; i < ev.size(); ++i)
     ev [i] =
     mat[i];
@@ -185,25 +206,104 @@ void eval(matrix_base<Gen>& ev, const matrix_base<Mat>& mat, typename Gen::dynam
 }
 
 // Cwise
+// Sum or product of a static matrix, dense float storage is reduced by packets of four
+// 16-bit elements are accumulated in float
+template <bool Times, typename D>
+auto unrolled_reduce(const matrix_base<D>& mat) {
+  using value_type = accum_t< matrix_t<D> >;
+  constexpr auto n = static_size<D>;
+  auto op = [](auto x, auto y) { if constexpr (Times) return x * y; else return x + y; };
+
+#if defined(IG_SSE)
+  if constexpr (is_dense_matrix<D>::value && std::is_same_v<matrix_t<D>, float> && n % 4 == 0 && n > 4) {
+    auto p = mat.derived().buffer();
+    auto v = unroll_reduce<n / 4, 4>([p](auto i) { return float4{_mm_loadu_ps(p + 4 * i)}; }, op);
+    return op(op(v[0], v[1]), op(v[2], v[3]));
+  } else
+#endif
+  return unroll_reduce<n>([&mat](auto i) { return value_type(mat[i]); }, op);
+}
+
+// Sum or product of fn(0), ..., fn(n - 1) by runs combined as a balanced tree, the error grows as log n
+constexpr size_t pairwise_run = 256;
+
+template <bool Times, typename T, typename Fn>
+T cwise_reduce(size_t n, Fn&& fn) {
+  auto op = [](auto x, auto y) { if constexpr (Times) return x * y; else return x + y; };
+  const T id(Times ? 1 : 0);
+  return pairwise_reduce<pairwise_run>(0, n, id, id, [&fn, &op](size_t first, size_t last, T acc) {
+    for (auto i = first; i < last; ++i) acc = op(acc, T(fn(i)));
+    return acc;
+  }, op);
+}
+
+#if defined(IG_SSE)
+// Same for floats, fn(i) loads the packet of four elements at i
+template <bool Times, typename Fn, typename Tail>
+float cwise_reduce(size_t n, Fn&& fn, Tail&& tail) {
+  auto op = [](auto x, auto y) { if constexpr (Times) return x * y; else return x + y; };
+  const float4 id{Times ? 1.f : 0.f};
+  auto m = n - n % 8;
+  auto v = pairwise_reduce<pairwise_run>(0, m, id, id, [&fn, &op](size_t first, size_t last, float4 a0) {
+    auto a1 = float4{Times ? 1.f : 0.f};
+    for (auto i = first; i < last; i += 8)
+      a0 = op(a0, fn(i)),
+      a1 = op(a1, fn(i + 4));
+    return float4{op(a0, a1)};
+  }, [&op](const float4& x, const float4& y) { return float4{op(x, y)}; });
+
+  auto acc = op(op(v[0], v[1]), op(v[2], v[3]));
+  for (auto i = m; i < n; ++i) acc = op(acc, tail(i));
+  return acc;
+}
+#endif
+
+// Same with the rounding error of every addition carried along
+template <typename T, typename Fn>
+T cwise_compensated(size_t n, Fn&& fn) {
+  compensated<T> acc;
+  for (size_t i = 0; i < n; ++i) acc += T(fn(i));
+  return acc;
+}
+
 template <typename D>
-auto matrix_base<D>::sum() const -> value_type {
-  return std::accumulate(
-    begin(),
-    end(),
-    value_type(0));
+auto matrix_base<D>::sum(summation mode) const -> accum_t<value_type> {
+  using accum_type = accum_t<value_type>;
+  if constexpr (std::is_floating_point_v<accum_type>) {
+    if (mode == summation::compensated)
+      return cwise_compensated<accum_type>(size(), [this](size_t i) { return (*this)[i]; });
+  }
+  if constexpr (is_unrolled<D>) {
+    if (size() == static_size<D>)
+      return accum_type(unrolled_reduce<false>(*this));
+  }
+#if defined(IG_SSE)
+  if constexpr (is_dense_matrix<D>::value && std::is_same_v<value_type, float>) {
+    auto p = derived().buffer();
+    return cwise_reduce<false>(size(), [p](size_t i) { return float4{_mm_loadu_ps(p + i)}; }, [p](size_t i) { return p[i]; });
+  }
+#endif
+  return cwise_reduce<false, accum_type>(size(), [this](size_t i) { return (*this)[i]; });
 }
 
 template <typename D>
-auto matrix_base<D>::prod() const -> value_type {
-  return std::accumulate(
-    begin(),
-    end(),
-    value_type(1),
-    std::multiplies<>{});
+auto matrix_base<D>::prod() const -> accum_t<value_type> {
+  using accum_type = accum_t<value_type>;
+  if constexpr (is_unrolled<D>) {
+    if (size() == static_size<D>)
+      return accum_type(unrolled_reduce<true>(*this));
+  }
+#if defined(IG_SSE)
+  if constexpr (is_dense_matrix<D>::value && std::is_same_v<value_type, float>) {
+    auto p = derived().buffer();
+    return cwise_reduce<true>(size(), [p](size_t i) { return float4{_mm_loadu_ps(p + i)}; }, [p](size_t i) { return p[i]; });
+  }
+#endif
+  return cwise_reduce<true, accum_type>(size(), [this](size_t i) { return (*this)[i]; });
 }
 
 template <typename D>
-auto matrix_base<D>::mean() const -> value_type
+auto matrix_base<D>::mean() const -> accum_t<value_type>
 { return sum() / size(); }
 
 template <typename Mat>
@@ -27,7 +27,7 @@ public:
   explicit matrix_diag(x_& xpr)
     : xpr_{xpr} {}
 
-  auto rows() const { return xpr_.diagsize(); }
+  auto rows() const { return xpr_.diag_size(); }
   auto cols() const { return matrix_traits<matrix_diag>::n_cols; }
 
   decltype(auto) operator[](size_t n) const
@@ -8,6 +8,7 @@
 #define IG_MATH_MATRIXPROD_H
 
 #include "imagine/math/theory/detail/matrix/base.h"
+#include "imagine/math/theory/simd_accel/intrinsics.h"
 
 namespace ig {
 
@@ -60,16 +61,68 @@ public:
   { return prod_[n]; }
 
 private:
+  static constexpr size_t m = matrix_traits<l_>::n_rows, k = matrix_traits<l_>::n_cols, n = matrix_traits<r_>::n_cols;
+
+  // Rows of the product are combinations of the rows of rhs, a float row of 4 or 8 is held in one packet
+  void eval_unrolled(const l_& lhs, const r_& rhs) {
+#if defined(IG_SSE)
+    if constexpr (std::is_same_v<matrix_t<matrix_prod>, float> && (n == 4 || n == IG_PACKET_WIDE)) {
+      using row_type = std::conditional_t<n == 4, float4, packet>;
+      auto load = [](const float* p) {
+        if constexpr (n == 4) return row_type{_mm_loadu_ps(p)};
+#if defined(IG_AVX)
+        else                  return row_type{_mm256_loadu_ps(p)};
+#endif
+      };
+
+      row_type b[k];
+      unroll<k>([&](auto j) {
+        alignas(32) float row[n];
+        unroll<n>([&](auto c) { row[c] = rhs[j * n + c]; });
+        b[j] = load(row);
+      });
+      unroll<m>([&](auto i) {
+        auto r = unroll_fold<k>([&](auto j) { return row_type{float(lhs[i * k + j])} * b[j]; }, [](auto x, auto y) { return x + y; });
+        if constexpr (n == 4) _mm_storeu_ps(prod_.buffer() + i * n, r);
+#if defined(IG_AVX)
+        else                  _mm256_storeu_ps(prod_.buffer() + i * n, r);
+#endif
+      });
+      return;
+    }
+#endif
+    unroll<m>([&](auto i) {
+      unroll<n>([&](auto c) {
+        prod_[i * n + c] = unroll_fold<k>([&](auto j) { return lhs[i * k + j] * rhs[j * n + c]; }, std::plus<>{});
+      });
+    });
+  }
+
   void eval_product(const l_& lhs, const r_& rhs) {
-    for (size_t i = 0; i < lhs.rows(); ++i)
-      for (size_t j = 0; j < lhs.cols(); ++j)
+    if constexpr (is_unrolled<l_> && is_unrolled<r_>) {
+      if (lhs.size() == m * k && rhs.size() == k * n)
+        return eval_unrolled(lhs, rhs);
+    }
+
+    // Rows are accumulated in accum_t and stored once, 16-bit elements are only rounded at the end
+    using accum_type = accum_t<matrix_t<matrix_prod>>;
+    std::conditional_t<
+      n == dynamic_size,
+      std::vector<accum_type>,
+      std::array<accum_type, n == dynamic_size ? 1 : n>> row{};
+    if constexpr (n == dynamic_size)
+      row.resize(rhs.cols());
+
+    for (size_t i = 0; i < lhs.rows(); ++i) {
+      std::fill_n(row.begin(), rhs.cols(), accum_type(0));
+      for (size_t j = 0; j < lhs.cols(); ++j) {
+        accum_type a = lhs[i * lhs.cols() + j];
         for (size_t k = 0; k < rhs.cols(); ++k)
-          prod_[i * rhs.cols() + k] +=
-            lhs[i * lhs.cols() + j] *
-            rhs[j * rhs.cols() + k];
-          /*prod_(i, k) +=
-            lhs(i, j) *
-            rhs(j, k);*/
+          row[k] += a * accum_type(rhs[j * rhs.cols() + k]);
+      }
+      for (size_t k = 0; k < rhs.cols(); ++k)
+        prod_[i * rhs.cols() + k] = row[k];
+    }
   }
 
   matrix_type prod_;
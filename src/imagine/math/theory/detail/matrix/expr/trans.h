@@ -34,8 +34,8 @@ public:
   matrix_trans(const x_& xpr, std::true_type)  : trans_{} {}
   matrix_trans(const x_& xpr, std::false_type) : trans_{xpr.cols(), xpr.rows()} {}
 
-  auto rows() const { return trans_.cols(); }
-  auto cols() const { return trans_.rows(); }
+  auto rows() const { return trans_.rows(); }
+  auto cols() const { return trans_.cols(); }
 
   decltype(auto) operator()(size_t row, size_t col) const
   { return trans_(row, col); }
@@ -49,9 +49,15 @@ public:
 
 private:
   void eval_transpose(const x_& xpr) {
+    constexpr size_t m = matrix_traits<x_>::n_rows, n = matrix_traits<x_>::n_cols;
+    if constexpr (is_unrolled<x_>) {
+      if (xpr.size() == m * n)
+        return unroll<m * n>([&](auto e) { trans_[e % n * m + e / n] = xpr[e]; });
+    }
+
     for (size_t i = 0; i < xpr.rows(); ++i)
       for (size_t j = 0; j < xpr.cols(); ++j)
-        trans_[j * xpr.cols() + i] =
+        trans_[j * xpr.rows() + i] =
            xpr[i * xpr.cols() + j];
   }
 
@@ -8,7 +8,11 @@
 #define IG_MATH_NDARRAYDYNAMIC_H
 
 #include "imagine/math/basis.h"
-#include <vector>
+#include "imagine/math/theory/detail/ndarray/layout.h"
+#include "imagine/core/mem/arena.h"
+
+#include <memory>
+#include <utility>
 
 namespace ig {
 namespace nd {
@@ -17,31 +21,85 @@ template <typename T>
 class dynamic_storage {
 public:
   using value_type = T;
-  using shape_type     = std::vector<size_t>;
-  using container_type = std::vector<value_type>;
+  using shape_type     = shape_array;
+  // Booleans are held as bytes, std::vector<bool> has no contiguous elements to point at
+  using container_type = arena_vector< std::conditional_t<std::is_same_v<T, bool>, uint8_t, value_type> >;
   friend class ndarray<T>;
 
   explicit dynamic_storage(const shape_type& shape, value_type value = {})
     : shape_{shape}
-    , strides_(shape.size())
-    , buffer_(striding(), value) {}
+    , buffer_(striding(), value)
+    , data_{elements()}
+    , size_{buffer_.size()} {}
+
+  // Elements living outside of the storage (e.g. a file mapping), kept alive by owner
+  explicit dynamic_storage(const shape_type& shape, value_type* data, std::shared_ptr<void> owner)
+    : shape_{shape}
+    , data_{data}
+    , size_{striding()}
+    , owner_{std::move(owner)} {}
+
+  // Copies always own their elements
+  dynamic_storage(const dynamic_storage& o)
+    : shape_{o.shape_}
+    , strides_{o.strides_}
+    , buffer_(o.data_, o.data_ + o.size_)
+    , data_{elements()}
+    , size_{o.size_} {}
+
+  dynamic_storage(dynamic_storage&& o) noexcept
+    : shape_{std::move(o.shape_)}
+    , strides_{std::move(o.strides_)}
+    , buffer_{std::move(o.buffer_)}
+    , data_{std::exchange(o.data_, nullptr)}
+    , size_{std::exchange(o.size_, 0)}
+    , owner_{std::move(o.owner_)} {}
+
+  // External elements are a fixed window, assignments of the same size write through it
+  dynamic_storage& operator=(const dynamic_storage& o) {
+    if (this == &o)
+      return *this;
+    return owner_ && size_ == o.size_
+      ? assign(o)
+      : *this = dynamic_storage{o};
+  }
+
+  dynamic_storage& operator=(dynamic_storage&& o) {
+    if (this == &o)
+      return *this;
+    if (owner_ && size_ == o.size_)
+      return assign(o);
+
+    shape_ = std::move(o.shape_);
+    strides_ = std::move(o.strides_);
+    // Buffers of another resource are moved element-wise
+    buffer_ = std::move(o.buffer_);
+    data_ = o.owner_ ? o.data_ : elements();
+    o.data_ = nullptr;
+    size_ = std::exchange(o.size_, 0);
+    owner_ = std::move(o.owner_);
+    return *this;
+  }
 
   void reshape(const shape_type& shape);
 
   auto dims() const { return shape_.size(); }
-  auto size() const { return buffer_.size(); }
+  auto size() const { return size_; }
+
+  auto buffer() const { return static_cast<const value_type*>(data_); }
+  auto buffer()       { return data_; }
 
-  auto buffer() const { return buffer_.data(); }
-  auto buffer()       { return buffer_.data(); }
+  auto external() const { return owner_ != nullptr; }
 
-  decltype(auto) operator()(size_t n) const { return buffer_[n]; }
-  decltype(auto) operator()(size_t n)       { return buffer_[n]; }
+  decltype(auto) operator()(size_t n) const { return static_cast<const value_type&>(data_[n]); }
+  decltype(auto) operator()(size_t n)       { return data_[n]; }
 
   auto operator[](uint32_t dimension) const
   { return shape_[dimension]; }
 
 protected:
   auto striding();
+  dynamic_storage& assign(const dynamic_storage& o);
 
   template <size_t C = 0, typename Id, typename... Ids> auto offset(Id i, Ids... is) const;
   template <size_t C>
@@ -49,9 +107,14 @@ protected:
   auto& shape() const { return shape_; }
 
 private:
+  auto elements() { return reinterpret_cast<value_type*>(buffer_.data()); }
+
   shape_type shape_;
   shape_type strides_;
   container_type buffer_;
+  value_type* data_;
+  size_t size_;
+  std::shared_ptr<void> owner_;
 };
 
 template <typename T>
@@ -71,19 +134,35 @@ auto dynamic_storage<T>::offset(Id i, Ids... is) const {
       (is...);
 }
 
+template <typename T>
+auto dynamic_storage<T>::assign(const dynamic_storage& o) -> dynamic_storage& {
+  shape_ = o.shape_;
+  strides_ = o.strides_;
+  std::copy_n(o.data_, size_, data_);
+  return *this;
+}
+
 template <typename T>
 void dynamic_storage<T>::reshape(const shape_type& shape) {
   shape_ = shape;
-  buffer_.resize(striding());
+  auto size = striding();
+  if (owner_) {
+    assert(size == size_ && "Invalid reshape, external ndarray storage cannot be resized");
+    return;
+  }
+
+  buffer_.resize(size);
+  data_ = elements();
+  size_ = size;
 }
 
 template <typename T>
 auto dynamic_storage<T>::striding() {
-  strides_.clear();
+  strides_ = shape_type{};
   return std::accumulate(
     shape_.begin(),
     shape_.end(),
-    1, [this](size_t size, uint32_t dimension) { return strides_.emplace_back(size) * dimension; });
+    size_t(1), [this](size_t size, size_t dimension) { strides_.push_back(size); return size * dimension; });
 }
 
 } // namespace nd
@@ -0,0 +1,106 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_NDARRAYMMAP_H
+#define IG_MATH_NDARRAYMMAP_H
+
+#include "imagine/math/theory/detail/ndarray/allocator/dynamic.h"
+#include "imagine/math/theory/detail/ndarray/layout.h"
+#include "imagine/math/theory/detail/ndarray/view.h"
+#include "imagine/envi/mapping.h"
+
+#include <stdexcept>
+
+namespace ig {
+namespace nd {
+
+struct mmap_storage {
+  map_mode mode = map_mode::copy;
+  map_advice advice = map_advice::normal;
+  bool huge_pages = false;
+  size_t offset = 0;
+};
+
+// Read-only window over a mapping, element writes do not compile
+// Views taken from it do not keep the mapping alive
+template <typename T>
+class mapped : public view< const ndarray<T> > {
+public:
+  explicit mapped(std::shared_ptr<mapping> map, const T* data, const shape_array& shape)
+    : view< const ndarray<T> >{data, shape, dense_strides(shape)}
+    , map_{std::move(map)} {}
+
+  auto& resource() const { return map_; }
+
+private:
+  std::shared_ptr<mapping> map_;
+};
+
+namespace detail {
+
+template <typename T>
+auto mapped_data(const std::shared_ptr<mapping>& map, const shape_array& shape, size_t offset) {
+  static_assert(std::is_trivially_copyable_v<T>, "Mapped ndarray elements must be trivially copyable");
+
+  auto size = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<>{});
+  assert(
+    map && map->is_open() &&
+    reinterpret_cast<uintptr_t>(map->data() + offset) % alignof(T) == 0 &&
+    offset + size * sizeof(T) <= map->size()
+    && "Invalid ndarray mapping, resource is too small or misaligned for the given shape");
+  return reinterpret_cast<T*>(map->data() + offset);
+}
+
+inline auto open_mapping(const std::string& path, size_t bytes, const mmap_storage& policy) {
+  auto map = std::make_shared<mapping>(path, policy.mode, bytes, policy.offset);
+
+  if (policy.advice != map_advice::normal)
+    map->advise(policy.advice);
+  if (policy.huge_pages)
+    map->huge_pages();
+  return map;
+}
+
+} // namespace detail
+
+// Dynamic ndarray over the bytes of a mapping at offset, elements are paged on demand
+// The pages of a read mapping cannot be stored to, they are only exposed through cmmap
+template <typename T>
+auto mmap(const std::shared_ptr<mapping>& map, const shape_array& shape, size_t offset = 0) {
+  auto data = detail::mapped_data<T>(map, shape, offset);
+  if (map->mode() == map_mode::read)
+    throw std::runtime_error{"Invalid ndarray mapping, read mappings are not writable (use a copy mapping or cmmap)"};
+
+  return ndarray<T>{
+    dynamic_storage<T>{
+      shape,
+      data,
+      map}};
+}
+
+// Read-only view over the bytes of a mapping at offset, in any mode
+template <typename T>
+auto cmmap(const std::shared_ptr<mapping>& map, const shape_array& shape, size_t offset = 0) {
+  return mapped<T>{map, detail::mapped_data<T>(map, shape, offset), shape};
+}
+
+// Maps exactly the elements of shape, a write mapping creates or extends the file
+template <typename T>
+auto mmap(const std::string& path, const shape_array& shape, const mmap_storage& policy = {}) {
+  auto size = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<>{});
+  return mmap<T>(detail::open_mapping(path, size * sizeof(T), policy), shape);
+}
+
+template <typename T>
+auto cmmap(const std::string& path, const shape_array& shape, const mmap_storage& policy = {map_mode::read}) {
+  auto size = std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<>{});
+  return cmmap<T>(detail::open_mapping(path, size * sizeof(T), policy), shape);
+}
+
+} // namespace nd
+} // namespace ig
+
+#endif // IG_MATH_NDARRAYMMAP_H
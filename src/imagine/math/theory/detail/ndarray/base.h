@@ -9,6 +9,8 @@
 
 #include "imagine/math/basis.h"
 #include "imagine/math/theory/detail/relational.h"
+#include "imagine/math/theory/detail/ndarray/layout.h"
+#include "imagine/math/theory/half.h"
 
 namespace ig {
 
@@ -21,6 +23,19 @@ class wise;
 template <typename Xpr>                 class view;
 template <typename Xpr, typename Shape> class cast;
 
+namespace nd {
+
+// Line of any expression through its flat subscript
+template <typename Xpr>
+struct flat_line {
+  decltype(auto) operator[](size_t j) const { return xpr(base + j); }
+
+  Xpr& xpr;
+  size_t base;
+};
+
+} // namespace nd
+
 // Meta
 template <typename Xpr> struct ndarray_traits;
 template <typename Xpr> struct ndarray_traits<const Xpr> : ndarray_traits<Xpr> {};
@@ -59,6 +74,11 @@ public:
   auto operator[](uint32_t dimension) const
   { return shape()[dimension]; }
 
+  // Traversal by lines along the first dimension, overridden by strided layouts
+  auto line(size_t r) const { return nd::flat_line<const D>{derived(), r * shape()[0]}; }
+  auto line(size_t r)       { return nd::flat_line<D>      {derived(), r * shape()[0]}; }
+  auto contiguous() const { return false; }
+
   auto& operator+=(value_type value)
   { return derived() = std::move(*this) + value; }
   auto& operator-=(value_type value)
@@ -77,8 +97,9 @@ public:
   template <typename Arr>
   auto& operator/=(const ndarray_base<Arr>& arr) { return derived() = std::move(*this) / arr; }
 
-  auto sum() const  -> value_type;
-  auto prod() const -> value_type;
+  // Defined with the reductions, 16-bit elements are accumulated and returned in float
+  auto sum() const  -> accum_t<value_type>;
+  auto prod() const -> accum_t<value_type>;
 };
 
 template <typename D>
@@ -90,24 +111,9 @@ bool ndarray_base<D>::is_balanced() const {
     s.begin());
 }
 
-template <typename D>
-auto ndarray_base<D>::sum() const -> value_type
-{ return std::accumulate(begin(), end(), value_type(0)); }
-
-template <typename D>
-auto ndarray_base<D>::prod() const -> value_type
-{ return std::accumulate(begin(), end(), value_type(1), std::multiplies<>{}); }
-
+// Defined with the vectorized evaluation
 template <typename Gen, typename Arr>
-void eval_helper(ndarray_base<Gen>& ev, const ndarray_base<Arr>& arr) {
-  assert(
-    ev.dims() == arr.dims() &&
-    ev.size() == arr.size() && "Incoherent ndarray expression evaluation");
-
-  for (size_t i = 0; i < ev.size(); ++i)
-    ev (i) =
-    arr(i);
-}
+void eval_helper(ndarray_base<Gen>& ev, const ndarray_base<Arr>& arr);
 
 template <typename Arr>
 inline std::ostream& operator<<(std::ostream& stream, const ndarray_base<Arr>& arr) {
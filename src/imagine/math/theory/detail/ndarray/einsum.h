@@ -0,0 +1,267 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_NDARRAYEINSUM_H
+#define IG_MATH_NDARRAYEINSUM_H
+
+#include "imagine/math/theory/detail/ndarray/reduce.h"
+#include "imagine/math/theory/detail/gemm.h"
+
+#include <memory>
+#include <string>
+
+namespace ig {
+namespace nd {
+namespace detail {
+
+// Operand of a contraction, one label per axis, evaluated operands and intermediates are owned by hold
+template <typename T>
+struct einsum_term {
+  const T* data;
+  shape_array shape;
+  stride_array strides;
+  std::string labels;
+  std::shared_ptr< const ndarray<T> > hold;
+
+  auto axis(char c) const { return labels.find(c); }
+  auto view() const { return ig::view< const ndarray<T> >{data, shape, strides}; }
+};
+
+template <typename T>
+auto einsum_own(std::shared_ptr< const ndarray<T> > arr, std::string labels) {
+  auto dense = dense_strides(arr->shape());
+  if (labels.empty())
+    return einsum_term<T>{arr->buffer(), {}, {}, labels, arr};
+  return einsum_term<T>{arr->buffer(), arr->shape(), dense, labels, arr};
+}
+
+// Strided operands are used in place, the other expressions are evaluated
+template <typename T, typename Arr>
+auto einsum_operand(const ndarray_base<Arr>& arr, const std::string& labels) {
+  assert(labels.size() == arr.dims() && "Invalid einsum subscripts, labels do not match the operand dimensions");
+
+  einsum_term<T> term;
+  if constexpr (is_strided<Arr>::value && std::is_same_v<ndarray_t<Arr>, T>) {
+    auto v = as_view(arr.derived());
+    term = einsum_term<T>{v.buffer(), v.shape(), v.strides(), labels, nullptr};
+  } else {
+    term = einsum_own(std::make_shared< const ndarray<T> >(arr), labels);
+  }
+
+  // Repeated labels select the diagonal, their strides are added
+  einsum_term<T> diag{term.data, {}, {}, {}, term.hold};
+  for (size_t k = 0; k < labels.size(); ++k) {
+    auto d = diag.axis(labels[k]);
+    if (d == std::string::npos) {
+      diag.labels.push_back(labels[k]);
+      diag.shape.push_back(term.shape[k]);
+      diag.strides.push_back(term.strides[k]);
+    } else {
+      assert(diag.shape[d] == term.shape[k] && "Invalid einsum diagonal, axes have different lengths");
+      diag.strides[d] += term.strides[k];
+    }
+  } return diag;
+}
+
+// Sums out the labels that are not kept
+template <typename T>
+auto einsum_reduce(const einsum_term<T>& t, const std::string& keep) {
+  shape_array axes;
+  std::string labels;
+  for (size_t k = 0; k < t.labels.size(); ++k) {
+    if (keep.find(t.labels[k]) == std::string::npos) axes.push_back(k);
+    else labels.push_back(t.labels[k]);
+  }
+  if (axes.empty())
+    return t;
+  return einsum_own(std::make_shared< const ndarray<T> >(sum(t.view(), axes)), labels);
+}
+
+// Labels that can be walked as a single strided dimension, in order with the first as the fastest
+struct einsum_group {
+  size_t size = 1;
+  std::ptrdiff_t stride = 0;
+  bool fused = true;
+};
+
+template <typename T>
+auto einsum_fuse(const einsum_term<T>& t, const std::string& order) {
+  einsum_group g;
+  std::ptrdiff_t next = 0;
+  for (auto c : order) {
+    auto k = t.axis(c);
+    auto n = t.shape[k];
+    if (n == 1) continue;
+    if (g.size == 1) g.stride = t.strides[k];
+    else if (t.strides[k] != next) g.fused = false;
+    next = t.strides[k] * std::ptrdiff_t(n);
+    g.size *= n;
+  } return g;
+}
+
+// Copy in the given label order, dense with the first as the fastest
+template <typename T>
+auto einsum_dense(const einsum_term<T>& t, const std::string& order) {
+  shape_array perm;
+  for (auto c : order) perm.push_back(t.axis(c));
+  return einsum_own(std::make_shared< const ndarray<T> >(t.view().permute(perm)), order);
+}
+
+template <typename T>
+auto einsum_sorted(const einsum_term<T>& t, std::string labels) {
+  std::stable_sort(labels.begin(), labels.end(), [&](auto lhs, auto rhs) {
+    return std::abs(t.strides[t.axis(lhs)]) < std::abs(t.strides[t.axis(rhs)]);
+  }); return labels;
+}
+
+// Pairwise contraction mapped on a product per batch, c(m, n) = a(m, k) b(k, n)
+// m are the kept labels of a only, n those of b only, k the shared labels that are summed and the others are batches
+template <typename T>
+auto einsum_pair(einsum_term<T> a, einsum_term<T> b, const std::string& keep) {
+  auto shared = [](const einsum_term<T>& t, char c) { return t.axis(c) != std::string::npos; };
+
+  std::string keep_a = keep + b.labels, keep_b = keep + a.labels;
+  a = einsum_reduce(a, keep_a);
+  b = einsum_reduce(b, keep_b);
+
+  std::string m, n, k, batch;
+  for (auto c : a.labels) {
+    if (!shared(b, c)) m.push_back(c);
+    else if (keep.find(c) == std::string::npos) k.push_back(c);
+    else batch.push_back(c);
+  }
+  for (auto c : b.labels)
+    if (!shared(a, c)) n.push_back(c);
+
+  // Label orders follow the strides, operands are copied only when a group cannot be walked as one dimension
+  m = einsum_sorted(a, m);
+  n = einsum_sorted(b, n);
+  auto ka = einsum_sorted(a, k), kb = einsum_sorted(b, k);
+  k = einsum_fuse(b, ka).fused || !einsum_fuse(a, kb).fused || !einsum_fuse(b, kb).fused ? ka : kb;
+
+  if (!einsum_fuse(a, m).fused || !einsum_fuse(a, k).fused) a = einsum_dense(a, m + k + batch);
+  if (!einsum_fuse(b, k).fused || !einsum_fuse(b, n).fused) b = einsum_dense(b, k + n + batch);
+
+  auto ga = einsum_fuse(a, m), gk = einsum_fuse(a, k), gb = einsum_fuse(b, k), gn = einsum_fuse(b, n);
+
+  // Result labels m, n then batches
+  shape_array shape;
+  for (auto c : m + n + batch) shape.push_back(a.axis(c) != std::string::npos ? a.shape[a.axis(c)] : b.shape[b.axis(c)]);
+  auto res = std::make_shared< ndarray<T> >(shape.empty() ? shape_array{1} : shape);
+  auto out = einsum_own<T>(res, m + n + batch);
+
+  shape_array extent;
+  stride_array sa, sb, sc;
+  for (auto c : batch)
+    extent.push_back(a.shape[a.axis(c)]),
+    sa.push_back(a.strides[a.axis(c)]),
+    sb.push_back(b.strides[b.axis(c)]),
+    sc.push_back(out.strides[out.axis(c)]);
+
+  auto count = std::accumulate(extent.begin(), extent.end(), size_t(1), std::multiplies<>{});
+  auto product = [&](size_t id) {
+    std::ptrdiff_t oa = 0, ob = 0, oc = 0;
+    for (size_t q = 0; q < extent.size(); ++q) {
+      auto i = std::ptrdiff_t(id % extent[q]); id /= extent[q];
+      oa += i * sa[q], ob += i * sb[q], oc += i * sc[q];
+    }
+
+    gemm(ga.size, gn.size, gk.size, T(1),
+      gemm_operand<const T>{a.data + oa, ga.stride, gk.stride},
+      gemm_operand<const T>{b.data + ob, gb.stride, gn.stride},
+      T(0),
+      gemm_operand<T>{res->buffer() + oc, 1, std::ptrdiff_t(ga.size)});
+  };
+
+  // Many small products are spread as a whole, a few large ones are split inside
+  auto threads = in_parallel() ? size_t(1) : pool().size() + 1;
+  if (count >= threads) {
+    auto work = ga.size * gn.size * std::max<size_t>(gk.size, 1);
+    parallel_for(0, count, std::max<size_t>(1, parallel_grain / std::max<size_t>(work, 1)), [&](size_t first, size_t last) {
+      for (auto id = first; id < last; ++id) product(id);
+    });
+  } else {
+    for (size_t id = 0; id < count; ++id) product(id);
+  } return out;
+}
+
+} // namespace detail
+
+// Contraction of the operands over the labels of an einstein summation, "ij,jk->ik" is a matrix product
+// labels match the axes in order, repeated labels within an operand take its diagonal
+// without "->", the output holds the labels seen once in alphabetical order
+// pairs are contracted greedily by smallest intermediate, each pair is a batched product over strided operands
+template <typename... Arrs>
+auto einsum(const std::string& subscripts, const ndarray_base<Arrs>&... arrs) {
+  using T = std::common_type_t< ndarray_t<Arrs>... >;
+
+  std::string spec;
+  for (auto c : subscripts)
+    if (c != ' ') spec.push_back(c);
+
+  auto arrow = spec.find("->");
+  auto inputs = spec.substr(0, arrow);
+  std::vector<std::string> labels(1);
+  for (auto c : inputs) {
+    if (c == ',') labels.emplace_back();
+    else labels.back().push_back(c);
+  }
+  assert(labels.size() == sizeof...(Arrs) && "Invalid einsum subscripts, operand count mismatch");
+
+  std::string output;
+  if (arrow != std::string::npos) {
+    output = spec.substr(arrow + 2);
+  } else {
+    for (char c = 'A'; c <= 'z'; ++c)
+      if (std::count(inputs.begin(), inputs.end(), c) == 1) output.push_back(c);
+  }
+
+  size_t q = 0;
+  std::vector< detail::einsum_term<T> > terms{detail::einsum_operand<T>(arrs, labels[q++])...};
+  for (auto c : output)
+    assert(std::any_of(terms.begin(), terms.end(), [c](auto& t) { return t.axis(c) != std::string::npos; }) && "Invalid einsum output label");
+
+  // Labels needed by the output or by the other operands
+  auto needed = [&](size_t skip0, size_t skip1) {
+    auto keep = output;
+    for (size_t t = 0; t < terms.size(); ++t)
+      if (t != skip0 && t != skip1) keep += terms[t].labels;
+    return keep;
+  };
+
+  while (terms.size() > 1) {
+    size_t best0 = 0, best1 = 1, cost = std::numeric_limits<size_t>::max();
+    for (size_t i = 0; i < terms.size(); ++i)
+      for (size_t j = i + 1; j < terms.size(); ++j) {
+        auto keep = needed(i, j);
+        std::string seen;
+        size_t size = 1;
+        for (auto t : {&terms[i], &terms[j]})
+          for (size_t k = 0; k < t->labels.size(); ++k) {
+            auto c = t->labels[k];
+            if (keep.find(c) != std::string::npos && seen.find(c) == std::string::npos)
+              seen.push_back(c), size *= t->shape[k];
+          }
+        if (size < cost) cost = size, best0 = i, best1 = j;
+      }
+
+    auto res = detail::einsum_pair(terms[best0], terms[best1], needed(best0, best1));
+    terms.erase(terms.begin() + std::ptrdiff_t(best1));
+    terms[best0] = std::move(res);
+  }
+
+  auto last = detail::einsum_reduce(terms[0], output);
+  shape_array perm;
+  for (auto c : output) perm.push_back(last.axis(c));
+  if (output.empty())
+    return ndarray<T>{last.view().reshape({1})};
+  return ndarray<T>{last.view().permute(perm)};
+}
+
+} // namespace nd
+} // namespace ig
+
+#endif // IG_MATH_NDARRAYEINSUM_H
@@ -0,0 +1,175 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_NDARRAYEVAL_H
+#define IG_MATH_NDARRAYEVAL_H
+
+#include "imagine/math/theory/detail/ndarray/base.h"
+#include "imagine/math/theory/detail/ndarray/expr/wise.h"
+#include "imagine/math/theory/detail/ndarray/expr/cast.h"
+#include "imagine/math/theory/simd_accel/intrinsics.h"
+#include "imagine/math/theory/half.h"
+#include "imagine/core/net/distribute.h"
+
+namespace ig {
+namespace nd {
+
+// Elements per task when an evaluation is split across the job pool
+constexpr size_t parallel_grain = size_t(1) << 15;
+
+#if defined(IG_SSE)
+
+inline auto load(const float* p) {
+#if defined(IG_AVX)
+  return packet{_mm256_loadu_ps(p)};
+#else
+  return packet{_mm_loadu_ps(p)};
+#endif
+}
+
+inline void store(float* p, const packet& v) {
+#if defined(IG_AVX)
+  _mm256_storeu_ps(p, v);
+#else
+  _mm_storeu_ps(p, v);
+#endif
+}
+
+// Operators with a packet counterpart
+template <typename F> struct packet_op : std::false_type {};
+
+template <> struct packet_op< std::plus<> >       : std::true_type { static auto run(const std::plus<>&,       const packet& a, const packet& b) { return a + b; } };
+template <> struct packet_op< std::minus<> >      : std::true_type { static auto run(const std::minus<>&,      const packet& a, const packet& b) { return a - b; } };
+template <> struct packet_op< std::multiplies<> > : std::true_type { static auto run(const std::multiplies<>&, const packet& a, const packet& b) { return a * b; } };
+template <> struct packet_op< std::divides<> >    : std::true_type { static auto run(const std::divides<>&,    const packet& a, const packet& b) { return a / b; } };
+template <> struct packet_op< std::negate<> >     : std::true_type { static auto run(const std::negate<>&,     const packet& a)                  { return -a; } };
+
+template <typename Op>
+struct packet_op< bind_lhs<Op, float> > : packet_op<Op> {
+  static auto run(const bind_lhs<Op, float>& f, const packet& a) { return packet_op<Op>::run(Op{}, packet{f.s}, a); }
+};
+
+template <typename Op>
+struct packet_op< bind_rhs<Op, float> > : packet_op<Op> {
+  static auto run(const bind_rhs<Op, float>& f, const packet& a) { return packet_op<Op>::run(Op{}, a, packet{f.s}); }
+};
+
+// Lines that can be loaded packet by packet
+template <typename L> struct packet_line : std::false_type {};
+template <>           struct packet_line< line<const float> > : std::true_type {};
+template <>           struct packet_line< line<float> >       : std::true_type {};
+template <>           struct packet_line< line<const float16> >  : std::true_type {};
+template <>           struct packet_line< line<float16> >        : std::true_type {};
+template <>           struct packet_line< line<const bfloat16> > : std::true_type {};
+template <>           struct packet_line< line<bfloat16> >       : std::true_type {};
+
+template <typename F, typename... Lines>
+struct packet_line< wise_line<F, Lines...> >
+  : std::bool_constant<packet_op<F>::value && (packet_line<Lines>::value && ...)> {};
+
+template <typename Line>
+struct packet_line< cast_line<Line> > : packet_line<Line> {};
+
+template <typename T>
+auto gather(const line<T>& l, size_t j) {
+  packet v;
+  for (size_t k = 0; k < IG_PACKET_WIDE; ++k) v[k] = l[j + k];
+  return v;
+}
+
+template <typename T>
+inline auto load(const line<T>& l, size_t j) {
+  if (l.stride == 1) return load(l.ptr + j);
+  if (l.stride == 0) return packet{*l.ptr};
+  return gather(l, j);
+}
+
+template <typename F, typename... Lines>
+inline auto load(const wise_line<F, Lines...>& l, size_t j) {
+  return std::apply([&](auto&... x) { return packet_op<F>::run(l.op, load(x, j)...); }, l.lines);
+}
+
+template <typename Line>
+inline auto load(const cast_line<Line>& l, size_t j) { return l.stride ? load(l.line, j) : packet{float(l.line[0])}; }
+
+// Dense lines, loaded without any stride dispatch
+template <typename T>
+inline bool unit(const line<T>& l) { return l.stride == 1; }
+template <typename F, typename... Lines>
+inline bool unit(const wise_line<F, Lines...>& l) { return std::apply([](auto&... x) { return (unit(x) && ...); }, l.lines); }
+template <typename Line>
+inline bool unit(const cast_line<Line>& l) { return l.stride && unit(l.line); }
+
+template <typename T>
+inline auto load_unit(const line<T>& l, size_t j) { return load(l.ptr + j); }
+template <typename F, typename... Lines>
+inline auto load_unit(const wise_line<F, Lines...>& l, size_t j) {
+  return std::apply([&](auto&... x) { return packet_op<F>::run(l.op, load_unit(x, j)...); }, l.lines);
+}
+template <typename Line>
+inline auto load_unit(const cast_line<Line>& l, size_t j) { return load_unit(l.line, j); }
+
+#endif
+
+// Evaluates [first, last) of a line, by packets when the whole tree allows it
+template <typename Dst, typename Src>
+void eval_line(const Dst& dst, const Src& src, size_t first, size_t last) {
+  auto j = first;
+#if defined(IG_SSE)
+  if constexpr (packet_line<Dst>::value && packet_line<Src>::value) {
+    if (dst.stride == 1 && unit(src)) {
+      for (; j + IG_PACKET_WIDE <= last; j += IG_PACKET_WIDE)
+        store(dst.ptr + j, load_unit(src, j));
+    } else if (dst.stride == 1) {
+      for (; j + IG_PACKET_WIDE <= last; j += IG_PACKET_WIDE)
+        store(dst.ptr + j, load(src, j));
+    }
+  }
+#endif
+  for (; j < last; ++j)
+    dst[j] = src[j];
+}
+
+} // namespace nd
+
+template <typename Gen, typename Arr>
+void eval_helper(ndarray_base<Gen>& ev, const ndarray_base<Arr>& arr) {
+  assert(
+    ev.dims() == arr.dims() &&
+    ev.size() == arr.size() && "Incoherent ndarray expression evaluation");
+
+  auto& dst = ev.derived();
+  auto& src = arr.derived();
+  auto size = ev.size();
+  if (!size)
+    return;
+
+  // Dense operands form a single line
+  if (dst.contiguous() && src.contiguous()) {
+    auto d = dst.line(0);
+    auto s = src.line(0);
+    parallel_for(0, size, nd::parallel_grain, [&](size_t first, size_t last) {
+      nd::eval_line(d, s, first, last);
+    }); return;
+  }
+
+  auto n = ev.shape()[0];
+  if (n != arr.shape()[0]) {
+    for (size_t i = 0; i < size; ++i)
+      ev (i) =
+      arr(i);
+    return;
+  }
+
+  parallel_for(0, size / n, std::max<size_t>(1, nd::parallel_grain / n), [&](size_t first, size_t last) {
+    for (auto r = first; r < last; ++r)
+      nd::eval_line(dst.line(r), src.line(r), 0, n);
+  });
+}
+
+} // namespace ig
+
+#endif // IG_MATH_NDARRAYEVAL_H
@@ -8,8 +8,21 @@
 #define IG_MATH_NDARRAYCAST_H
 
 #include "imagine/math/theory/detail/ndarray/base.h"
+#include "imagine/math/theory/detail/ndarray/view.h"
 
 namespace ig {
+namespace nd {
+
+// Line of a broadcast operand, a zero stride repeats its first element and a unit stride forwards to it
+template <typename Line>
+struct cast_line {
+  decltype(auto) operator[](size_t j) const { return line[stride ? j : 0]; }
+
+  Line line;
+  std::ptrdiff_t stride;
+};
+
+} // namespace nd
 
 template <typename Xpr, typename Shape>
 struct ndarray_traits
@@ -20,6 +33,7 @@ struct ndarray_traits
   using value_type = ndarray_t<Xpr>;
 };
 
+// Broadcast of an expression without layout, subscripts are mapped through zero strides
 template
 < typename x_,
   typename s_ >
@@ -33,18 +47,58 @@ public:
         shape_.begin(),
         shape_.end(),
         size_t(1),
-        std::multiplies<>{})} {}
+        std::multiplies<>{})} {
+
+    decltype(auto) xs = xpr_.shape();
+    auto dense = nd::dense_strides(xs);
+
+    strides_ = nd::stride_array(shape_.size(), 0);
+    for (size_t k = 0; k < xs.size(); ++k)
+      if (xs[k] == shape_[k]) strides_[k] = dense[k];
+  }
 
   auto size() const { return size_; }
   auto dims() const { return shape_.size(); }
   auto& shape() const { return shape_; }
 
-  template <typename... Id> decltype(auto) operator()(Id... ids) const { return xpr_(ids % xpr_.size()...); }
-  template <typename... Id> decltype(auto) operator()(Id... ids)       { return xpr_(ids % xpr_.size()...); }
+  template <typename... Id> decltype(auto) operator()(Id... ids) const { return xpr_(at(ids...)); }
+  template <typename... Id> decltype(auto) operator()(Id... ids)       { return xpr_(at(ids...)); }
+
+  // Outer dimensions are resolved once per line, the first one is left to the operand
+  auto line(size_t r) const {
+    decltype(auto) xs = xpr_.shape();
+    auto off = outer(r) / (xs.size() ? xs[0] : 1);
+    return nd::cast_line<decltype(xpr_.line(0))>{xpr_.line(off), strides_[0]};
+  }
 
 private:
+  size_t outer(size_t r) const {
+    size_t off = 0;
+    for (size_t k = 1; k < dims(); ++k)
+      off += (r % shape_[k]) * strides_[k],
+      r /= shape_[k];
+    return off;
+  }
+
+  template <typename... Id>
+  size_t at(Id... ids) const {
+    size_t is[] = {size_t(ids)...};
+    if constexpr (sizeof...(Id) == 1) {
+      size_t off = 0, i = is[0];
+      for (size_t k = 0; k < dims(); ++k)
+        off += (i % shape_[k]) * strides_[k],
+        i /= shape_[k];
+      return off;
+    } else {
+      size_t off = 0;
+      for (size_t k = 0; k < sizeof...(Id); ++k) off += is[k] * strides_[k];
+      return off;
+    }
+  }
+
   x_ xpr_;
   s_ shape_; size_t size_;
+  nd::stride_array strides_;
 };
 
 // deduction
@@ -52,22 +106,28 @@ template <typename x_, typename s_> cast(x_&&, const s_&) -> cast<std::condition
 
 namespace nd {
 
+// Strided operands are broadcast as views with zero strides, other expressions through a cast
 template <typename Xpr, typename Shape>
 constexpr auto broadcast(Xpr&& xpr, const Shape& shape) {
   auto valid_cast = [xs = xpr.shape(), &shape] {
     return
+    xs.size() <= shape.size() &&
     std::equal(
       xs.begin(),
       xs.end(),
       shape.begin(),
       [](auto& lhs, auto& rhs) {
         return lhs == rhs ||
-               lhs == 1   ||
-               rhs == 1; }); };
+               lhs == 1; }); };
   assert(
     valid_cast() &&
     "Invalid ndarray broadcasting, dimensions must be either equal or one of them must be one");
-  return cast{xpr.derived(), shape};
+
+  if constexpr (is_strided< std::decay_t<decltype(xpr.derived())> >::value) {
+    return as_view(xpr.derived()).broadcast(shape_array{shape.begin(), shape.end()});
+  } else {
+    return cast{xpr.derived(), shape};
+  }
 }
 
 } // namespace nd
@@ -10,6 +10,32 @@
 #include "imagine/math/theory/detail/ndarray/base.h"
 
 namespace ig {
+namespace nd {
+
+template <typename F, typename... Lines>
+struct wise_line {
+  decltype(auto) operator[](size_t j) const { return std::apply([&](auto&... l) { return op(l[j]...); }, lines); }
+
+  const F& op;
+  std::tuple<Lines...> lines;
+};
+
+template <typename F, typename... Lines> wise_line(const F&, std::tuple<Lines...>) -> wise_line<F, Lines...>;
+
+// Operators with a bound scalar operand
+template <typename Op, typename S>
+struct bind_lhs {
+  template <typename X> constexpr auto operator()(X&& x) const { return Op{}(s, std::forward<X>(x)); }
+  S s;
+};
+
+template <typename Op, typename S>
+struct bind_rhs {
+  template <typename X> constexpr auto operator()(X&& x) const { return Op{}(std::forward<X>(x), s); }
+  S s;
+};
+
+} // namespace nd
 
 template <typename F, typename... Xprs>
 struct ndarray_traits
@@ -36,6 +62,9 @@ public:
   template <typename... Id> decltype(auto) operator()(Id... ids) const { return std::apply([&](auto&&... x) { return op_(x(ids...)...); }, xprs_); }
   template <typename... Id> decltype(auto) operator()(Id... ids)       { return std::apply([&](auto&&... x) { return op_(x(ids...)...); }, xprs_); }
 
+  auto line(size_t r) const { return std::apply([&](auto&... x) { return nd::wise_line{op_, std::make_tuple(x.line(r)...)}; }, xprs_); }
+  auto contiguous() const { return std::apply([](auto&... x) { return (x.contiguous() && ...); }, xprs_); }
+
 private:
   f_ op_;
   std::tuple<x_...>
@@ -74,17 +103,17 @@ using swise =
      (std::is_same_v<ndarray_t<Xpr>, S> && std::is_trivially_copyable_v<S>)
   >;
 
-template < typename Lhs, typename S, typename = swise<S, Lhs> > constexpr auto operator+(const ndarray_base<Lhs>& lhs, S rhs) { return wise{[rhs](auto&& x) { return x + rhs; }, lhs.derived()}; }
-template < typename Rhs, typename S, typename = swise<S, Rhs> > constexpr auto operator+(S lhs, const ndarray_base<Rhs>& rhs) { return wise{[lhs](auto&& x) { return lhs + x; }, rhs.derived()}; }
+template < typename Lhs, typename S, typename = swise<S, Lhs> > constexpr auto operator+(const ndarray_base<Lhs>& lhs, S rhs) { return wise{nd::bind_rhs<std::plus<>, S>{rhs}, lhs.derived()}; }
+template < typename Rhs, typename S, typename = swise<S, Rhs> > constexpr auto operator+(S lhs, const ndarray_base<Rhs>& rhs) { return wise{nd::bind_lhs<std::plus<>, S>{lhs}, rhs.derived()}; }
 
-template < typename Lhs, typename S, typename = swise<S, Lhs> > constexpr auto operator-(const ndarray_base<Lhs>& lhs, S rhs) { return wise{[rhs](auto&& x) { return x - rhs; }, lhs.derived()}; }
-template < typename Rhs, typename S, typename = swise<S, Rhs> > constexpr auto operator-(S lhs, const ndarray_base<Rhs>& rhs) { return wise{[lhs](auto&& x) { return lhs - x; }, rhs.derived()}; }
+template < typename Lhs, typename S, typename = swise<S, Lhs> > constexpr auto operator-(const ndarray_base<Lhs>& lhs, S rhs) { return wise{nd::bind_rhs<std::minus<>, S>{rhs}, lhs.derived()}; }
+template < typename Rhs, typename S, typename = swise<S, Rhs> > constexpr auto operator-(S lhs, const ndarray_base<Rhs>& rhs) { return wise{nd::bind_lhs<std::minus<>, S>{lhs}, rhs.derived()}; }
 
-template < typename Lhs, typename S, typename = swise<S, Lhs> > constexpr auto operator*(const ndarray_base<Lhs>& lhs, S rhs) { return wise{[rhs](auto&& x) { return x * rhs; }, lhs.derived()}; }
-template < typename Rhs, typename S, typename = swise<S, Rhs> > constexpr auto operator*(S lhs, const ndarray_base<Rhs>& rhs) { return wise{[lhs](auto&& x) { return lhs * x; }, rhs.derived()}; }
+template < typename Lhs, typename S, typename = swise<S, Lhs> > constexpr auto operator*(const ndarray_base<Lhs>& lhs, S rhs) { return wise{nd::bind_rhs<std::multiplies<>, S>{rhs}, lhs.derived()}; }
+template < typename Rhs, typename S, typename = swise<S, Rhs> > constexpr auto operator*(S lhs, const ndarray_base<Rhs>& rhs) { return wise{nd::bind_lhs<std::multiplies<>, S>{lhs}, rhs.derived()}; }
 
-template < typename Lhs, typename S, typename = swise<S, Lhs> > constexpr auto operator/(const ndarray_base<Lhs>& lhs, S rhs) { return wise{[rhs](auto&& x) { return x / rhs; }, lhs.derived()}; }
-template < typename Rhs, typename S, typename = swise<S, Rhs> > constexpr auto operator/(S lhs, const ndarray_base<Rhs>& rhs) { return wise{[lhs](auto&& x) { return lhs / x; }, rhs.derived()}; }
+template < typename Lhs, typename S, typename = swise<S, Lhs> > constexpr auto operator/(const ndarray_base<Lhs>& lhs, S rhs) { return wise{nd::bind_rhs<std::divides<>, S>{rhs}, lhs.derived()}; }
+template < typename Rhs, typename S, typename = swise<S, Rhs> > constexpr auto operator/(S lhs, const ndarray_base<Rhs>& rhs) { return wise{nd::bind_lhs<std::divides<>, S>{lhs}, rhs.derived()}; }
 
 } // namespace ig
 
@@ -0,0 +1,90 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_NDARRAYLAYOUT_H
+#define IG_MATH_NDARRAYLAYOUT_H
+
+#include "imagine/math/basis.h"
+#include <array>
+
+namespace ig {
+namespace nd {
+
+constexpr size_t max_dims = 8;
+
+// Fixed-capacity sequence for shapes and strides, never allocates
+template <typename T>
+class dims_array {
+public:
+  using value_type = T;
+
+  constexpr dims_array() = default;
+  constexpr explicit dims_array(size_t n, value_type value = {}) : n_{n} {
+    assert(n <= max_dims && "Too many ndarray dimensions");
+    std::fill_n(d_.begin(), n, value);
+  }
+
+  template <typename It>
+  constexpr explicit dims_array(It first, It last) {
+    for (; first != last; ++first) push_back(value_type(*first));
+  }
+
+  constexpr dims_array(std::initializer_list<value_type> values)
+    : dims_array{values.begin(), values.end()} {}
+
+  constexpr auto size() const  { return n_; }
+  constexpr auto empty() const { return n_ == 0; }
+
+  constexpr auto begin() const { return d_.begin(); }
+  constexpr auto begin()       { return d_.begin(); }
+  constexpr auto end() const   { return d_.begin() + n_; }
+  constexpr auto end()         { return d_.begin() + n_; }
+
+  constexpr auto& operator[](size_t n) const { return d_[n]; }
+  constexpr auto& operator[](size_t n)       { return d_[n]; }
+
+  constexpr void push_back(value_type value) {
+    assert(n_ < max_dims && "Too many ndarray dimensions");
+    d_[n_++] = value;
+  }
+
+  constexpr void erase(size_t n) {
+    std::copy(d_.begin() + n + 1, end(), d_.begin() + n);
+    --n_;
+  }
+
+private:
+  std::array<value_type, max_dims> d_{};
+  size_t n_ = 0;
+};
+
+using shape_array  = dims_array<size_t>;
+using stride_array = dims_array<std::ptrdiff_t>;
+
+// Dense strides, the first dimension is the fastest
+template <typename Shape>
+constexpr auto dense_strides(const Shape& shape) {
+  stride_array strides;
+  std::ptrdiff_t s = 1;
+  for (auto d : shape)
+    strides.push_back(s),
+    s *= std::ptrdiff_t(d);
+  return strides;
+}
+
+// Run of elements along the first dimension, the stride is zero for a broadcast dimension
+template <typename T>
+struct line {
+  decltype(auto) operator[](size_t j) const { return ptr[std::ptrdiff_t(j) * stride]; }
+
+  T* ptr;
+  std::ptrdiff_t stride;
+};
+
+} // namespace nd
+} // namespace ig
+
+#endif // IG_MATH_NDARRAYLAYOUT_H
@@ -0,0 +1,410 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_NDARRAYREDUCE_H
+#define IG_MATH_NDARRAYREDUCE_H
+
+#include "imagine/math/theory/ndarray.h"
+#include "imagine/math/theory/detail/accumulate.h"
+
+#include <limits>
+
+namespace ig {
+namespace nd {
+
+// Reduction operators, the packet overloads are used on dense float and 16-bit lines
+struct plus_reduce {
+  template <typename T> static constexpr T identity() { return T(0); }
+  template <typename T> static auto run(const T& a, const T& b) { return a + b; }
+};
+
+struct times_reduce {
+  template <typename T> static constexpr T identity() { return T(1); }
+  template <typename T> static auto run(const T& a, const T& b) { return a * b; }
+};
+
+struct min_reduce {
+  template <typename T> static constexpr T identity() { return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max(); }
+  template <typename T> static auto run(const T& a, const T& b) {
+    if constexpr (std::is_arithmetic_v<T>) return std::min(a, b);
+    else return min(a, b);
+  }
+};
+
+struct max_reduce {
+  template <typename T> static constexpr T identity() { return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest(); }
+  template <typename T> static auto run(const T& a, const T& b) {
+    if constexpr (std::is_arithmetic_v<T>) return std::max(a, b);
+    else return max(a, b);
+  }
+};
+
+struct same_map   { template <typename T> auto operator()(const T& x) const { return x; } };
+struct square_map { template <typename T> auto operator()(const T& x) const { return x * x; } };
+
+namespace detail {
+
+// Loops of a traversal ordered from the outermost, with input, output and logical index strides
+struct reduce_layout {
+  shape_array shape;
+  stride_array in, out, idx;
+
+  auto loops() const { return shape.size(); }
+};
+
+template <typename View>
+auto reduce_plan(const View& v, const shape_array& axes) {
+  auto dims = v.dims();
+  auto& shape = v.shape();
+
+  bool reduced[max_dims] = {};
+  for (auto a : axes) {
+    assert(a < dims && !reduced[a] && "Invalid ndarray reduction axis");
+    reduced[a] = true;
+  }
+  if (axes.empty()) std::fill_n(reduced, dims, true);
+
+  // Dense output strides over kept dimensions, logical strides over reduced ones
+  stride_array out(dims, 0), idx(dims, 0);
+  shape_array kept;
+  std::ptrdiff_t os = 1, is = 1;
+  for (size_t k = 0; k < dims; ++k) {
+    if (reduced[k])
+      idx[k] = is, is *= std::ptrdiff_t(shape[k]);
+    else
+      out[k] = os, os *= std::ptrdiff_t(shape[k]), kept.push_back(shape[k]);
+  }
+
+  // Outermost loops have the largest input strides
+  shape_array order;
+  for (size_t k = 0; k < dims; ++k)
+    if (shape[k] > 1) order.push_back(k);
+  std::stable_sort(order.begin(), order.end(), [&](auto lhs, auto rhs) {
+    return std::abs(v.strides()[lhs]) > std::abs(v.strides()[rhs]);
+  });
+
+  reduce_layout l;
+  for (auto k : order) {
+    auto n = l.loops();
+    auto e = std::ptrdiff_t(shape[k]);
+    if (n &&
+        l.in [n - 1] == v.strides()[k] * e &&
+        l.out[n - 1] == out[k] * e &&
+        l.idx[n - 1] == idx[k] * e) {
+      // Merge with the enclosing loop
+      l.shape[n - 1] *= shape[k];
+      l.in [n - 1] = v.strides()[k];
+      l.out[n - 1] = out[k];
+      l.idx[n - 1] = idx[k];
+    } else {
+      l.shape.push_back(shape[k]);
+      l.in .push_back(v.strides()[k]);
+      l.out.push_back(out[k]);
+      l.idx.push_back(idx[k]);
+    }
+  }
+  if (!l.loops())
+    l.shape.push_back(1), l.in.push_back(0), l.out.push_back(0), l.idx.push_back(0);
+
+  if (kept.empty()) kept.push_back(1);
+  return std::make_pair(l, kept);
+}
+
+template <typename Inner>
+void reduce_run(const reduce_layout& l, size_t k, std::ptrdiff_t in, std::ptrdiff_t out, std::ptrdiff_t idx, size_t first, size_t last, Inner& inner) {
+  if (k + 1 == l.loops()) {
+    inner(in + std::ptrdiff_t(first) * l.in[k], out + std::ptrdiff_t(first) * l.out[k], idx + std::ptrdiff_t(first) * l.idx[k],
+          last - first, l.in[k], l.out[k], l.idx[k]);
+    return;
+  }
+  for (auto i = first; i < last; ++i)
+    reduce_run(l, k + 1, in + std::ptrdiff_t(i) * l.in[k], out + std::ptrdiff_t(i) * l.out[k], idx + std::ptrdiff_t(i) * l.idx[k], 0, l.shape[k + 1], inner);
+}
+
+// Splits the outermost loop across the job pool, partial outputs are combined as a balanced tree when it is reduced
+// the split depends on the shape only, so that results are bitwise identical for any number of threads
+constexpr size_t partial_budget = size_t(1) << 20;
+
+template <typename Acc, typename Inner, typename Combine>
+void reduce_parallel(const reduce_layout& l, Acc* out, size_t size, const Acc& init, Inner&& inner, Combine&& combine) {
+  auto n = l.shape[0];
+  auto total = std::accumulate(l.shape.begin(), l.shape.end(), size_t(1), std::multiplies<>{});
+  auto grain = std::max<size_t>(1, parallel_grain / std::max<size_t>(1, total / n));
+
+  if (l.out[0] != 0 || l.loops() == 0) {
+    parallel_for(0, n, grain, [&](size_t first, size_t last) {
+      auto run = [&](auto... args) { inner(out, args...); };
+      reduce_run(l, 0, 0, 0, 0, first, last, run);
+    }); return;
+  }
+
+  auto chunks = std::min((n + grain - 1) / grain, std::max<size_t>(1, partial_budget / size));
+  if (chunks <= 1) {
+    auto run = [&](auto... args) { inner(out, args...); };
+    reduce_run(l, 0, 0, 0, 0, 0, n, run);
+    return;
+  }
+
+  std::vector<Acc> partials(chunks * size, init);
+  parallel_for(0, chunks, 1, [&](size_t first, size_t last) {
+    for (auto c = first; c < last; ++c) {
+      auto part = partials.data() + c * size;
+      auto run = [&](auto... args) { inner(part, args...); };
+      reduce_run(l, 0, 0, 0, 0, c * n / chunks, (c + 1) * n / chunks, run);
+    }
+  });
+
+  for (size_t step = 1; step < chunks; step *= 2)
+    for (size_t c = 0; c + step < chunks; c += 2 * step)
+      for (size_t o = 0; o < size; ++o)
+        partials[c * size + o] = combine(partials[c * size + o], partials[(c + step) * size + o]);
+  for (size_t o = 0; o < size; ++o)
+    out[o] = combine(out[o], partials[o]);
+}
+
+// Lines are summed by blocks in order, combined as a balanced tree
+constexpr size_t pairwise_block = 1024;
+
+// Accumulates a run of a strided line into acc
+template <typename Op, typename Map, typename R, typename T>
+R reduce_block(const T* p, std::ptrdiff_t s, size_t n, R acc) {
+  size_t j = 0;
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<R, compensated<float>> && std::is_same_v<accum_t<T>, float>) {
+    if (s == 1 && n >= IG_PACKET_WIDE) {
+      compensated_packet a;
+      for (; j + IG_PACKET_WIDE <= n; j += IG_PACKET_WIDE)
+        a.add(Map{}(load(p + j)));
+      for (size_t k = 0; k < IG_PACKET_WIDE; ++k) acc += a.s[k], acc.c += a.c[k];
+    }
+  }
+#endif
+  for (; j < n; ++j)
+    acc = Op::run(acc, R(Map{}(p[std::ptrdiff_t(j) * s])));
+  return acc;
+}
+
+// Accumulates a strided line into a single value
+template <typename Op, typename Map, typename R, typename T>
+R reduce_line(const T* p, std::ptrdiff_t s, size_t n, R acc) {
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<R, float> && std::is_same_v<accum_t<T>, float>) {
+    if (s == 1 && n >= 4 * IG_PACKET_WIDE) {
+      // Blocks are combined as packets, lanes are folded once at the end
+      constexpr size_t w = 4 * IG_PACKET_WIDE;
+      auto m = n - n % w;
+      const packet id = Op::template identity<float>();
+      auto a = pairwise_reduce<pairwise_block>(0, m, id, id,
+        [&](size_t first, size_t last, packet a0) {
+          auto a1 = id, a2 = id, a3 = id;
+          for (auto j = first; j < last; j += w)
+            a0 = Op::run(a0, Map{}(load(p + j))),
+            a1 = Op::run(a1, Map{}(load(p + j + IG_PACKET_WIDE))),
+            a2 = Op::run(a2, Map{}(load(p + j + 2 * IG_PACKET_WIDE))),
+            a3 = Op::run(a3, Map{}(load(p + j + 3 * IG_PACKET_WIDE)));
+          return packet(Op::run(Op::run(a0, a1), Op::run(a2, a3)));
+        },
+        [](const packet& x, const packet& y) { return packet(Op::run(x, y)); });
+      for (size_t k = 0; k < IG_PACKET_WIDE; ++k) acc = Op::run(acc, a[k]);
+      return reduce_block<Op, Map>(p + m, 1, n - m, acc);
+    }
+  }
+#endif
+  return pairwise_reduce<pairwise_block>(0, n, acc, Op::template identity<R>(),
+    [&](size_t first, size_t last, const R& a) { return reduce_block<Op, Map>(p + std::ptrdiff_t(first) * s, s, last - first, a); },
+    [](const R& a, const R& b) { return R(Op::run(a, b)); });
+}
+
+// Accumulates a strided line into a line of the output
+template <typename Op, typename Map, typename R, typename T>
+void reduce_lines(const T* p, std::ptrdiff_t s, R* o, std::ptrdiff_t os, size_t n) {
+  size_t j = 0;
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<R, float> && std::is_same_v<accum_t<T>, float>) {
+    if (s == 1 && os == 1)
+      for (; j + IG_PACKET_WIDE <= n; j += IG_PACKET_WIDE)
+        store(o + j, Op::run(load(o + j), Map{}(load(p + j))));
+  }
+#endif
+  for (; j < n; ++j) {
+    auto& r = o[std::ptrdiff_t(j) * os];
+    r = Op::run(r, R(Map{}(p[std::ptrdiff_t(j) * s])));
+  }
+}
+
+// Strided operand of a reduction, expressions without layout are evaluated first
+template <typename Arr, typename Fn>
+auto with_layout(const ndarray_base<Arr>& arr, Fn&& fn) {
+  if constexpr (is_strided<Arr>::value) {
+    return fn(as_view(arr.derived()));
+  } else {
+    const concrete_ndarray<Arr> tmp{arr};
+    return fn(as_view(tmp));
+  }
+}
+
+template <typename Op, typename Map, typename R, typename Arr>
+auto reduce(const ndarray_base<Arr>& arr, const shape_array& axes) {
+  return with_layout(arr, [&](const auto& v) {
+    auto [l, kept] = reduce_plan(v, axes);
+    auto ptr = v.buffer();
+
+    ndarray<R> res{kept};
+    std::fill_n(res.buffer(), res.size(), Op::template identity<R>());
+
+    reduce_parallel(l, res.buffer(), res.size(), Op::template identity<R>(),
+      [ptr](R* out, std::ptrdiff_t in, std::ptrdiff_t o, std::ptrdiff_t, size_t n, std::ptrdiff_t is, std::ptrdiff_t os, std::ptrdiff_t) {
+        if (os == 0)
+          out[o] = Op::run(out[o], reduce_line<Op, Map>(ptr + in, is, n, Op::template identity<R>()));
+        else
+          reduce_lines<Op, Map>(ptr + in, is, out + o, os, n);
+      },
+      [](const R& a, const R& b) { return Op::run(a, b); });
+    return res;
+  });
+}
+
+template <typename T>
+struct arg_entry {
+  T value;
+  size_t index;
+};
+
+// Index of the first extremum, ties are resolved on the logical index so the traversal order does not matter
+template <bool Max, typename Arr>
+auto arg_reduce(const ndarray_base<Arr>& arr, const shape_array& axes) {
+  using value_type = ndarray_t<Arr>;
+  using entry = arg_entry<value_type>;
+
+  auto better = [](const entry& a, const entry& b) {
+    if (a.index == size_t(-1)) return false;
+    if (b.index == size_t(-1)) return true;
+    if (a.value != b.value) return Max ? a.value > b.value : a.value < b.value;
+    return a.index < b.index;
+  };
+
+  return with_layout(arr, [&](const auto& v) {
+    auto [l, kept] = reduce_plan(v, axes);
+    auto ptr = v.buffer();
+
+    entry init{value_type{}, size_t(-1)};
+    std::vector<entry> best(std::accumulate(kept.begin(), kept.end(), size_t(1), std::multiplies<>{}), init);
+
+    reduce_parallel(l, best.data(), best.size(), init,
+      [ptr, &better](entry* out, std::ptrdiff_t in, std::ptrdiff_t o, std::ptrdiff_t id, size_t n, std::ptrdiff_t is, std::ptrdiff_t os, std::ptrdiff_t ix) {
+        for (size_t j = 0; j < n; ++j) {
+          entry e{ptr[in + std::ptrdiff_t(j) * is], size_t(id + std::ptrdiff_t(j) * ix)};
+          auto& r = out[o + std::ptrdiff_t(j) * os];
+          if (better(e, r)) r = e;
+        }
+      },
+      [&better](const entry& a, const entry& b) { return better(b, a) ? b : a; });
+
+    ndarray<size_t> res{kept};
+    for (size_t o = 0; o < best.size(); ++o) res(o) = best[o].index;
+    return res;
+  });
+}
+
+template <typename T>
+using real_t = std::conditional_t<std::is_floating_point_v<T>, T, std::conditional_t<is_half_v<T>, float, double>>;
+
+} // namespace detail
+
+// Reductions along a set of axes produce an ndarray of the kept dimensions, without axes a scalar
+// 16-bit elements are accumulated and returned in float, sums are pairwise and identical for any number of threads
+template <typename Arr> auto sum(const ndarray_base<Arr>& arr, const shape_array& axes) { return detail::reduce<plus_reduce, same_map, accum_t< ndarray_t<Arr> >>(arr, axes); }
+template <typename Arr> auto sum(const ndarray_base<Arr>& arr)                          { return sum(arr, {})(0); }
+
+// Sums of the given accuracy, compensated ones carry the rounding errors of their additions
+template <typename Arr>
+auto sum(const ndarray_base<Arr>& arr, const shape_array& axes, summation mode) {
+  using R = accum_t< ndarray_t<Arr> >;
+  if constexpr (std::is_floating_point_v<R>) {
+    if (mode == summation::compensated)
+      return ndarray<R>{detail::reduce<plus_reduce, same_map, compensated<R>>(arr, axes)};
+  }
+  return sum(arr, axes);
+}
+
+template <typename Arr> auto prod(const ndarray_base<Arr>& arr, const shape_array& axes) { return detail::reduce<times_reduce, same_map, accum_t< ndarray_t<Arr> >>(arr, axes); }
+template <typename Arr> auto prod(const ndarray_base<Arr>& arr)                          { return prod(arr, {})(0); }
+
+template <typename Arr> auto min(const ndarray_base<Arr>& arr, const shape_array& axes) { return detail::reduce<min_reduce, same_map, accum_t< ndarray_t<Arr> >>(arr, axes); }
+template <typename Arr> auto min(const ndarray_base<Arr>& arr)                          { return min(arr, {})(0); }
+
+template <typename Arr> auto max(const ndarray_base<Arr>& arr, const shape_array& axes) { return detail::reduce<max_reduce, same_map, accum_t< ndarray_t<Arr> >>(arr, axes); }
+template <typename Arr> auto max(const ndarray_base<Arr>& arr)                          { return max(arr, {})(0); }
+
+template <typename Arr>
+auto mean(const ndarray_base<Arr>& arr, const shape_array& axes) {
+  using real = detail::real_t< ndarray_t<Arr> >;
+  auto res = detail::reduce<plus_reduce, same_map, real>(arr, axes);
+
+  auto count = axes.empty() ? arr.size() : size_t(1);
+  for (auto a : axes) count *= arr.shape()[a];
+  return ndarray<real>{res / real(count)};
+}
+template <typename Arr> auto mean(const ndarray_base<Arr>& arr) { return mean(arr, {})(0); }
+
+// Euclidean norm
+template <typename Arr>
+auto norm(const ndarray_base<Arr>& arr, const shape_array& axes) {
+  using real = detail::real_t< ndarray_t<Arr> >;
+  auto res = detail::reduce<plus_reduce, square_map, real>(arr, axes);
+  for (size_t o = 0; o < res.size(); ++o) res(o) = std::sqrt(res(o));
+  return res;
+}
+template <typename Arr> auto norm(const ndarray_base<Arr>& arr) { return norm(arr, {})(0); }
+
+// Flat indices (first dimension fastest) of the reduced axes
+template <typename Arr> auto argmax(const ndarray_base<Arr>& arr, const shape_array& axes) { return detail::arg_reduce<true>(arr, axes); }
+template <typename Arr> auto argmax(const ndarray_base<Arr>& arr)                          { return argmax(arr, {})(0); }
+
+template <typename Arr> auto argmin(const ndarray_base<Arr>& arr, const shape_array& axes) { return detail::arg_reduce<false>(arr, axes); }
+template <typename Arr> auto argmin(const ndarray_base<Arr>& arr)                          { return argmin(arr, {})(0); }
+
+// Inclusive prefix scan along an axis
+template <typename Arr, typename Op = std::plus<>>
+auto scan(const ndarray_base<Arr>& arr, size_t axis, Op op = Op{}) {
+  assert(axis < arr.dims() && "Invalid ndarray scan axis");
+
+  concrete_ndarray<Arr> res{arr};
+  auto& shape = res.shape();
+  auto inner = std::accumulate(shape.begin(), shape.begin() + axis, size_t(1), std::multiplies<>{});
+  auto n = shape[axis];
+  auto outer = res.size() / (inner * n);
+  auto p = res.buffer();
+
+  // Blocks of the faster dimensions are combined as whole lines
+  parallel_for(0, outer, std::max<size_t>(1, parallel_grain / (inner * n)), [&](size_t first, size_t last) {
+    for (auto o = first; o < last; ++o) {
+      auto base = p + o * inner * n;
+      if (inner == 1) {
+        for (size_t i = 1; i < n; ++i) base[i] = op(base[i - 1], base[i]);
+      } else {
+        for (size_t i = 1; i < n; ++i) {
+          auto prev = base + (i - 1) * inner, cur = base + i * inner;
+          for (size_t j = 0; j < inner; ++j) cur[j] = op(prev[j], cur[j]);
+        }
+      }
+    }
+  }); return res;
+}
+
+} // namespace nd
+
+template <typename D>
+auto ndarray_base<D>::sum() const -> accum_t<value_type>
+{ return nd::sum(*this); }
+
+template <typename D>
+auto ndarray_base<D>::prod() const -> accum_t<value_type>
+{ return nd::prod(*this); }
+
+} // namespace ig
+
+#endif // IG_MATH_NDARRAYREDUCE_H
@@ -0,0 +1,200 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_NDARRAYTILED_H
+#define IG_MATH_NDARRAYTILED_H
+
+#include "imagine/math/theory/detail/ndarray/base.h"
+#include "imagine/math/theory/detail/ndarray/layout.h"
+#include <vector>
+
+namespace ig {
+
+template <typename T> class tiled;
+
+template <typename T>
+struct ndarray_traits
+<
+  tiled<T>
+>
+{
+  using value_type = T;
+};
+
+namespace nd {
+
+// bricks: blocks of edge^d elements stored one after the other, bricks and their elements first dimension fastest
+// morton: interleaved coordinate bits (Z-order), each dimension padded to a power of two
+struct tiling {
+  enum class curve { bricks, morton };
+
+  curve order;
+  size_t edge;
+};
+
+constexpr auto bricks(size_t edge = 8) { return tiling{tiling::curve::bricks, edge}; }
+constexpr auto morton()                { return tiling{tiling::curve::morton, 0}; }
+
+// Run of elements along the first dimension, scattered through the offsets of the layout
+template <typename T>
+struct tiled_line {
+  decltype(auto) operator[](size_t j) const { return ptr[offsets[j]]; }
+
+  T* ptr;
+  const size_t* offsets;
+};
+
+} // namespace nd
+
+// Both layouts are separable, the offset of an element is the sum of one table entry per dimension
+template <typename t_>
+class tiled : public ndarray_base< tiled<t_> > {
+public:
+  using value_type = t_;
+
+  explicit tiled(const nd::shape_array& shape, const nd::tiling& tiling = nd::bricks(), value_type value = {});
+
+  template <typename Arr>
+  explicit tiled(const ndarray_base<Arr>& o, const nd::tiling& tiling = nd::bricks())
+    : tiled{nd::shape_array{o.shape().begin(), o.shape().end()}, tiling}
+  { eval_helper(*this, o); }
+
+  template <typename Arr>
+  tiled& operator=(const ndarray_base<Arr>& o) { eval_helper(*this, o); return *this; }
+
+  auto size() const { return size_; }
+  auto dims() const { return shape_.size(); }
+  auto& shape() const  { return shape_; }
+  auto& tiling() const { return tiling_; }
+
+  // Elements including the padding of the last bricks
+  auto capacity() const { return buffer_.size(); }
+  auto buffer() const { return buffer_.data(); }
+  auto buffer()       { return buffer_.data(); }
+
+  template <typename... Id> decltype(auto) operator()(Id... ids) const { return buffer_[at(ids...)]; }
+  template <typename... Id> decltype(auto) operator()(Id... ids)       { return buffer_[at(ids...)]; }
+
+  auto line(size_t r) const { return nd::tiled_line<const value_type>{buffer_.data() + outer(r), offsets_.data()}; }
+  auto line(size_t r)       { return nd::tiled_line<value_type>      {buffer_.data() + outer(r), offsets_.data()}; }
+
+private:
+  size_t flat(size_t i) const;
+  size_t outer(size_t r) const;
+  template <typename... Id>
+  size_t at(Id... ids) const {
+    if constexpr (sizeof...(Id) == 1) {
+      return flat(size_t(ids)...);
+    } else {
+      assert(sizeof...(Id) == dims() && "Invalid tiled ndarray subscript");
+      size_t is[] = {size_t(ids)...}, off = 0;
+      for (size_t k = 0; k < sizeof...(Id); ++k) off += table(k)[is[k]];
+      return off;
+    }
+  }
+
+  auto table(size_t k) const { return offsets_.data() + bases_[k]; }
+
+  nd::shape_array shape_;
+  nd::tiling tiling_;
+  size_t size_;
+
+  nd::shape_array bases_;
+  std::vector<size_t> offsets_;
+  std::vector<value_type> buffer_;
+};
+
+template <typename t_>
+tiled<t_>::tiled(const nd::shape_array& shape, const nd::tiling& tiling, value_type value)
+  : shape_{shape}
+  , tiling_{tiling}
+  , size_{
+    std::accumulate(
+      shape.begin(),
+      shape.end(),
+      size_t(1),
+      std::multiplies<>{})} {
+  for (auto n : shape_)
+    bases_.push_back(offsets_.size()),
+    offsets_.resize(offsets_.size() + n);
+
+  size_t capacity = 1;
+  if (tiling_.order == nd::tiling::curve::bricks) {
+    assert(tiling_.edge > 0 && "Invalid ndarray brick edge");
+
+    // Bricks are clamped to small dimensions, so planar data is not padded along its missing depth
+    size_t volume = 1, grid = 1;
+    nd::shape_array edges, inner;
+    for (auto n : shape_)
+      edges.push_back(std::min(tiling_.edge, n)),
+      inner.push_back(volume),
+      volume *= edges[edges.size() - 1];
+
+    for (size_t k = 0; k < dims(); ++k) {
+      auto e = edges[k];
+      for (size_t x = 0; x < shape_[k]; ++x)
+        offsets_[bases_[k] + x] = (x / e) * grid * volume + (x % e) * inner[k];
+      grid *= (shape_[k] + e - 1) / e;
+    } capacity = grid * volume;
+  } else {
+    nd::shape_array bits;
+    for (auto n : shape_) {
+      size_t b = 0;
+      while ((size_t(1) << b) < n) ++b;
+      bits.push_back(b),
+      capacity <<= b;
+    }
+
+    // Bit levels are dealt in turn to every dimension that still has some
+    size_t pos = 0;
+    auto top = bits.empty() ? 0 : *std::max_element(bits.begin(), bits.end());
+    for (size_t b = 0; b < top; ++b)
+      for (size_t k = 0; k < dims(); ++k) {
+        if (b >= bits[k]) continue;
+        for (size_t x = 0; x < shape_[k]; ++x)
+          offsets_[bases_[k] + x] |= ((x >> b) & 1) << pos;
+        ++pos;
+      }
+  }
+
+  buffer_.assign(capacity, value);
+}
+
+template <typename t_>
+size_t tiled<t_>::flat(size_t i) const {
+  assert(i < size_ && "Invalid tiled ndarray subscript");
+
+  size_t off = 0;
+  for (size_t k = 0; k < dims(); ++k)
+    off += table(k)[i % shape_[k]],
+    i /= shape_[k];
+  return off;
+}
+
+template <typename t_>
+size_t tiled<t_>::outer(size_t r) const {
+  size_t off = 0;
+  for (size_t k = 1; k < dims(); ++k)
+    off += table(k)[r % shape_[k]],
+    r /= shape_[k];
+  return off;
+}
+
+namespace nd {
+
+// Conversions between linear and tiled layouts, evaluated line by line across the job pool
+template <typename Arr>
+auto tile(const ndarray_base<Arr>& arr, const tiling& tiling = bricks())
+{ return tiled< ndarray_t<Arr> >{arr, tiling}; }
+
+template <typename T>
+auto linear(const tiled<T>& arr)
+{ return ndarray<T>{arr}; }
+
+} // namespace nd
+} // namespace ig
+
+#endif // IG_MATH_NDARRAYTILED_H
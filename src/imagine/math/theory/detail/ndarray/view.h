@@ -0,0 +1,247 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_NDARRAYVIEW_H
+#define IG_MATH_NDARRAYVIEW_H
+
+#include "imagine/math/theory/detail/ndarray/base.h"
+#include "imagine/math/theory/detail/ndarray/layout.h"
+
+namespace ig {
+
+template <typename Arr>
+struct ndarray_traits
+<
+  view<Arr>
+>
+{
+  using value_type = ndarray_t<Arr>;
+};
+
+// Strided window over the buffer of an ndarray, copies are shallow and assignments are element-wise
+template <typename a_>
+class view : public ndarray_base< view<a_> > {
+public:
+  using value_type = ndarray_t<a_>;
+  using pointer = std::conditional_t<std::is_const_v<a_>, const value_type*, value_type*>;
+
+  explicit view(pointer data, const nd::shape_array& shape, const nd::stride_array& strides)
+    : data_{data}
+    , shape_{shape}
+    , strides_{strides}
+    , size_{
+      std::accumulate(
+        shape_.begin(),
+        shape_.end(),
+        size_t(1),
+        std::multiplies<>{})}
+    , contiguous_{is_dense()} {}
+
+  explicit view(a_& arr) : view{arr.buffer(), arr.shape()} {}
+
+  view(const view& o) = default;
+  view& operator=(const view& o) { eval_helper(*this, o); return *this; }
+
+  template <typename Arr>
+  view& operator=(const ndarray_base<Arr>& o) { eval_helper(*this, o); return *this; }
+  view& operator=(value_type value);
+
+  auto size() const { return size_; }
+  auto dims() const { return shape_.size(); }
+  auto& shape() const   { return shape_; }
+  auto& strides() const { return strides_; }
+
+  auto buffer() const { return data_; }
+  auto contiguous() const { return contiguous_; }
+
+  template <typename... Id> decltype(auto) operator()(Id... ids) const { return static_cast<const value_type&>(data_[at(ids...)]); }
+  template <typename... Id> decltype(auto) operator()(Id... ids)       { return data_[at(ids...)]; }
+
+  auto line(size_t r) const { return nd::line<const value_type>{data_ + outer(r), contiguous_ ? 1 : strides_[0]}; }
+  auto line(size_t r)       { return nd::line<value_type>      {data_ + outer(r), contiguous_ ? 1 : strides_[0]}; }
+
+  auto slice(size_t axis, size_t index) const -> view;
+  auto range(size_t axis, size_t first, size_t last, size_t step = 1) const -> view;
+  auto permute(const nd::shape_array& axes) const -> view;
+  auto transpose() const -> view;
+  auto reshape(const nd::shape_array& shape) const -> view;
+  auto broadcast(const nd::shape_array& shape) const -> view;
+
+private:
+  template <typename Shape>
+  explicit view(pointer data, const Shape& shape)
+    : view{data, nd::shape_array{shape.begin(), shape.end()}, nd::dense_strides(shape)} {}
+
+  bool is_dense() const;
+
+  // Flat indices are unravelled with the first dimension as the fastest
+  std::ptrdiff_t flat(size_t i) const;
+  std::ptrdiff_t outer(size_t r) const;
+  template <typename... Id>
+  std::ptrdiff_t at(Id... ids) const {
+    if constexpr (sizeof...(Id) == 1) {
+      return flat(size_t(ids)...);
+    } else {
+      assert(sizeof...(Id) == dims() && "Invalid ndarray view subscript");
+      std::ptrdiff_t is[] = {std::ptrdiff_t(ids)...}, off = 0;
+      for (size_t k = 0; k < sizeof...(Id); ++k) off += strides_[k] * is[k];
+      return off;
+    }
+  }
+
+  pointer data_;
+  nd::shape_array shape_;
+  nd::stride_array strides_;
+  size_t size_;
+  bool contiguous_;
+};
+
+template <typename a_>
+auto view<a_>::operator=(value_type value) -> view& {
+  for (size_t i = 0; i < size_; ++i)
+    (*this)(i) = value;
+  return *this;
+}
+
+template <typename a_>
+bool view<a_>::is_dense() const {
+  auto dense = nd::dense_strides(shape_);
+  for (size_t k = 0; k < dims(); ++k)
+    if (shape_[k] > 1 && strides_[k] != dense[k]) return false;
+  return true;
+}
+
+template <typename a_>
+std::ptrdiff_t view<a_>::flat(size_t i) const {
+  assert(i < size_ && "Invalid ndarray view subscript");
+  if (contiguous_)
+    return std::ptrdiff_t(i);
+
+  std::ptrdiff_t off = 0;
+  for (size_t k = 0; k < dims(); ++k)
+    off += std::ptrdiff_t(i % shape_[k]) * strides_[k],
+    i /= shape_[k];
+  return off;
+}
+
+template <typename a_>
+std::ptrdiff_t view<a_>::outer(size_t r) const {
+  if (contiguous_)
+    return std::ptrdiff_t(r * shape_[0]);
+
+  std::ptrdiff_t off = 0;
+  for (size_t k = 1; k < dims(); ++k)
+    off += std::ptrdiff_t(r % shape_[k]) * strides_[k],
+    r /= shape_[k];
+  return off;
+}
+
+template <typename a_>
+auto view<a_>::slice(size_t axis, size_t index) const -> view {
+  assert(
+    axis < dims() &&
+    index < shape_[axis] &&
+    dims() > 1
+    && "Invalid ndarray slice");
+
+  auto shape = shape_; shape.erase(axis);
+  auto strides = strides_; strides.erase(axis);
+  return view{data_ + strides_[axis] * std::ptrdiff_t(index), shape, strides};
+}
+
+template <typename a_>
+auto view<a_>::range(size_t axis, size_t first, size_t last, size_t step) const -> view {
+  assert(
+    axis < dims() &&
+    first < last &&
+    last <= shape_[axis] &&
+    step > 0
+    && "Invalid ndarray range");
+
+  auto shape = shape_; shape[axis] = (last - first + step - 1) / step;
+  auto strides = strides_; strides[axis] *= std::ptrdiff_t(step);
+  return view{data_ + strides_[axis] * std::ptrdiff_t(first), shape, strides};
+}
+
+template <typename a_>
+auto view<a_>::permute(const nd::shape_array& axes) const -> view {
+  assert(axes.size() == dims() && "Invalid ndarray permutation");
+
+  nd::shape_array shape;
+  nd::stride_array strides;
+  for (auto a : axes)
+    shape.push_back(shape_[a]),
+    strides.push_back(strides_[a]);
+  return view{data_, shape, strides};
+}
+
+template <typename a_>
+auto view<a_>::transpose() const -> view {
+  auto shape = shape_;
+  auto strides = strides_;
+  std::reverse(shape.begin(), shape.end());
+  std::reverse(strides.begin(), strides.end());
+  return view{data_, shape, strides};
+}
+
+template <typename a_>
+auto view<a_>::reshape(const nd::shape_array& shape) const -> view {
+  assert(
+    contiguous_ &&
+    std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<>{}) == size_
+    && "Invalid ndarray reshape, view must be contiguous with the same size");
+  return view{data_, shape, nd::dense_strides(shape)};
+}
+
+// Dimensions of extent one, and missing trailing dimensions, are repeated with a zero stride
+template <typename a_>
+auto view<a_>::broadcast(const nd::shape_array& shape) const -> view {
+  assert(dims() <= shape.size() && "Invalid ndarray broadcasting, too many dimensions");
+
+  nd::stride_array strides(shape.size(), 0);
+  for (size_t k = 0; k < dims(); ++k) {
+    assert(
+      (shape_[k] == shape[k] || shape_[k] == 1) &&
+      "Invalid ndarray broadcasting, dimensions must be either equal or one of them must be one");
+    if (shape_[k] == shape[k]) strides[k] = strides_[k];
+  } return view{data_, shape, strides};
+}
+
+namespace nd {
+
+template <typename Xpr>                struct is_strided                    : std::false_type {};
+template <typename T, size_t... D>     struct is_strided< ndarray<T, D...> > : std::true_type {};
+template <typename Arr>                struct is_strided< view<Arr> >        : std::true_type {};
+
+template <typename T, size_t... D> auto as_view(ndarray<T, D...>& arr)       { return view< ndarray<T, D...> >{arr}; }
+template <typename T, size_t... D> auto as_view(const ndarray<T, D...>& arr) { return view< const ndarray<T, D...> >{arr}; }
+template <typename T, size_t... D> auto as_view(ndarray<T, D...>&& arr) = delete;
+template <typename Arr>            auto as_view(const view<Arr>& v)          { return v; }
+
+template <typename Arr>
+auto slice(Arr&& arr, size_t axis, size_t index)
+{ return as_view(std::forward<Arr>(arr)).slice(axis, index); }
+
+template <typename Arr>
+auto range(Arr&& arr, size_t axis, size_t first, size_t last, size_t step = 1)
+{ return as_view(std::forward<Arr>(arr)).range(axis, first, last, step); }
+
+template <typename Arr>
+auto permute(Arr&& arr, const shape_array& axes)
+{ return as_view(std::forward<Arr>(arr)).permute(axes); }
+
+template <typename Arr>
+auto transpose(Arr&& arr)
+{ return as_view(std::forward<Arr>(arr)).transpose(); }
+
+template <typename Arr>
+auto reshape(Arr&& arr, const shape_array& shape)
+{ return as_view(std::forward<Arr>(arr)).reshape(shape); }
+
+} // namespace nd
+} // namespace ig
+
+#endif // IG_MATH_NDARRAYVIEW_H
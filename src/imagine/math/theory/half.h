@@ -0,0 +1,276 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_HALF_H
+#define IG_MATH_HALF_H
+
+#include "imagine/math/theory/simd_accel/intrinsics.h"
+
+#include <cstring>
+#include <limits>
+
+namespace ig     {
+namespace detail {
+
+inline auto float_bits(float f) { uint32_t u; std::memcpy(&u, &f, sizeof(u)); return u; }
+inline auto bits_float(uint32_t u) { float f; std::memcpy(&f, &u, sizeof(f)); return f; }
+
+// IEEE 754 binary16, rounded to nearest even
+inline float half_to_float(uint16_t h) {
+#if defined(__F16C__)
+  return _cvtsh_ss(h);
+#else
+  uint32_t sign = uint32_t(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1f, man = h & 0x3ff;
+  if (exp == 0x1f) return bits_float(sign | 0x7f800000 | (man << 13));
+  if (exp != 0)    return bits_float(sign | ((exp + 112) << 23) | (man << 13));
+
+  // Subnormals are exact in single precision
+  return bits_float(sign) + (sign ? -1.f : 1.f) * float(man) * 5.9604644775390625e-8f;
+#endif
+}
+
+inline uint16_t float_to_half(float f) {
+#if defined(__F16C__)
+  return _cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT);
+#else
+  auto u = float_bits(f);
+  auto sign = uint16_t((u >> 16) & 0x8000);
+  u &= 0x7fffffff;
+
+  // Overflows are infinite and nans stay quiet
+  if (u >= (143u << 23))
+    return sign | (u > 0x7f800000 ? 0x7e00 : 0x7c00);
+
+  // Below the normal range, the float addition rounds the mantissa in place
+  if (u < (113u << 23))
+    return sign | uint16_t(float_bits(bits_float(u) + 0.5f) - 0x3f000000);
+
+  u += ((15u - 127u) << 23) + 0xfff + ((u >> 13) & 1);
+  return sign | uint16_t(u >> 13);
+#endif
+}
+
+// Upper half of binary32, rounded to nearest even
+inline float bfloat_to_float(uint16_t b) { return bits_float(uint32_t(b) << 16); }
+inline uint16_t float_to_bfloat(float f) {
+  auto u = float_bits(f);
+  if ((u & 0x7fffffff) > 0x7f800000)
+    return uint16_t((u >> 16) | 0x40);
+  return uint16_t((u + 0x7fff + ((u >> 16) & 1)) >> 16);
+}
+
+} // namespace detail
+
+// 16-bit storage types, arithmetic promotes to float and assignments round back
+// float16: 5 exponent bits, 10 mantissa bits, max 65504
+// bfloat16: 8 exponent bits, 7 mantissa bits, the range of float
+struct float16 {
+  float16() = default;
+  explicit float16(float f) : bits{detail::float_to_half(f)} {}
+  float16& operator=(float f) { bits = detail::float_to_half(f); return *this; }
+
+  float16& operator+=(float f) { return *this = float(*this) + f; }
+  float16& operator-=(float f) { return *this = float(*this) - f; }
+  float16& operator*=(float f) { return *this = float(*this) * f; }
+  float16& operator/=(float f) { return *this = float(*this) / f; }
+
+  operator float() const { return detail::half_to_float(bits); }
+
+  static auto from_bits(uint16_t b) { float16 h; h.bits = b; return h; }
+
+  uint16_t bits;
+};
+
+struct bfloat16 {
+  bfloat16() = default;
+  explicit bfloat16(float f) : bits{detail::float_to_bfloat(f)} {}
+  bfloat16& operator=(float f) { bits = detail::float_to_bfloat(f); return *this; }
+
+  bfloat16& operator+=(float f) { return *this = float(*this) + f; }
+  bfloat16& operator-=(float f) { return *this = float(*this) - f; }
+  bfloat16& operator*=(float f) { return *this = float(*this) * f; }
+  bfloat16& operator/=(float f) { return *this = float(*this) / f; }
+
+  operator float() const { return detail::bfloat_to_float(bits); }
+
+  static auto from_bits(uint16_t b) { bfloat16 h; h.bits = b; return h; }
+
+  uint16_t bits;
+};
+
+template <typename T> struct is_half : std::false_type {};
+template <>           struct is_half<float16>  : std::true_type {};
+template <>           struct is_half<bfloat16> : std::true_type {};
+template <typename T> constexpr bool is_half_v = is_half<std::remove_cv_t<T>>::value;
+
+// Accumulators of 16-bit elements are float
+template <typename T> using accum_t = std::conditional_t<is_half_v<T>, float, T>;
+
+namespace detail {
+
+template <typename H>
+struct half_limits {
+  static constexpr bool is_specialized = true;
+  static constexpr bool is_signed = true;
+  static constexpr bool is_integer = false;
+  static constexpr bool is_exact = false;
+  static constexpr bool has_infinity = true;
+  static constexpr bool has_quiet_NaN = true;
+  static constexpr std::float_round_style round_style = std::round_to_nearest;
+};
+
+} // namespace detail
+
+namespace nd {
+
+#if defined(IG_SSE)
+
+// Four elements to and from the lower half of a register
+inline auto half4(const float16* p) {
+  auto v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+#if defined(__F16C__)
+  return _mm_cvtph_ps(v);
+#else
+  alignas(16) uint16_t h[8]; _mm_store_si128(reinterpret_cast<__m128i*>(h), v);
+  return _mm_set_ps(detail::half_to_float(h[3]), detail::half_to_float(h[2]), detail::half_to_float(h[1]), detail::half_to_float(h[0]));
+#endif
+}
+
+inline auto half4(const bfloat16* p) {
+  auto v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+  return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), v));
+}
+
+inline auto half8(const bfloat16* p) {
+  auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  auto z = _mm_setzero_si128();
+  return std::make_pair(
+    _mm_castsi128_ps(_mm_unpacklo_epi16(z, v)),
+    _mm_castsi128_ps(_mm_unpackhi_epi16(z, v)));
+}
+
+// Rounded upper halves of four floats in the lower 64 bits, quiet nans are kept
+inline auto bfloat4(__m128 f) {
+  auto u = _mm_castps_si128(f);
+  auto odd = _mm_and_si128(_mm_srli_epi32(u, 16), _mm_set1_epi32(1));
+  auto r = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(0x7fff)), odd), 16);
+  auto nan = _mm_castps_si128(_mm_cmpunord_ps(f, f));
+  r = _mm_or_si128(
+    _mm_andnot_si128(nan, r),
+    _mm_and_si128(nan, _mm_or_si128(_mm_srli_epi32(u, 16), _mm_set1_epi32(0x40))));
+
+  // Sign extension keeps the signed saturation of the pack exact
+  r = _mm_srai_epi32(_mm_slli_epi32(r, 16), 16);
+  return _mm_packs_epi32(r, r);
+}
+
+inline auto load(const float16* p) {
+#if defined(IG_AVX)
+# if defined(__F16C__)
+  return packet{_mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))};
+# else
+  return packet{_mm256_set_m128(half4(p + 4), half4(p))};
+# endif
+#else
+  return packet{half4(p)};
+#endif
+}
+
+inline auto load(const bfloat16* p) {
+#if defined(IG_AVX)
+  auto [lo, hi] = half8(p);
+  return packet{_mm256_set_m128(hi, lo)};
+#else
+  return packet{half4(p)};
+#endif
+}
+
+inline void store(float16* p, const packet& v) {
+#if defined(IG_AVX) && defined(__F16C__)
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+#elif defined(__F16C__)
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+#else
+  for (size_t k = 0; k < IG_PACKET_WIDE; ++k) p[k] = v[k];
+#endif
+}
+
+inline void store(bfloat16* p, const packet& v) {
+#if defined(IG_AVX)
+  auto lo = bfloat4(_mm256_castps256_ps128(v)), hi = bfloat4(_mm256_extractf128_ps(v, 1));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_unpacklo_epi64(lo, hi));
+#else
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(p), bfloat4(v));
+#endif
+}
+
+#endif
+
+// Bulk conversions, a packet at a time
+template <typename H>
+void convert(const H* src, float* dst, size_t n) {
+  static_assert(is_half_v<H>, "Invalid conversion, expected a 16-bit element type");
+  size_t j = 0;
+#if defined(IG_SSE)
+  for (; j + IG_PACKET_WIDE <= n; j += IG_PACKET_WIDE) {
+    auto v = load(src + j);
+# if defined(IG_AVX)
+    _mm256_storeu_ps(dst + j, v);
+# else
+    _mm_storeu_ps(dst + j, v);
+# endif
+  }
+#endif
+  for (; j < n; ++j) dst[j] = src[j];
+}
+
+template <typename H>
+void convert(const float* src, H* dst, size_t n) {
+  static_assert(is_half_v<H>, "Invalid conversion, expected a 16-bit element type");
+  size_t j = 0;
+#if defined(IG_SSE)
+  for (; j + IG_PACKET_WIDE <= n; j += IG_PACKET_WIDE) {
+# if defined(IG_AVX)
+    store(dst + j, packet{_mm256_loadu_ps(src + j)});
+# else
+    store(dst + j, packet{_mm_loadu_ps(src + j)});
+# endif
+  }
+#endif
+  for (; j < n; ++j) dst[j] = src[j];
+}
+
+} // namespace nd
+} // namespace ig
+
+namespace std {
+
+template <>
+struct numeric_limits<ig::float16> : ig::detail::half_limits<ig::float16> {
+  static constexpr int digits = 11;
+  static auto min()       { return ig::float16::from_bits(0x0400); }
+  static auto max()       { return ig::float16::from_bits(0x7bff); }
+  static auto lowest()    { return ig::float16::from_bits(0xfbff); }
+  static auto epsilon()   { return ig::float16::from_bits(0x1400); }
+  static auto infinity()  { return ig::float16::from_bits(0x7c00); }
+  static auto quiet_NaN() { return ig::float16::from_bits(0x7e00); }
+};
+
+template <>
+struct numeric_limits<ig::bfloat16> : ig::detail::half_limits<ig::bfloat16> {
+  static constexpr int digits = 8;
+  static auto min()       { return ig::bfloat16::from_bits(0x0080); }
+  static auto max()       { return ig::bfloat16::from_bits(0x7f7f); }
+  static auto lowest()    { return ig::bfloat16::from_bits(0xff7f); }
+  static auto epsilon()   { return ig::bfloat16::from_bits(0x3c00); }
+  static auto infinity()  { return ig::bfloat16::from_bits(0x7f80); }
+  static auto quiet_NaN() { return ig::bfloat16::from_bits(0x7fc0); }
+};
+
+} // namespace std
+
+#endif // IG_MATH_HALF_H
@@ -22,6 +22,8 @@
 #include "imagine/math/theory/detail/matrix/expr/trans.h"
 #include "imagine/math/theory/detail/matrix/expr/relational.h"
 
+#include "imagine/core/mem/arena.h"
+
 namespace ig {
 
 template
@@ -109,8 +111,8 @@ public:
 private:
   using container_type = std::conditional_t
     < hybrid,
-      std::vector<value_type>,
-      std::array <value_type, m_ * n_>
+      arena_vector<value_type>,
+      std::array  <value_type, m_ * n_>
     >;
 
   struct dynamic_data {
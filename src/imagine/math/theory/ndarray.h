@@ -8,12 +8,16 @@
 #define IG_MATH_NDARRAY_H
 
 #include "imagine/math/theory/detail/ndarray/base.h"
+#include "imagine/math/theory/detail/ndarray/view.h"
+#include "imagine/math/theory/detail/ndarray/tiled.h"
 
 #include "imagine/math/theory/detail/ndarray/expr/cast.h"
 #include "imagine/math/theory/detail/ndarray/expr/wise.h"
+#include "imagine/math/theory/detail/ndarray/eval.h"
 
 #include "imagine/math/theory/detail/ndarray/allocator/static.h"
 #include "imagine/math/theory/detail/ndarray/allocator/dynamic.h"
+#include "imagine/math/theory/detail/ndarray/allocator/mmap.h"
 
 namespace ig {
 
@@ -48,16 +52,32 @@ public:
   constexpr explicit ndarray(std::initializer_list<size_t> dims)
     : storage_{{dims}} {}
 
+  template
+  < bool X = dynamic,
+    typename = std::enable_if_t<X> >
+  constexpr explicit ndarray(const nd::shape_array& shape)
+    : storage_{shape} {}
+
+  template
+  < bool X = dynamic,
+    typename = std::enable_if_t<X> >
+  explicit ndarray(nd::dynamic_storage<value_type>&& storage)
+    : storage_{std::move(storage)} {}
+
   template <typename Arr>
   ndarray(const ndarray_base<Arr>& o) : ndarray{o, o.shape(), std::integral_constant<bool, immutable>{}}
   { eval_helper(*this, o); }
 
   template <typename Arr, typename Shape> ndarray(const ndarray_base<Arr>& o, const Shape& shape, std::true_type) {}
   template <typename Arr, typename Shape> ndarray(const ndarray_base<Arr>& o, const Shape& shape, std::false_type)
-  : storage_{{
+  : storage_{nd::shape_array{
     shape.begin(),
     shape.end  ()}} {}
 
+  // Mapped arrays are evaluated in place, the others are rebuilt from the expression
+  template <typename Arr>
+  ndarray& operator=(const ndarray_base<Arr>& o);
+
   auto size() const { return storage_.size(); }
   auto dims() const { return storage_.dims(); }
   auto shape() const -> decltype(auto) { return storage_.shape(); }
@@ -71,6 +91,10 @@ public:
   template <typename... Id> decltype(auto) operator()(Id... ids) const { return storage_(layout(ids...)); }
   template <typename... Id> decltype(auto) operator()(Id... ids)       { return storage_(layout(ids...)); }
 
+  auto line(size_t r) const { return nd::line<const value_type>{buffer() + r * shape()[0], 1}; }
+  auto line(size_t r)       { return nd::line<value_type>      {buffer() + r * shape()[0], 1}; }
+  constexpr auto contiguous() const { return true; }
+
 protected:
   template <typename... Id>
   auto layout(Id... ids) const
@@ -83,6 +107,21 @@ protected:
   > storage_;
 };
 
+template <typename t_, size_t... d_>
+template <typename Arr>
+auto ndarray<t_, d_...>::operator=(const ndarray_base<Arr>& o) -> ndarray& {
+  if constexpr (dynamic) {
+    if (storage_.external() && dims() == o.dims() && size() == o.size()) {
+      eval_helper(*this, o);
+      return *this;
+    }
+  } return *this = ndarray{o};
+}
+
 } // namespace ig
 
+// Reductions and contractions build concrete ndarrays
+#include "imagine/math/theory/detail/ndarray/reduce.h"
+#include "imagine/math/theory/detail/ndarray/einsum.h"
+
 #endif // IG_MATH_NDARRAY_H
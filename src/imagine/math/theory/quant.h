@@ -0,0 +1,117 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_QUANT_H
+#define IG_MATH_QUANT_H
+
+#include "imagine/math/theory/ndarray.h"
+#include "imagine/math/theory/detail/gemm.h"
+
+namespace ig {
+
+// Symmetric int8 tensor, x = scale * q with q in [-127, 127]
+// one scale for the whole tensor, or one per index along an axis (the output channels of weights)
+struct quantized {
+  ndarray<int8_t> values;
+  std::vector<float> scales;
+  size_t axis = 0;
+
+  auto& shape() const { return values.shape(); }
+  auto scale(size_t i) const { return scales.size() == 1 ? scales[0] : scales[i]; }
+  auto stride() const { return scales.size() == 1 ? std::ptrdiff_t(0) : std::ptrdiff_t(1); }
+};
+
+namespace detail {
+
+inline auto quant_scale(float amax) { return amax > 0.f ? amax / 127.f : 1.f; }
+inline auto quant_round(float x, float inv) { return int8_t(std::clamp(std::nearbyint(x * inv), -127.f, 127.f)); }
+
+// Index along the axis of every element, first dimension fastest
+inline auto quant_channels(const nd::shape_array& shape, size_t axis) {
+  auto inner = std::accumulate(shape.begin(), shape.begin() + std::ptrdiff_t(axis), size_t(1), std::multiplies<>{});
+  return std::make_pair(inner, shape[axis]);
+}
+
+} // namespace detail
+
+// Per tensor quantization, the scale maps the largest magnitude on 127
+template <typename Arr>
+auto quantize(const ndarray_base<Arr>& arr) {
+  const ndarray<float> x{arr};
+  float amax = 0.f;
+  for (size_t i = 0; i < x.size(); ++i) amax = std::max(amax, std::abs(x(i)));
+
+  quantized q{ndarray<int8_t>{x.shape()}, {detail::quant_scale(amax)}, 0};
+  auto inv = 1.f / q.scales[0];
+  for (size_t i = 0; i < x.size(); ++i) q.values(i) = detail::quant_round(x(i), inv);
+  return q;
+}
+
+// Per channel quantization along an axis
+template <typename Arr>
+auto quantize(const ndarray_base<Arr>& arr, size_t axis) {
+  assert(axis < arr.dims() && "Invalid quantization axis");
+
+  const ndarray<float> x{arr};
+  auto [inner, n] = detail::quant_channels(x.shape(), axis);
+  std::vector<float> amax(n, 0.f);
+  for (size_t i = 0; i < x.size(); ++i) {
+    auto& m = amax[(i / inner) % n];
+    m = std::max(m, std::abs(x(i)));
+  }
+
+  quantized q{ndarray<int8_t>{x.shape()}, std::vector<float>(n), axis};
+  std::vector<float> inv(n);
+  for (size_t c = 0; c < n; ++c)
+    q.scales[c] = detail::quant_scale(amax[c]),
+    inv[c] = 1.f / q.scales[c];
+  for (size_t i = 0; i < x.size(); ++i) q.values(i) = detail::quant_round(x(i), inv[(i / inner) % n]);
+  return q;
+}
+
+inline auto dequantize(const quantized& q) {
+  ndarray<float> x{q.shape()};
+  auto [inner, n] = detail::quant_channels(q.shape(), q.axis);
+  for (size_t i = 0; i < x.size(); ++i) x(i) = q.scale((i / inner) % n) * float(q.values(i));
+  return x;
+}
+
+namespace detail {
+
+template <typename Out>
+void quant_matmul(const quantized& a, const quantized& b, const qgemm_scales& s, Out* out) {
+  assert(a.values.dims() == 2 && b.values.dims() == 2 && a.shape()[1] == b.shape()[0] && "Invalid quantized product, incoherent matrix dimensions");
+  assert((a.scales.size() == 1 || a.axis == 0) && (b.scales.size() == 1 || b.axis == 1) && "Invalid quantized product, scales must be per row of a and per column of b");
+
+  auto m = a.shape()[0], k = a.shape()[1], n = b.shape()[1];
+  qgemm(m, n, k,
+    gemm_operand<const int8_t>{a.values.buffer(), 1, std::ptrdiff_t(m)},
+    gemm_operand<const int8_t>{b.values.buffer(), 1, std::ptrdiff_t(k)},
+    s,
+    gemm_operand<Out>{out, 1, std::ptrdiff_t(m)});
+}
+
+} // namespace detail
+
+// Product of quantized matrices (m, k) and (k, n), a has scales per row or per tensor and b per column or per tensor
+inline auto matmul(const quantized& a, const quantized& b) {
+  ndarray<float> c{a.shape()[0], b.shape()[1]};
+  detail::quant_matmul(a, b, {a.scales.data(), a.stride(), b.scales.data(), b.stride()}, c.buffer());
+  return c;
+}
+
+// Product requantized at the scale of the output
+inline auto matmul(const quantized& a, const quantized& b, float out) {
+  quantized c{ndarray<int8_t>{a.shape()[0], b.shape()[1]}, {out}, 0};
+  qgemm_scales s{a.scales.data(), a.stride(), b.scales.data(), b.stride()};
+  s.out = out;
+  detail::quant_matmul(a, b, s, c.values.buffer());
+  return c;
+}
+
+} // namespace ig
+
+#endif // IG_MATH_QUANT_H
@@ -12,15 +12,13 @@
 #include "imagine/math/theory/simd_accel/sse_b.h"
 #include "imagine/math/theory/simd_accel/sse_f.h"
 #include "imagine/math/theory/simd_accel/sse_i.h"
+#include "imagine/math/theory/simd_accel/sse_d.h"
 
 #include "imagine/math/theory/simd_accel/avx_b.h"
 #include "imagine/math/theory/simd_accel/avx_f.h"
+#include "imagine/math/theory/simd_accel/avx_d.h"
 #if defined(__AVX2__)
 #include "imagine/math/theory/simd_accel/avx_i.h"
 #endif
 
-//
-// AVX packet
-using packet = ig::float8;
-
 #endif // IG_MATH_AVX_H
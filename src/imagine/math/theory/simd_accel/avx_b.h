@@ -80,6 +80,46 @@ auto shuffle(const bool8& v, const bool8& t)
 //
 }
 
+// Masks of double lanes
+struct bool4d {
+  bool4d() = default;
+  bool4d(__m256d in) : d{in} {}
+  bool4d(bool x)     : d{x ? _mm256_castsi256_pd(_mm256_set1_epi32(-1)) : _mm256_setzero_pd()} {}
+
+  auto& operator[](size_t n) const
+  { return d.p[n]; }
+  auto& operator[](size_t n)
+  { return d.p[n]; }
+
+  operator const __m256d&() const { return d.v; }
+  operator       __m256d&()       { return d.v; }
+
+  simd_data
+  < __m256d,
+    int64_t[4],
+    32
+  > d;
+};
+
+namespace
+{
+// Operators
+auto operator!(const bool4d& v) { return bool4d{_mm256_xor_pd(v, bool4d{true})}; }
+
+auto operator&(const bool4d& lhs, const bool4d& rhs) { return bool4d{_mm256_and_pd(lhs, rhs)}; }
+auto operator|(const bool4d& lhs, const bool4d& rhs) { return bool4d{_mm256_or_pd(lhs, rhs)}; }
+auto operator^(const bool4d& lhs, const bool4d& rhs) { return bool4d{_mm256_xor_pd(lhs, rhs)}; }
+
+// Reduction
+auto movemask(const bool4d& v)
+{ return _mm256_movemask_pd(v); }
+
+bool all(const bool4d& v)  { return movemask(v) == 0xf; }
+bool any(const bool4d& v)  { return movemask(v) != 0x0; }
+bool none(const bool4d& v) { return movemask(v) == 0x0; }
+//
+}
+
 } // namespace ig
 
 #endif // IG_MATH_BOOL8_H
@@ -0,0 +1,74 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_DOUBLE4_H
+#define IG_MATH_DOUBLE4_H
+
+namespace ig {
+
+struct double4 {
+  double4() = default;
+  double4(__m256d in) : d{in} {}
+  double4(double x)   : d{_mm256_set1_pd(x)} {}
+  explicit double4(double a, double b, double c, double d)
+    : d{_mm256_setr_pd(
+        a, b,
+        c, d)} {}
+
+  auto operator[](size_t n) const
+  { return d.p[n]; }
+  auto& operator[](size_t n)
+  { return d.p[n]; }
+
+  operator const __m256d&() const { return d.v; }
+  operator       __m256d&()       { return d.v; }
+
+  simd_data
+  < __m256d,
+    double[4],
+    32
+  > d;
+};
+
+namespace
+{
+// Operators
+auto operator+(const double4& lhs, const double4& rhs) { return double4{_mm256_add_pd(lhs, rhs)}; }
+auto operator-(const double4& lhs, const double4& rhs) { return double4{_mm256_sub_pd(lhs, rhs)}; }
+auto operator*(const double4& lhs, const double4& rhs) { return double4{_mm256_mul_pd(lhs, rhs)}; }
+auto operator/(const double4& lhs, const double4& rhs) { return double4{_mm256_div_pd(lhs, rhs)}; }
+
+auto operator^(const double4& lhs, const double4& rhs) { return double4{_mm256_xor_pd(lhs, rhs)}; }
+auto operator-(const double4& v)                       { return double4{_mm256_xor_pd(v, _mm256_set1_pd(-0.0))}; }
+
+// Comparison
+auto operator==(const double4& lhs, const double4& rhs) { return bool4d{_mm256_cmp_pd(lhs, rhs, _CMP_EQ_OQ)}; }
+auto operator!=(const double4& lhs, const double4& rhs) { return bool4d{_mm256_cmp_pd(lhs, rhs, _CMP_NEQ_OQ)}; }
+auto operator< (const double4& lhs, const double4& rhs) { return bool4d{_mm256_cmp_pd(lhs, rhs, _CMP_LT_OQ)}; }
+auto operator<=(const double4& lhs, const double4& rhs) { return bool4d{_mm256_cmp_pd(lhs, rhs, _CMP_LE_OQ)}; }
+auto operator> (const double4& lhs, const double4& rhs) { return bool4d{_mm256_cmp_pd(lhs, rhs, _CMP_GT_OQ)}; }
+auto operator>=(const double4& lhs, const double4& rhs) { return bool4d{_mm256_cmp_pd(lhs, rhs, _CMP_GE_OQ)}; }
+
+// Relational
+auto min(const double4& lhs, const double4& rhs) { return double4{_mm256_min_pd(lhs, rhs)}; }
+auto max(const double4& lhs, const double4& rhs) { return double4{_mm256_max_pd(lhs, rhs)}; }
+
+// Arithmetic & Rounding
+auto abs(const double4& v)     { return double4{_mm256_andnot_pd(_mm256_set1_pd(-0.0), v)}; }
+auto sgnmask(const double4& v) { return double4{_mm256_and_pd(v, _mm256_set1_pd(-0.0))}; }
+
+auto sqrt(const double4& v)
+{ return double4{_mm256_sqrt_pd(v)}; }
+
+// Movement & Shuffling
+auto unpacklo(const double4& lhs, const double4& rhs) { return double4{_mm256_unpacklo_pd(lhs, rhs)}; }
+auto unpackhi(const double4& lhs, const double4& rhs) { return double4{_mm256_unpackhi_pd(lhs, rhs)}; }
+//
+}
+
+} // namespace ig
+
+#endif // IG_MATH_DOUBLE4_H
@@ -61,6 +61,19 @@ auto operator>=(const int8& lhs, const int8& rhs) { return !(lhs < rhs); }
 auto min(const int8& lhs, const int8& rhs) { return int8{_mm256_min_epi32(lhs, rhs)}; }
 auto max(const int8& lhs, const int8& rhs) { return int8{_mm256_max_epi32(lhs, rhs)}; }
 
+// Byte products
+// lanes hold four signed bytes in [-127, 127], their dot product is added to acc without saturation
+auto dot4(const int8& acc, const int8& a, const int8& b) {
+  auto u = _mm256_abs_epi8(a), s = _mm256_sign_epi8(b, a);
+#if defined(__AVXVNNI__)
+  return int8{_mm256_dpbusd_avx_epi32(acc, u, s)};
+#elif defined(__AVX512VNNI__) && defined(__AVX512VL__)
+  return int8{_mm256_dpbusd_epi32(acc, u, s)};
+#else
+  return int8{_mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_maddubs_epi16(u, s), _mm256_set1_epi16(1)))};
+#endif
+}
+
 // Movement & Shuffling
 auto unpacklo(const int8& lhs, const int8& rhs) { return int8{_mm256_unpacklo_epi32(lhs, rhs)}; }
 auto unpackhi(const int8& lhs, const int8& rhs) { return int8{_mm256_unpackhi_epi32(lhs, rhs)}; }
@@ -8,9 +8,15 @@
 #define IG_MATH_INTRINSICS_H
 
 #include "imagine/ig.h"
+#if defined(IG_X86)
 #include <immintrin.h>
+#endif
 
-#if defined(__AVX__) || defined(__AVX2__)
+// IG_NO_SIMD keeps every packet in scalar lanes, whatever the target
+#if defined(IG_NO_SIMD)
+# define IG_VECTOR_SIMD  0
+# define IG_PACKET_WIDE  4
+#elif defined(__AVX__) || defined(__AVX2__)
 # define IG_SSE
 # define IG_AVX
 # define IG_VECTOR_SIMD 32
@@ -21,7 +27,7 @@
 # define IG_PACKET_WIDE  4
 #else
 # define IG_VECTOR_SIMD  0
-# define IG_PACKET_WIDE  1
+# define IG_PACKET_WIDE  4
 #endif
 
 namespace ig {
@@ -55,8 +61,8 @@ inline void prefetch_nta(const void* ptr) { _mm_prefetch(reinterpret_cast<const
 # elif defined(IG_SSE)
 #  include "imagine/math/theory/simd_accel/sse.h"
 # endif
-#else
-
 #endif
 
+#include "imagine/math/theory/simd_accel/simd.h"
+
 #endif // IG_MATH_INTRINSICS_H
@@ -0,0 +1,90 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_LANES_H
+#define IG_MATH_LANES_H
+
+#include <cmath>
+
+namespace ig {
+
+// Scalar lanes, the registers of the widths and element types without a native counterpart
+// Every operation is a loop over the lanes, that compilers are free to vectorize
+template <size_t N>
+struct lanes_mask {
+  lanes_mask() = default;
+  lanes_mask(bool x) { for (auto& b : p) b = x; }
+
+  auto operator[](size_t n) const
+  { return p[n]; }
+  auto& operator[](size_t n)
+  { return p[n]; }
+
+  friend auto operator!(const lanes_mask& v) { lanes_mask r; for (size_t k = 0; k < N; ++k) r.p[k] = !v.p[k]; return r; }
+
+  friend auto operator&(const lanes_mask& lhs, const lanes_mask& rhs) { lanes_mask r; for (size_t k = 0; k < N; ++k) r.p[k] = lhs.p[k] && rhs.p[k]; return r; }
+  friend auto operator|(const lanes_mask& lhs, const lanes_mask& rhs) { lanes_mask r; for (size_t k = 0; k < N; ++k) r.p[k] = lhs.p[k] || rhs.p[k]; return r; }
+  friend auto operator^(const lanes_mask& lhs, const lanes_mask& rhs) { lanes_mask r; for (size_t k = 0; k < N; ++k) r.p[k] = lhs.p[k] != rhs.p[k]; return r; }
+
+  // Reduction
+  friend auto movemask(const lanes_mask& v) {
+    int m = 0;
+    for (size_t k = 0; k < N; ++k) m |= int(v.p[k]) << k;
+    return m;
+  }
+
+  friend bool all(const lanes_mask& v)  { for (auto b : v.p) if (!b) return false; return true; }
+  friend bool any(const lanes_mask& v)  { for (auto b : v.p) if (b)  return true;  return false; }
+  friend bool none(const lanes_mask& v) { return !any(v); }
+
+  bool p[N];
+};
+
+template <typename T, size_t N>
+struct lanes {
+  lanes() = default;
+  lanes(T x) { for (auto& v : p) v = x; }
+
+  auto operator[](size_t n) const
+  { return p[n]; }
+  auto& operator[](size_t n)
+  { return p[n]; }
+
+  // Operators
+  friend auto operator+(const lanes& lhs, const lanes& rhs) { return map([&](size_t k) { return lhs.p[k] + rhs.p[k]; }); }
+  friend auto operator-(const lanes& lhs, const lanes& rhs) { return map([&](size_t k) { return lhs.p[k] - rhs.p[k]; }); }
+  friend auto operator*(const lanes& lhs, const lanes& rhs) { return map([&](size_t k) { return lhs.p[k] * rhs.p[k]; }); }
+  friend auto operator/(const lanes& lhs, const lanes& rhs) { return map([&](size_t k) { return lhs.p[k] / rhs.p[k]; }); }
+  friend auto operator-(const lanes& v)                     { return map([&](size_t k) { return -v.p[k]; }); }
+
+  // Comparison
+  friend auto operator==(const lanes& lhs, const lanes& rhs) { return test([&](size_t k) { return lhs.p[k] == rhs.p[k]; }); }
+  friend auto operator!=(const lanes& lhs, const lanes& rhs) { return test([&](size_t k) { return lhs.p[k] != rhs.p[k]; }); }
+  friend auto operator< (const lanes& lhs, const lanes& rhs) { return test([&](size_t k) { return lhs.p[k] <  rhs.p[k]; }); }
+  friend auto operator<=(const lanes& lhs, const lanes& rhs) { return test([&](size_t k) { return lhs.p[k] <= rhs.p[k]; }); }
+  friend auto operator> (const lanes& lhs, const lanes& rhs) { return test([&](size_t k) { return lhs.p[k] >  rhs.p[k]; }); }
+  friend auto operator>=(const lanes& lhs, const lanes& rhs) { return test([&](size_t k) { return lhs.p[k] >= rhs.p[k]; }); }
+
+  // Relational, the second operand is returned when unordered like the native min and max
+  friend auto min(const lanes& lhs, const lanes& rhs) { return map([&](size_t k) { return lhs.p[k] < rhs.p[k] ? lhs.p[k] : rhs.p[k]; }); }
+  friend auto max(const lanes& lhs, const lanes& rhs) { return map([&](size_t k) { return lhs.p[k] > rhs.p[k] ? lhs.p[k] : rhs.p[k]; }); }
+
+  // Arithmetic & Rounding
+  friend auto abs(const lanes& v)  { return map([&](size_t k) { return T(std::abs(v.p[k])); }); }
+  friend auto sqrt(const lanes& v) { return map([&](size_t k) { return T(std::sqrt(v.p[k])); }); }
+
+  T p[N];
+
+private:
+  template <typename Fn>
+  static auto map(Fn&& fn) { lanes r; for (size_t k = 0; k < N; ++k) r.p[k] = fn(k); return r; }
+  template <typename Fn>
+  static auto test(Fn&& fn) { lanes_mask<N> r; for (size_t k = 0; k < N; ++k) r[k] = fn(k); return r; }
+};
+
+} // namespace ig
+
+#endif // IG_MATH_LANES_H
@@ -0,0 +1,283 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_SIMD_H
+#define IG_MATH_SIMD_H
+
+#include "imagine/math/theory/simd_accel/scalar.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace ig {
+
+// Register of N elements of type T, native when the target has one and scalar lanes otherwise
+template <typename T, size_t N> struct simd_type { using type = lanes<T, N>; };
+
+#if defined(IG_SSE)
+template <> struct simd_type<float, 4>  { using type = float4; };
+template <> struct simd_type<int, 4>    { using type = int4; };
+template <> struct simd_type<double, 2> { using type = double2; };
+#endif
+#if defined(IG_AVX)
+template <> struct simd_type<float, 8>  { using type = float8; };
+template <> struct simd_type<double, 4> { using type = double4; };
+# if defined(__AVX2__)
+template <> struct simd_type<int, 8>    { using type = int8; };
+# endif
+#endif
+
+// Lanes of a register as wide as a packet
+template <typename T> constexpr size_t simd_width = std::max<size_t>(1, IG_PACKET_WIDE * sizeof(float) / sizeof(T));
+
+template <typename T, size_t N = simd_width<T>> using simd = typename simd_type<T, N>::type;
+
+template <typename P> struct simd_traits;
+
+template <typename T, size_t N>
+struct simd_traits< lanes<T, N> > { using value_type = T; using mask_type = lanes_mask<N>; static constexpr size_t size = N; };
+
+#if defined(IG_SSE)
+template <> struct simd_traits<float4>  { using value_type = float;  using mask_type = bool4;  static constexpr size_t size = 4; };
+template <> struct simd_traits<int4>    { using value_type = int;    using mask_type = bool4;  static constexpr size_t size = 4; };
+template <> struct simd_traits<double2> { using value_type = double; using mask_type = bool2d; static constexpr size_t size = 2; };
+#endif
+#if defined(IG_AVX)
+template <> struct simd_traits<float8>  { using value_type = float;  using mask_type = bool8;  static constexpr size_t size = 8; };
+template <> struct simd_traits<double4> { using value_type = double; using mask_type = bool4d; static constexpr size_t size = 4; };
+# if defined(__AVX2__)
+template <> struct simd_traits<int8>    { using value_type = int;    using mask_type = bool8;  static constexpr size_t size = 8; };
+# endif
+#endif
+
+template <typename P> using simd_value_t = typename simd_traits<P>::value_type;
+template <typename P> using simd_mask_t  = typename simd_traits<P>::mask_type;
+template <typename P> using simd_index_t = simd<int, simd_traits<P>::size>;
+template <typename P> constexpr size_t simd_size_v = simd_traits<P>::size;
+
+template <typename P, typename = void> struct is_simd : std::false_type {};
+template <typename P> struct is_simd< P, std::void_t<decltype(simd_traits<P>::size)> > : std::true_type {};
+template <typename P> constexpr bool is_simd_v = is_simd<P>::value;
+
+// Mask of the first n lanes, the tail of a loop
+template <typename P>
+auto head_mask(size_t n) {
+  simd_mask_t<P> m;
+  for (size_t k = 0; k < simd_size_v<P>; ++k)
+    m[k] = k < n ? -1 : 0;
+  return m;
+}
+
+#if defined(IG_SSE)
+namespace detail {
+
+inline auto blend_ps(__m128 mask, __m128 t, __m128 f) {
+# if defined(__SSE4_1__)
+  return _mm_blendv_ps(f, t, mask);
+# else
+  return _mm_or_ps(_mm_and_ps(mask, t), _mm_andnot_ps(mask, f));
+# endif
+}
+
+} // namespace detail
+#endif
+
+// mask ? t : f, lane by lane
+template <typename P>
+auto blend(const simd_mask_t<P>& mask, const P& t, const P& f) {
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<P, float4>) {
+    return float4{detail::blend_ps(mask, t, f)};
+  } else if constexpr (std::is_same_v<P, int4>) {
+    return int4{_mm_castps_si128(detail::blend_ps(mask, _mm_castsi128_ps(t), _mm_castsi128_ps(f)))};
+  } else if constexpr (std::is_same_v<P, double2>) {
+# if defined(__SSE4_1__)
+    return double2{_mm_blendv_pd(f, t, mask)};
+# else
+    return double2{_mm_or_pd(_mm_and_pd(mask, t), _mm_andnot_pd(mask, f))};
+# endif
+  } else
+#endif
+#if defined(IG_AVX)
+  if constexpr (std::is_same_v<P, float8>) {
+    return float8{_mm256_blendv_ps(f, t, mask)};
+  } else if constexpr (std::is_same_v<P, double4>) {
+    return double4{_mm256_blendv_pd(f, t, mask)};
+# if defined(__AVX2__)
+  } else if constexpr (std::is_same_v<P, int8>) {
+    return int8{_mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(f), _mm256_castsi256_ps(t), mask))};
+# endif
+  } else
+#endif
+  {
+    P r;
+    for (size_t k = 0; k < simd_size_v<P>; ++k) r[k] = mask[k] ? t[k] : f[k];
+    return r;
+  }
+}
+
+// Unaligned loads and stores
+template <typename P>
+auto load(const simd_value_t<P>* p) {
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<P, float4>)  return float4{_mm_loadu_ps(p)};
+  else if constexpr (std::is_same_v<P, int4>)    return int4{_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))};
+  else if constexpr (std::is_same_v<P, double2>) return double2{_mm_loadu_pd(p)};
+  else
+#endif
+#if defined(IG_AVX)
+  if constexpr (std::is_same_v<P, float8>)  return float8{_mm256_loadu_ps(p)};
+  else if constexpr (std::is_same_v<P, double4>) return double4{_mm256_loadu_pd(p)};
+# if defined(__AVX2__)
+  else if constexpr (std::is_same_v<P, int8>)    return int8{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))};
+# endif
+  else
+#endif
+  {
+    P r;
+    for (size_t k = 0; k < simd_size_v<P>; ++k) r[k] = p[k];
+    return r;
+  }
+}
+
+template <typename P, typename = std::enable_if_t<is_simd_v<P>>>
+void store(simd_value_t<P>* p, const P& v) {
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<P, float4>)  _mm_storeu_ps(p, v);
+  else if constexpr (std::is_same_v<P, int4>)    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+  else if constexpr (std::is_same_v<P, double2>) _mm_storeu_pd(p, v);
+  else
+#endif
+#if defined(IG_AVX)
+  if constexpr (std::is_same_v<P, float8>)  _mm256_storeu_ps(p, v);
+  else if constexpr (std::is_same_v<P, double4>) _mm256_storeu_pd(p, v);
+# if defined(__AVX2__)
+  else if constexpr (std::is_same_v<P, int8>)    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+# endif
+  else
+#endif
+  for (size_t k = 0; k < simd_size_v<P>; ++k) p[k] = v[k];
+}
+
+// Masked loads and stores, the memory of disabled lanes is never touched and they load as zero
+template <typename P>
+auto load(const simd_value_t<P>* p, const simd_mask_t<P>& mask) {
+#if defined(IG_AVX)
+  if constexpr (std::is_same_v<P, float4>)  return float4{_mm_maskload_ps(p, _mm_castps_si128(mask))};
+  else if constexpr (std::is_same_v<P, double2>) return double2{_mm_maskload_pd(p, _mm_castpd_si128(mask))};
+  else if constexpr (std::is_same_v<P, float8>)  return float8{_mm256_maskload_ps(p, _mm256_castps_si256(mask))};
+  else if constexpr (std::is_same_v<P, double4>) return double4{_mm256_maskload_pd(p, _mm256_castpd_si256(mask))};
+# if defined(__AVX2__)
+  else if constexpr (std::is_same_v<P, int4>)    return int4{_mm_maskload_epi32(p, _mm_castps_si128(mask))};
+  else if constexpr (std::is_same_v<P, int8>)    return int8{_mm256_maskload_epi32(p, _mm256_castps_si256(mask))};
+# endif
+  else
+#endif
+  {
+    P r{simd_value_t<P>(0)};
+    for (size_t k = 0; k < simd_size_v<P>; ++k) if (mask[k]) r[k] = p[k];
+    return r;
+  }
+}
+
+template <typename P, typename = std::enable_if_t<is_simd_v<P>>>
+void store(simd_value_t<P>* p, const P& v, const simd_mask_t<P>& mask) {
+#if defined(IG_AVX)
+  if constexpr (std::is_same_v<P, float4>)  _mm_maskstore_ps(p, _mm_castps_si128(mask), v);
+  else if constexpr (std::is_same_v<P, double2>) _mm_maskstore_pd(p, _mm_castpd_si128(mask), v);
+  else if constexpr (std::is_same_v<P, float8>)  _mm256_maskstore_ps(p, _mm256_castps_si256(mask), v);
+  else if constexpr (std::is_same_v<P, double4>) _mm256_maskstore_pd(p, _mm256_castpd_si256(mask), v);
+# if defined(__AVX2__)
+  else if constexpr (std::is_same_v<P, int4>)    _mm_maskstore_epi32(p, _mm_castps_si128(mask), v);
+  else if constexpr (std::is_same_v<P, int8>)    _mm256_maskstore_epi32(p, _mm256_castps_si256(mask), v);
+# endif
+  else
+#endif
+  for (size_t k = 0; k < simd_size_v<P>; ++k) if (mask[k]) p[k] = v[k];
+}
+
+// p[index[k]] for every lane
+template <typename P>
+auto gather(const simd_value_t<P>* p, const simd_index_t<P>& index) {
+#if defined(IG_AVX) && defined(__AVX2__)
+  if constexpr (std::is_same_v<P, float4>)  return float4{_mm_i32gather_ps(p, index, 4)};
+  else if constexpr (std::is_same_v<P, int4>)    return int4{_mm_i32gather_epi32(p, index, 4)};
+  else if constexpr (std::is_same_v<P, float8>)  return float8{_mm256_i32gather_ps(p, index, 4)};
+  else if constexpr (std::is_same_v<P, int8>)    return int8{_mm256_i32gather_epi32(p, index, 4)};
+  else if constexpr (std::is_same_v<P, double4>) return double4{_mm256_i32gather_pd(p, index, 8)};
+  else
+#endif
+  {
+    P r;
+    for (size_t k = 0; k < simd_size_v<P>; ++k) r[k] = p[index[k]];
+    return r;
+  }
+}
+
+// p[index[k]] = v[k] in lane order, so the last lane wins on repeated indices
+template <typename P, typename = std::enable_if_t<is_simd_v<P>>>
+void scatter(simd_value_t<P>* p, const simd_index_t<P>& index, const P& v) {
+  for (size_t k = 0; k < simd_size_v<P>; ++k) p[index[k]] = v[k];
+}
+
+namespace detail {
+
+// Halves are combined until a single lane remains
+template <typename P, typename Op, typename Scalar>
+auto horizontal(const P& v, Op&& op, Scalar&& scalar) {
+#if defined(IG_SSE)
+  if constexpr (std::is_same_v<P, float4>) {
+    auto h = op(v, shuffle<2, 3, 0, 1>(v));
+    return op(h, shuffle<1, 0, 3, 2>(h))[0];
+  } else if constexpr (std::is_same_v<P, double2>) {
+    return op(v, double2{_mm_unpackhi_pd(v, v)})[0];
+  } else
+#endif
+#if defined(IG_AVX)
+  if constexpr (std::is_same_v<P, float8>) {
+    return horizontal(op(float4{_mm256_castps256_ps128(v)}, float4{_mm256_extractf128_ps(v, 1)}), op, scalar);
+  } else if constexpr (std::is_same_v<P, double4>) {
+    return horizontal(op(double2{_mm256_castpd256_pd128(v)}, double2{_mm256_extractf128_pd(v, 1)}), op, scalar);
+  } else
+#endif
+  {
+    auto r = v[0];
+    for (size_t k = 1; k < simd_size_v<P>; ++k) r = scalar(r, v[k]);
+    return r;
+  }
+}
+
+} // namespace detail
+
+// Horizontal operations, the lanes of a register folded into a scalar
+template <typename P, typename = std::enable_if_t<is_simd_v<P>>>
+auto hsum(const P& v) {
+  return detail::horizontal(v,
+    [](const auto& a, const auto& b) { return a + b; },
+    [](auto a, auto b) { return a + b; });
+}
+
+template <typename P, typename = std::enable_if_t<is_simd_v<P>>>
+auto hmin(const P& v) {
+  return detail::horizontal(v,
+    [](const auto& a, const auto& b) { return min(a, b); },
+    [](auto a, auto b) { return a < b ? a : b; });
+}
+
+template <typename P, typename = std::enable_if_t<is_simd_v<P>>>
+auto hmax(const P& v) {
+  return detail::horizontal(v,
+    [](const auto& a, const auto& b) { return max(a, b); },
+    [](auto a, auto b) { return a > b ? a : b; });
+}
+
+} // namespace ig
+
+//
+// Packet of floats, native on every target
+using packet = ig::simd<float>;
+
+#endif // IG_MATH_SIMD_H
@@ -12,9 +12,6 @@
 #include "imagine/math/theory/simd_accel/sse_b.h"
 #include "imagine/math/theory/simd_accel/sse_f.h"
 #include "imagine/math/theory/simd_accel/sse_i.h"
-
-//
-// SSE packet
-using packet = ig::float4;
+#include "imagine/math/theory/simd_accel/sse_d.h"
 
 #endif // IG_MATH_SSE_H
@@ -89,6 +89,46 @@ auto shuffle(const bool4& v, const bool4& t)
 //
 }
 
+// Masks of double lanes
+struct bool2d {
+  bool2d() = default;
+  bool2d(__m128d in) : d{in} {}
+  bool2d(bool x)     : d{x ? _mm_castsi128_pd(_mm_set1_epi32(-1)) : _mm_setzero_pd()} {}
+
+  auto& operator[](size_t n) const
+  { return d.p[n]; }
+  auto& operator[](size_t n)
+  { return d.p[n]; }
+
+  operator const __m128d&() const { return d.v; }
+  operator       __m128d&()       { return d.v; }
+
+  simd_data
+  < __m128d,
+    int64_t[2],
+    16
+  > d;
+};
+
+namespace
+{
+// Operators
+auto operator!(const bool2d& v) { return bool2d{_mm_xor_pd(v, bool2d{true})}; }
+
+auto operator&(const bool2d& lhs, const bool2d& rhs) { return bool2d{_mm_and_pd(lhs, rhs)}; }
+auto operator|(const bool2d& lhs, const bool2d& rhs) { return bool2d{_mm_or_pd(lhs, rhs)}; }
+auto operator^(const bool2d& lhs, const bool2d& rhs) { return bool2d{_mm_xor_pd(lhs, rhs)}; }
+
+// Reduction
+auto movemask(const bool2d& v)
+{ return _mm_movemask_pd(v); }
+
+bool all(const bool2d& v)  { return movemask(v) == 0x3; }
+bool any(const bool2d& v)  { return movemask(v) != 0x0; }
+bool none(const bool2d& v) { return movemask(v) == 0x0; }
+//
+}
+
 } // namespace ig
 
 #endif // IG_MATH_BOOL4_H
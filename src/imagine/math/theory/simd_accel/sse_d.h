@@ -0,0 +1,80 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_DOUBLE2_H
+#define IG_MATH_DOUBLE2_H
+
+namespace ig {
+
+struct double2 {
+  double2() = default;
+  double2(__m128d in) : d{in} {}
+  double2(double x)   : d{_mm_set1_pd(x)} {}
+  explicit double2(double x, double y)
+    : d{_mm_set_pd(
+        y,
+        x)} {}
+
+  auto operator[](size_t n) const
+  { return d.p[n]; }
+  auto& operator[](size_t n)
+  { return d.p[n]; }
+
+  operator const __m128d&() const { return d.v; }
+  operator       __m128d&()       { return d.v; }
+
+  simd_data
+  < __m128d,
+    double[2],
+    16
+  > d;
+};
+
+namespace
+{
+// Operators
+auto operator+(const double2& lhs, const double2& rhs) { return double2{_mm_add_pd(lhs, rhs)}; }
+auto operator-(const double2& lhs, const double2& rhs) { return double2{_mm_sub_pd(lhs, rhs)}; }
+auto operator*(const double2& lhs, const double2& rhs) { return double2{_mm_mul_pd(lhs, rhs)}; }
+auto operator/(const double2& lhs, const double2& rhs) { return double2{_mm_div_pd(lhs, rhs)}; }
+
+auto operator^(const double2& lhs, const double2& rhs) { return double2{_mm_xor_pd(lhs, rhs)}; }
+auto operator-(const double2& v)                       { return double2{_mm_xor_pd(v, _mm_set1_pd(-0.0))}; }
+
+// Comparison
+auto operator==(const double2& lhs, const double2& rhs) { return bool2d{_mm_cmpeq_pd(lhs, rhs)}; }
+auto operator!=(const double2& lhs, const double2& rhs) { return bool2d{_mm_cmpneq_pd(lhs, rhs)}; }
+auto operator< (const double2& lhs, const double2& rhs) { return bool2d{_mm_cmplt_pd(lhs, rhs)}; }
+auto operator<=(const double2& lhs, const double2& rhs) { return bool2d{_mm_cmple_pd(lhs, rhs)}; }
+auto operator> (const double2& lhs, const double2& rhs) { return bool2d{_mm_cmpgt_pd(lhs, rhs)}; }
+auto operator>=(const double2& lhs, const double2& rhs) { return bool2d{_mm_cmpge_pd(lhs, rhs)}; }
+
+// Relational
+auto min(const double2& lhs, const double2& rhs) { return double2{_mm_min_pd(lhs, rhs)}; }
+auto max(const double2& lhs, const double2& rhs) { return double2{_mm_max_pd(lhs, rhs)}; }
+
+// Arithmetic & Rounding
+auto abs(const double2& v)     { return double2{_mm_andnot_pd(_mm_set1_pd(-0.0), v)}; }
+auto sgnmask(const double2& v) { return double2{_mm_and_pd(v, _mm_set1_pd(-0.0))}; }
+
+auto sqrt(const double2& v)
+{ return double2{_mm_sqrt_pd(v)}; }
+
+// Movement & Shuffling
+auto unpacklo(const double2& lhs, const double2& rhs) { return double2{_mm_unpacklo_pd(lhs, rhs)}; }
+auto unpackhi(const double2& lhs, const double2& rhs) { return double2{_mm_unpackhi_pd(lhs, rhs)}; }
+
+template
+< size_t i0,
+  size_t i1 >
+auto shuffle(const double2& v, const double2& t)
+{ return double2{_mm_shuffle_pd(v, t, _MM_SHUFFLE2(i1, i0))}; }
+//
+}
+
+} // namespace ig
+
+#endif // IG_MATH_DOUBLE2_H
@@ -61,8 +61,13 @@ auto operator> (const int4& lhs, const int4& rhs) { return bool4{_mm_castsi128_p
 auto operator<=(const int4& lhs, const int4& rhs) { return !(lhs > rhs); }
 
 // Relational
-auto min(const int4& lhs, const int4& rhs) { return select(lhs < rhs, lhs, rhs); }
-auto max(const int4& lhs, const int4& rhs) { return select(lhs > rhs, lhs, rhs); }
+#if defined(__SSE4_1__)
+auto min(const int4& lhs, const int4& rhs) { return int4{_mm_min_epi32(lhs, rhs)}; }
+auto max(const int4& lhs, const int4& rhs) { return int4{_mm_max_epi32(lhs, rhs)}; }
+#else
+auto min(const int4& lhs, const int4& rhs) { return int4{_mm_castps_si128(select(rhs, lhs, lhs < rhs))}; }
+auto max(const int4& lhs, const int4& rhs) { return int4{_mm_castps_si128(select(rhs, lhs, lhs > rhs))}; }
+#endif
 
 // Movement & Shuffling
 auto unpacklo(const int4& lhs, const int4& rhs) { return int4{_mm_unpacklo_epi32(lhs, rhs)}; }
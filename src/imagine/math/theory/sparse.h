@@ -0,0 +1,170 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_SPARSE_H
+#define IG_MATH_SPARSE_H
+
+#include "imagine/math/theory/matrix.h"
+
+#include <tuple>
+#include <vector>
+
+namespace ig {
+
+// Compressed sparse column matrix
+template <typename T>
+class sparse {
+public:
+  using value_type = T;
+  using index_type = std::vector<size_t>;
+  using value_container = std::vector<value_type>;
+  using triplet = std::tuple<size_t, size_t, value_type>;
+
+  sparse() = default;
+  explicit sparse(size_t m, size_t n)
+    : m_{m}
+    , n_{n}
+    , cols_(n + 1, 0) {}
+  explicit sparse(size_t m, size_t n, std::vector<triplet> entries);
+
+  template <typename Mat>
+  explicit sparse(const matrix_base<Mat>& mat, value_type threshold = 0);
+
+  auto rows() const { return m_; }
+  auto cols() const { return n_; }
+  auto nnz() const  { return rows_.size(); }
+  auto square() const { return m_ == n_; }
+
+  auto& col_ptr() const { return cols_; }
+  auto& row_ind() const { return rows_; }
+  auto& values() const  { return values_; }
+  auto& values()        { return values_; }
+
+  auto operator()(size_t row, size_t col) const -> value_type;
+
+  auto t() const -> sparse;
+  auto dense() const -> matrix<value_type>;
+
+private:
+  size_t m_ = 0, n_ = 0;
+
+  index_type cols_, rows_;
+  value_container values_;
+};
+
+template <typename T>
+sparse<T>::sparse(size_t m, size_t n, std::vector<triplet> entries)
+  : m_{m}
+  , n_{n}
+  , cols_(n + 1, 0) {
+
+  std::sort(entries.begin(), entries.end(), [](auto& lhs, auto& rhs) {
+    return std::get<1>(lhs) != std::get<1>(rhs)
+      ? std::get<1>(lhs) < std::get<1>(rhs)
+      : std::get<0>(lhs) < std::get<0>(rhs);
+  });
+
+  rows_.reserve(entries.size());
+  values_.reserve(entries.size());
+  for (size_t k = 0; k < entries.size(); ++k) {
+    auto [i, j, v] = entries[k];
+    assert(i < m_ && j < n_ && "Invalid sparse matrix entry");
+
+    // Sum duplicates
+    if (k > 0 && std::get<0>(entries[k - 1]) == i && std::get<1>(entries[k - 1]) == j) {
+      values_.back() += v;
+    } else {
+      rows_.push_back(i);
+      values_.push_back(v);
+      cols_[j + 1]++;
+    }
+  }
+
+  std::partial_sum(cols_.begin(), cols_.end(), cols_.begin());
+}
+
+template <typename T>
+template <typename Mat>
+sparse<T>::sparse(const matrix_base<Mat>& mat, value_type threshold)
+  : m_{mat.rows()}
+  , n_{mat.cols()}
+  , cols_(n_ + 1, 0) {
+
+  for (size_t j = 0; j < n_; ++j) {
+    for (size_t i = 0; i < m_; ++i) {
+      if (std::abs(mat(i, j)) > threshold)
+        rows_.push_back(i),
+        values_.push_back(mat(i, j));
+    } cols_[j + 1] = rows_.size();
+  }
+}
+
+template <typename T>
+auto sparse<T>::operator()(size_t row, size_t col) const -> value_type {
+  assert(
+    row < rows() &&
+    col < cols()
+    && "Invalid sparse matrix subscript");
+
+  auto first = rows_.begin() + cols_[col],
+       last  = rows_.begin() + cols_[col + 1];
+  auto it = std::lower_bound(first, last, row);
+  return it != last && *it == row
+    ? values_[it - rows_.begin()]
+    : value_type(0);
+}
+
+template <typename T>
+auto sparse<T>::t() const -> sparse {
+  sparse trans{n_, m_};
+  trans.rows_.resize(nnz());
+  trans.values_.resize(nnz());
+
+  for (auto i : rows_) trans.cols_[i + 1]++;
+  std::partial_sum(trans.cols_.begin(), trans.cols_.end(), trans.cols_.begin());
+
+  auto next = trans.cols_;
+  for (size_t j = 0; j < n_; ++j) {
+    for (auto k = cols_[j]; k < cols_[j + 1]; ++k) {
+      auto q = next[rows_[k]]++;
+      trans.rows_  [q] = j;
+      trans.values_[q] = values_[k];
+    }
+  } return trans;
+}
+
+template <typename T>
+auto sparse<T>::dense() const -> matrix<value_type> {
+  matrix<value_type> mat{m_, n_};
+  for (size_t j = 0; j < n_; ++j)
+    for (auto k = cols_[j]; k < cols_[j + 1]; ++k)
+      mat(rows_[k], j) = values_[k];
+  return mat;
+}
+
+// Sparse matrix-vector product
+template <typename T, typename Vec>
+auto operator%(const sparse<T>& lhs, const matrix_base<Vec>& rhs) {
+  assert(
+    rhs.vector() &&
+    lhs.cols() == rhs.size()
+    && "Incoherent sparse matrix-vector multiplication");
+
+  auto& cols = lhs.col_ptr();
+  auto& rows = lhs.row_ind();
+  auto& vals = lhs.values();
+
+  colvec< std::common_type_t<T, matrix_t<Vec>> > y{lhs.rows()};
+  for (size_t j = 0; j < lhs.cols(); ++j) {
+    auto x = rhs[j];
+    for (auto k = cols[j]; k < cols[j + 1]; ++k)
+      y[rows[k]] += vals[k] * x;
+  } return y;
+}
+
+} // namespace ig
+
+#endif // IG_MATH_SPARSE_H
@@ -0,0 +1,483 @@
+/*
+ Imagine v0.1
+ [math]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_MATH_SPARSETENSOR_H
+#define IG_MATH_SPARSETENSOR_H
+
+#include "imagine/math/theory/ndarray.h"
+#include "imagine/math/theory/matrix.h"
+
+#include <limits>
+#include <tuple>
+#include <vector>
+
+namespace ig {
+
+namespace detail {
+
+// Most significant dimension first, the last one for the dense order
+inline auto sparse_order(size_t d) {
+  nd::shape_array order;
+  for (size_t l = 0; l < d; ++l) order.push_back(d - 1 - l);
+  return order;
+}
+
+// Compares the coordinates a and b, from the most significant dimension in order
+template <typename A, typename B>
+auto sparse_less(A a, B b, const nd::shape_array& order) {
+  for (size_t l = 0; l < order.size(); ++l)
+    if (a[order[l]] != b[order[l]])
+      return a[order[l]] < b[order[l]];
+  return false;
+}
+
+// Sorts items along a total order, chunks sorted on the job pool are merged as a balanced tree
+template <typename Item, typename Less>
+void sparse_sort(std::vector<Item>& items, Less&& less) {
+  auto n = items.size();
+  auto chunks = in_parallel()
+    ? size_t(1)
+    : std::min(pool().size() + 1, std::max<size_t>(1, n / nd::parallel_grain));
+  auto at = [](auto& v, size_t i) { return v.begin() + std::ptrdiff_t(i); };
+  parallel_for(0, chunks, 1, [&](size_t first, size_t last) {
+    for (auto c = first; c < last; ++c)
+      std::sort(at(items, c * n / chunks), at(items, (c + 1) * n / chunks), less);
+  });
+
+  std::vector<Item> tmp(chunks > 1 ? n : 0);
+  for (size_t width = 1; width < chunks; width *= 2) {
+    parallel_for(0, (chunks + 2 * width - 1) / (2 * width), 1, [&](size_t first, size_t last) {
+      for (auto p = first; p < last; ++p) {
+        auto lo  = 2 * p * width * n / chunks,
+             mid = std::min(chunks, (2 * p + 1) * width) * n / chunks,
+             hi  = std::min(chunks, (2 * p + 2) * width) * n / chunks;
+        std::merge(at(items, lo), at(items, mid), at(items, mid), at(items, hi), at(tmp, lo), less);
+      }
+    });
+    items.swap(tmp);
+  }
+}
+
+// Mixed radix weights of the coordinates from the most significant dimension in order, empty when keys would overflow
+inline auto sparse_weights(const nd::shape_array& shape, const nd::shape_array& order) {
+  nd::shape_array weights(shape.size(), 0);
+  size_t w = 1;
+  for (auto l = order.size(); l-- > 0;) {
+    weights[order[l]] = w;
+    if (l > 0 && shape[order[l]] > std::numeric_limits<size_t>::max() / w)
+      return nd::shape_array{};
+    w *= shape[order[l]];
+  } return weights;
+}
+
+// Entries in sorted order, their packed coordinates are kept when the shape allows it
+struct sparse_entries {
+  std::vector<size_t> perm, keys;
+  nd::shape_array shape, weights;
+
+  auto packed() const { return !weights.empty(); }
+
+  // Coordinate along dimension l of the k-th sorted entry, unpacked without touching the original ones
+  template <typename Row>
+  auto coord(size_t k, size_t l, Row& row) const { return packed() ? keys[k] / weights[l] % shape[l] : row(perm[k])[l]; }
+
+  template <typename Row>
+  auto same(size_t a, size_t b, Row& row) const {
+    return packed()
+      ? keys[a] == keys[b]
+      : std::equal(row(perm[a]), row(perm[a]) + shape.size(), row(perm[b]));
+  }
+};
+
+// Sorts the entries [0, n) with coordinates row(k) along order, ties keep their original order
+// so that the result does not depend on the number of threads
+// coordinates are packed in a single key when the shape allows it, compared one dimension after the other otherwise
+template <typename Row>
+auto sparse_permutation(size_t n, const nd::shape_array& shape, const nd::shape_array& order, Row&& row) {
+  sparse_entries e{std::vector<size_t>(n), {}, shape, sparse_weights(shape, order)};
+  if (e.packed()) {
+    std::vector< std::pair<size_t, size_t> > keys(n);
+    parallel_for(0, n, nd::parallel_grain, [&](size_t first, size_t last) {
+      for (auto k = first; k < last; ++k) {
+        size_t key = 0;
+        for (size_t l = 0; l < shape.size(); ++l) key += row(k)[l] * e.weights[l];
+        keys[k] = {key, k};
+      }
+    });
+    sparse_sort(keys, std::less<>{});
+
+    e.keys.resize(n);
+    parallel_for(0, n, nd::parallel_grain, [&](size_t first, size_t last) {
+      for (auto k = first; k < last; ++k) std::tie(e.keys[k], e.perm[k]) = keys[k];
+    });
+  } else {
+    std::iota(e.perm.begin(), e.perm.end(), size_t(0));
+    sparse_sort(e.perm, [&](size_t a, size_t b) {
+      return sparse_less(row(a), row(b), order) || (!sparse_less(row(b), row(a), order) && a < b);
+    });
+  } return e;
+}
+
+} // namespace detail
+
+// Coordinate sparse tensor, nonzeros are unique and sorted as in a dense ndarray (the first dimension is the fastest)
+// coordinates are stored by entry, those of nonzero k are coords()[k * dims()], ..., coords()[k * dims() + dims() - 1]
+template <typename T>
+class sparse_tensor {
+public:
+  using value_type = T;
+  using index_type = std::vector<size_t>;
+  using value_container = std::vector<value_type>;
+
+  sparse_tensor() = default;
+  explicit sparse_tensor(const nd::shape_array& shape)
+    : shape_{shape} {}
+  explicit sparse_tensor(const nd::shape_array& shape, const index_type& coords, const value_container& values);
+
+  // Same nonzeros as pattern with other values
+  template <typename U>
+  explicit sparse_tensor(const sparse_tensor<U>& pattern, value_container values)
+    : shape_{pattern.shape()}
+    , coords_{pattern.coords()}
+    , values_{std::move(values)} {
+    assert(values_.size() == pattern.nnz() && "Invalid sparse tensor, values do not match the pattern");
+  }
+
+  template <typename Arr>
+  explicit sparse_tensor(const ndarray_base<Arr>& arr, value_type threshold = 0);
+
+  auto dims() const  { return shape_.size(); }
+  auto& shape() const { return shape_; }
+  auto nnz() const   { return values_.size(); }
+  auto size() const  { return std::accumulate(shape_.begin(), shape_.end(), size_t(1), std::multiplies<>{}); }
+
+  auto index(size_t k, size_t d) const { return coords_[k * dims() + d]; }
+  auto& coords() const { return coords_; }
+  auto& values() const { return values_; }
+  auto& values()       { return values_; }
+
+  auto operator()(const nd::shape_array& idx) const -> value_type;
+  template <typename... Id>
+  auto operator()(Id... ids) const { return (*this)(nd::shape_array{size_t(ids)...}); }
+
+  auto dense() const -> ndarray<value_type>;
+
+private:
+  nd::shape_array shape_;
+
+  index_type coords_;
+  value_container values_;
+};
+
+// Entries are sorted on the job pool, duplicates are summed in their original order
+template <typename T>
+sparse_tensor<T>::sparse_tensor(const nd::shape_array& shape, const index_type& coords, const value_container& values)
+  : shape_{shape} {
+  assert(coords.size() == values.size() * dims() && "Invalid sparse tensor, coordinates do not match the values");
+
+  auto n = values.size(), d = dims();
+  auto row = [&coords, d](size_t k) { return coords.data() + k * d; };
+  parallel_for(0, n, nd::parallel_grain, [&](size_t first, size_t last) {
+    for (auto k = first; k < last; ++k)
+      for (size_t l = 0; l < d; ++l)
+        assert(row(k)[l] < shape_[l] && "Invalid sparse tensor entry");
+  });
+  auto e = detail::sparse_permutation(n, shape_, detail::sparse_order(d), row);
+
+  // Slot of every sorted entry, a new one starts where coordinates change
+  std::vector<size_t> slot(n);
+  parallel_for(0, n, nd::parallel_grain, [&](size_t first, size_t last) {
+    for (auto k = first; k < last; ++k)
+      slot[k] = k == 0 || !e.same(k - 1, k, row);
+  });
+  std::partial_sum(slot.begin(), slot.end(), slot.begin());
+
+  auto unique = n ? slot.back() : 0;
+  coords_.resize(unique * d);
+  values_.resize(unique);
+  parallel_for(0, n, nd::parallel_grain, [&](size_t first, size_t last) {
+    for (auto k = first; k < last; ++k) {
+      if (k > 0 && slot[k - 1] == slot[k])
+        continue;
+      auto s = slot[k] - 1;
+      for (size_t l = 0; l < d; ++l) coords_[s * d + l] = e.coord(k, l, row);
+      auto v = values[e.perm[k]];
+      for (auto j = k + 1; j < n && slot[j] == slot[k]; ++j) v += values[e.perm[j]];
+      values_[s] = v;
+    }
+  });
+}
+
+template <typename T>
+template <typename Arr>
+sparse_tensor<T>::sparse_tensor(const ndarray_base<Arr>& arr, value_type threshold)
+  : shape_{arr.shape()} {
+  const ndarray<value_type> x{arr};
+
+  // Dense order is the sparse one, the coordinates are counted along
+  nd::shape_array idx(dims(), 0);
+  for (size_t i = 0; i < x.size(); ++i) {
+    if (std::abs(x(i)) > threshold)
+      coords_.insert(coords_.end(), idx.begin(), idx.end()),
+      values_.push_back(x(i));
+    for (size_t l = 0; l < dims() && ++idx[l] == shape_[l]; ++l) idx[l] = 0;
+  }
+}
+
+template <typename T>
+auto sparse_tensor<T>::operator()(const nd::shape_array& idx) const -> value_type {
+  assert(idx.size() == dims() && "Invalid sparse tensor subscript");
+
+  auto d = dims();
+  auto order = detail::sparse_order(d);
+  size_t lo = 0, hi = nnz();
+  while (lo < hi) {
+    auto mid = (lo + hi) / 2;
+    if (detail::sparse_less(coords_.data() + mid * d, idx.begin(), order)) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo != nnz() && std::equal(idx.begin(), idx.end(), coords_.begin() + std::ptrdiff_t(lo * d))
+    ? values_[lo]
+    : value_type(0);
+}
+
+template <typename T>
+auto sparse_tensor<T>::dense() const -> ndarray<value_type> {
+  ndarray<value_type> x{shape_};
+  auto strides = nd::dense_strides(shape_);
+  parallel_for(0, nnz(), nd::parallel_grain, [&](size_t first, size_t last) {
+    for (auto k = first; k < last; ++k) {
+      std::ptrdiff_t o = 0;
+      for (size_t l = 0; l < dims(); ++l) o += std::ptrdiff_t(index(k, l)) * strides[l];
+      x.buffer()[o] = values_[k];
+    }
+  }); return x;
+}
+
+// Compressed sparse fiber tensor, the nonzero coordinates form a tree along a mode order, from the root mode to the leaf mode
+// nodes of a level hold their coordinate along that mode, children of node i of level l are [ptr(l)[i], ptr(l)[i + 1]) of level l + 1
+template <typename T>
+class csf_tensor {
+public:
+  using value_type = T;
+  using index_type = std::vector<size_t>;
+  using value_container = std::vector<value_type>;
+
+  // The default order is the dense one, the last dimension at the root
+  explicit csf_tensor(const sparse_tensor<T>& coo, const nd::shape_array& order = {});
+
+  auto dims() const   { return shape_.size(); }
+  auto& shape() const { return shape_; }
+  auto& order() const { return order_; }
+  auto nnz() const    { return values_.size(); }
+
+  auto& ids(size_t level) const { return ids_[level]; }
+  auto& ptr(size_t level) const { return ptr_[level]; }
+  auto& values() const { return values_; }
+  auto& values()       { return values_; }
+
+  auto coo() const -> sparse_tensor<T>;
+  auto dense() const { return coo().dense(); }
+
+  // fn(path, first, last) on every fiber of leaves [first, last), path holds the coordinates of the other levels
+  template <typename Fn>
+  void fibers(Fn&& fn) const;
+
+private:
+  template <typename Fn>
+  void walk(size_t level, size_t node, nd::shape_array& path, Fn& fn) const;
+
+  nd::shape_array shape_, order_;
+
+  std::vector<index_type> ids_, ptr_;
+  value_container values_;
+};
+
+template <typename T>
+csf_tensor<T>::csf_tensor(const sparse_tensor<T>& coo, const nd::shape_array& order)
+  : shape_{coo.shape()}
+  , order_{order.empty() ? detail::sparse_order(coo.dims()) : order}
+  , ids_(coo.dims())
+  , ptr_(coo.dims() ? coo.dims() - 1 : 0) {
+  auto d = dims(), n = coo.nnz();
+  assert(order_.size() == d && "Invalid fiber order, one mode per dimension");
+
+  auto row = [&coo, d](size_t k) { return coo.coords().data() + k * d; };
+  auto natural = std::equal(order_.begin(), order_.end(), detail::sparse_order(d).begin());
+  auto e = natural
+    ? detail::sparse_entries{}
+    : detail::sparse_permutation(n, shape_, order_, row);
+  auto coord = [&](size_t k, size_t l) { return natural ? row(k)[l] : e.coord(k, l, row); };
+
+  // A node is opened at the first level where the coordinates of an entry differ from the previous one
+  values_.reserve(n);
+  for (size_t k = 0; k < n; ++k) {
+    size_t l = 0;
+    if (k > 0)
+      while (l + 1 < d && coord(k - 1, order_[l]) == coord(k, order_[l])) ++l;
+    for (; l < d; ++l) {
+      if (l + 1 < d) ptr_[l].push_back(ids_[l + 1].size());
+      ids_[l].push_back(coord(k, order_[l]));
+    }
+    values_.push_back(coo.values()[natural ? k : e.perm[k]]);
+  }
+  for (size_t l = 0; l + 1 < d; ++l) ptr_[l].push_back(ids_[l + 1].size());
+}
+
+template <typename T>
+template <typename Fn>
+void csf_tensor<T>::walk(size_t level, size_t node, nd::shape_array& path, Fn& fn) const {
+  path[order_[level]] = ids_[level][node];
+  if (level + 2 == dims()) {
+    fn(path, ptr_[level][node], ptr_[level][node + 1]);
+    return;
+  }
+  for (auto c = ptr_[level][node]; c < ptr_[level][node + 1]; ++c)
+    walk(level + 1, c, path, fn);
+}
+
+template <typename T>
+template <typename Fn>
+void csf_tensor<T>::fibers(Fn&& fn) const {
+  nd::shape_array path(dims(), 0);
+  if (dims() < 2) {
+    fn(path, size_t(0), nnz());
+    return;
+  }
+  for (size_t r = 0; r < ids_[0].size(); ++r)
+    walk(0, r, path, fn);
+}
+
+template <typename T>
+auto csf_tensor<T>::coo() const -> sparse_tensor<T> {
+  typename sparse_tensor<T>::index_type coords;
+  coords.reserve(nnz() * dims());
+  fibers([&](const nd::shape_array& path, size_t first, size_t last) {
+    for (auto k = first; k < last; ++k) {
+      auto idx = path;
+      if (dims()) idx[order_[dims() - 1]] = ids_.back()[k];
+      coords.insert(coords.end(), idx.begin(), idx.end());
+    }
+  });
+  return sparse_tensor<T>{shape_, coords, values_};
+}
+
+// Element-wise with dense operands, products and quotients keep the nonzeros, sums and differences are dense
+namespace detail {
+
+template <typename T, typename Arr, typename Fn>
+auto sparse_gather(const sparse_tensor<T>& sp, const ndarray_base<Arr>& arr, Fn&& fn) {
+  using R = std::common_type_t<T, ndarray_t<Arr>>;
+  assert(std::equal(sp.shape().begin(), sp.shape().end(), arr.shape().begin(), arr.shape().end()) && "Incoherent sparse tensor and ndarray shapes");
+
+  return nd::detail::with_layout(arr, [&](const auto& v) {
+    std::vector<R> values(sp.nnz());
+    parallel_for(0, sp.nnz(), nd::parallel_grain, [&](size_t first, size_t last) {
+      for (auto k = first; k < last; ++k) {
+        std::ptrdiff_t o = 0;
+        for (size_t l = 0; l < sp.dims(); ++l) o += std::ptrdiff_t(sp.index(k, l)) * v.strides()[l];
+        values[k] = fn(R(sp.values()[k]), R(v.buffer()[o]));
+      }
+    }); return sparse_tensor<R>{sp, std::move(values)};
+  });
+}
+
+template <typename T, typename Arr, typename Fn>
+auto sparse_scatter(const sparse_tensor<T>& sp, const ndarray_base<Arr>& arr, Fn&& fn) {
+  using R = std::common_type_t<T, ndarray_t<Arr>>;
+  assert(std::equal(sp.shape().begin(), sp.shape().end(), arr.shape().begin(), arr.shape().end()) && "Incoherent sparse tensor and ndarray shapes");
+
+  ndarray<R> x{arr};
+  auto strides = nd::dense_strides(sp.shape());
+  parallel_for(0, sp.nnz(), nd::parallel_grain, [&](size_t first, size_t last) {
+    for (auto k = first; k < last; ++k) {
+      std::ptrdiff_t o = 0;
+      for (size_t l = 0; l < sp.dims(); ++l) o += std::ptrdiff_t(sp.index(k, l)) * strides[l];
+      auto& r = x.buffer()[o];
+      r = fn(R(sp.values()[k]), r);
+    }
+  }); return x;
+}
+
+} // namespace detail
+
+template <typename T, typename Arr> auto operator*(const sparse_tensor<T>& lhs, const ndarray_base<Arr>& rhs) { return detail::sparse_gather(lhs, rhs, std::multiplies<>{}); }
+template <typename T, typename Arr> auto operator*(const ndarray_base<Arr>& lhs, const sparse_tensor<T>& rhs) { return detail::sparse_gather(rhs, lhs, std::multiplies<>{}); }
+template <typename T, typename Arr> auto operator/(const sparse_tensor<T>& lhs, const ndarray_base<Arr>& rhs) { return detail::sparse_gather(lhs, rhs, std::divides<>{}); }
+
+template <typename T, typename Arr> auto operator+(const sparse_tensor<T>& lhs, const ndarray_base<Arr>& rhs) { return detail::sparse_scatter(lhs, rhs, std::plus<>{}); }
+template <typename T, typename Arr> auto operator+(const ndarray_base<Arr>& lhs, const sparse_tensor<T>& rhs) { return detail::sparse_scatter(rhs, lhs, std::plus<>{}); }
+template <typename T, typename Arr> auto operator-(const sparse_tensor<T>& lhs, const ndarray_base<Arr>& rhs) { return detail::sparse_scatter(lhs, -rhs, std::plus<>{}); }
+template <typename T, typename Arr> auto operator-(const ndarray_base<Arr>& lhs, const sparse_tensor<T>& rhs) { return detail::sparse_scatter(rhs, lhs, [](auto s, auto x) { return x - s; }); }
+
+template <typename T, typename S, typename = std::enable_if_t< std::is_arithmetic_v<S> >>
+auto operator*(const sparse_tensor<T>& lhs, S rhs) {
+  using R = std::common_type_t<T, S>;
+  std::vector<R> values(lhs.nnz());
+  std::transform(lhs.values().begin(), lhs.values().end(), values.begin(), [rhs](auto v) { return R(v) * R(rhs); });
+  return sparse_tensor<R>{lhs, std::move(values)};
+}
+
+template <typename T, typename S, typename = std::enable_if_t< std::is_arithmetic_v<S> >> auto operator*(S lhs, const sparse_tensor<T>& rhs) { return rhs * lhs; }
+template <typename T, typename S, typename = std::enable_if_t< std::is_arithmetic_v<S> >> auto operator/(const sparse_tensor<T>& lhs, S rhs) { return lhs * (std::common_type_t<T, S>(1) / rhs); }
+
+// Mode-n product, y(..., j, ...) = sum_i x(..., i, ...) u(j, i) along mode n
+// every nonzero fiber along the mode becomes dense, the mode must be the leaf of the tree
+template <typename T, typename Mat>
+auto mode_product(const csf_tensor<T>& x, const matrix_base<Mat>& u, size_t mode) {
+  using R = std::common_type_t<T, matrix_t<Mat>>;
+  assert(mode < x.dims() && x.order()[x.dims() - 1] == mode && "Invalid mode product, the mode must be the leaf of the fiber tree");
+  assert(u.cols() == x.shape()[mode] && "Incoherent mode product, matrix columns must match the mode dimension");
+
+  auto d = x.dims(), rows = u.rows(), cols = u.cols();
+
+  // Columns of u are accumulated, they are stored contiguously
+  std::vector<R> ut(cols * rows);
+  for (size_t i = 0; i < cols; ++i)
+    for (size_t j = 0; j < rows; ++j) ut[i * rows + j] = R(u(j, i));
+
+  std::vector< std::tuple<nd::shape_array, size_t, size_t> > fibers;
+  x.fibers([&fibers](const nd::shape_array& path, size_t first, size_t last) { fibers.emplace_back(path, first, last); });
+
+  typename sparse_tensor<R>::index_type coords(fibers.size() * rows * d);
+  std::vector<R> values(fibers.size() * rows, R(0));
+  parallel_for(0, fibers.size(), std::max<size_t>(1, nd::parallel_grain / std::max<size_t>(1, rows)), [&](size_t first, size_t last) {
+    for (auto f = first; f < last; ++f) {
+      auto& [path, lo, hi] = fibers[f];
+      auto y = values.data() + f * rows;
+      for (auto k = lo; k < hi; ++k) {
+        auto v = R(x.values()[k]);
+        auto c = ut.data() + x.ids(d - 1)[k] * rows;
+        for (size_t j = 0; j < rows; ++j) y[j] += v * c[j];
+      }
+      for (size_t j = 0; j < rows; ++j) {
+        auto idx = coords.begin() + std::ptrdiff_t((f * rows + j) * d);
+        std::copy(path.begin(), path.end(), idx);
+        idx[std::ptrdiff_t(mode)] = j;
+      }
+    }
+  });
+
+  auto shape = x.shape();
+  shape[mode] = rows;
+  return sparse_tensor<R>{shape, coords, values};
+}
+
+// The fibers along the mode are gathered first
+template <typename T, typename Mat>
+auto mode_product(const sparse_tensor<T>& x, const matrix_base<Mat>& u, size_t mode) {
+  assert(mode < x.dims() && "Invalid mode product, mode out of range");
+
+  nd::shape_array order;
+  for (auto l : detail::sparse_order(x.dims()))
+    if (l != mode) order.push_back(l);
+  order.push_back(mode);
+  return mode_product(csf_tensor<T>{x, order}, u, mode);
+}
+
+} // namespace ig
+
+#endif // IG_MATH_SPARSETENSOR_H
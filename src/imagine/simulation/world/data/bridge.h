@@ -13,6 +13,7 @@
 #include "imagine/math/theory/graph.h"
 #include "imagine/math/theory/matrix.h"
 #include "imagine/math/theory/ndarray.h"
+#include "imagine/math/theory/any_ndarray.h"
 
 #include "imagine/math/geom/representation/mesh.h"
 
@@ -106,8 +107,9 @@ auto bridge<T, Format, Container, Params...>::load(std::istream& in, const std::
 // extending:
 //   provide format in {enum}
 //   define corresponding validate/read/write functions in table
-enum class image_format { jpeg, png, bmp, pam, hdr }; using image_bridge = bridge<ndarray<uint8_t>, image_format>;
-enum class audio_format { flac, mp3, ogg, wav };      using audio_bridge = bridge<ndarray<int16_t>, audio_format>;
+//   signals are runtime typed, each format returns its native samples without conversion
+enum class image_format { jpeg, png, bmp, pam, hdr }; using image_bridge = bridge<any_ndarray, image_format>;
+enum class audio_format { flac, mp3, ogg, wav };      using audio_bridge = bridge<any_ndarray, audio_format>;
 enum class video_format { x264 };
 
 // custom loaders
@@ -95,10 +95,10 @@ jpeg jpeg_readp_impl(std::istream& stream, const image_bridge::parameters&) {
        height   = jpeg_ptr.output_height;
 
   auto image =
-  std::make_unique<jpeg_t>(std::initializer_list<size_t>{channels, width, height});
+  std::make_unique<jpeg_t>(dtype::u8, nd::shape_array{channels, width, height});
 
   while (jpeg_ptr.output_scanline < height) {
-    auto r = image->buffer() + (width * channels * jpeg_ptr.output_scanline);
+    auto r = static_cast<uint8_t*>(image->data()) + (width * channels * jpeg_ptr.output_scanline);
     jpeg_read_scanlines(
       &jpeg_ptr,
       (JSAMPARRAY)&r,
@@ -148,9 +148,12 @@ bool jpeg_write_impl(std::ostream& stream, const image_bridge::parameters&, cons
     }
   };
 
-  auto channels = image[0],
-       width    = image[1],
-       height   = image[2];
+  if (image.dims() != 3 || !image.is<uint8_t>())
+    return false;
+
+  auto channels = image.shape()[0],
+       width    = image.shape()[1],
+       height   = image.shape()[2];
 
   jpeg_ptr.image_width = width, jpeg_ptr.image_height = height;
 
@@ -173,7 +176,7 @@ bool jpeg_write_impl(std::ostream& stream, const image_bridge::parameters&, cons
   jpeg_start_compress(&jpeg_ptr, TRUE);
 
   while (jpeg_ptr.next_scanline < height) {
-    auto r = image.buffer() + (width * channels * jpeg_ptr.next_scanline);
+    auto r = static_cast<const uint8_t*>(image.data()) + (width * channels * jpeg_ptr.next_scanline);
     jpeg_write_scanlines(
       &jpeg_ptr,
       (JSAMPARRAY)&r,
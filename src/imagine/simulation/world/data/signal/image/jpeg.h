@@ -16,7 +16,7 @@ namespace detail {
 using jpeg   = image_bridge::data;
 using jpeg_t = image_bridge::resource;
 // libjpeg (9b)
-// supports lossy grayscale and rgb
+// supports lossy grayscale and rgb, 8 bits per sample (u8)
 // extensions -> .jpg, .jpeg, .jpe, .jif, .jfif, .jfi
 // validate -> ff d8 ff
 // standard -> ISO/IEC 10918
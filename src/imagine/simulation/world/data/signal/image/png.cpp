@@ -29,6 +29,12 @@ void png_writeproc(png_structp png_ptr,
 void png_flushproc(png_structp png_ptr);
 void png_message(png_structp png_ptr, const char* msg);
 
+// Samples of 16 bits are big endian in the file
+bool png_host_big() {
+  const uint16_t probe = 1;
+  return *reinterpret_cast<const uint8_t*>(&probe) == 0;
+}
+
 // Png interface implementation - validate - read - write
 bool png_validate(std::istream& stream) {
   png_byte png_sig[8];
@@ -56,7 +62,11 @@ png png_readp_impl(std::istream& stream, const image_bridge::parameters&) {
 
   png_set_palette_to_rgb(png_ptr);
   png_set_expand_gray_1_2_4_to_8(png_ptr);
-  png_set_scale_16(png_ptr);
+
+  // 16-bit samples are kept, in host order
+  auto wide = png_get_bit_depth(png_ptr, info_ptr) == 16;
+  if (wide && !png_host_big())
+    png_set_swap(png_ptr);
 
   png_read_update_info(png_ptr, info_ptr);
 
@@ -65,12 +75,13 @@ png png_readp_impl(std::istream& stream, const image_bridge::parameters&) {
        height   = png_get_image_height(png_ptr, info_ptr);
 
   auto image =
-  std::make_unique<png_t>(std::initializer_list<size_t>{channels, width, height});
+  std::make_unique<png_t>(wide ? dtype::u16 : dtype::u8, nd::shape_array{channels, width, height});
 
+  auto row = width * channels * image->item();
   for (png_uint_32 j = 0; j < height; ++j)
     png_read_row(
       png_ptr,
-      reinterpret_cast<uint8_t*>(image->buffer() + (width * channels * j)),
+      static_cast<uint8_t*>(image->data()) + row * j,
       nullptr);
 
   png_read_end(png_ptr, info_ptr);
@@ -91,9 +102,13 @@ bool png_write_impl(std::ostream& stream, const image_bridge::parameters&, const
       png_message);
   png_infop info_ptr = png_create_info_struct(png_ptr);
 
-  auto channels = image[0],
-       width    = image[1],
-       height   = image[2];
+  if (image.dims() != 3 || (!image.is<uint8_t>() && !image.is<uint16_t>()))
+    return false;
+
+  auto channels = image.shape()[0],
+       width    = image.shape()[1],
+       height   = image.shape()[2];
+  auto depth    = image.is<uint16_t>() ? 16 : 8;
 
   int colortype;
   switch (channels) {
@@ -115,7 +130,7 @@ bool png_write_impl(std::ostream& stream, const image_bridge::parameters&, const
     png_ptr,
     info_ptr,
     width, height,
-    std::numeric_limits<uint8_t>::digits, colortype,
+    depth, colortype,
     PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,  PNG_FILTER_TYPE_BASE);
 
   png_set_write_fn(
@@ -124,11 +139,14 @@ bool png_write_impl(std::ostream& stream, const image_bridge::parameters&, const
     png_writeproc,
     png_flushproc);
   png_write_info(png_ptr, info_ptr);
+  if (depth == 16 && !png_host_big())
+    png_set_swap(png_ptr);
 
+  auto row = width * channels * image.item();
   for (png_uint_32 j = 0; j < height; ++j)
     png_write_row(
       png_ptr,
-      reinterpret_cast<const uint8_t*>(image.buffer() + (width * channels * j)));
+      static_cast<const uint8_t*>(image.data()) + row * j);
 
   png_write_end(png_ptr, info_ptr);
   png_destroy_write_struct(
@@ -16,7 +16,7 @@ namespace detail {
 using png   = image_bridge::data;
 using png_t = image_bridge::resource;
 // libpng (1.6.28)
-// supports lossless grayscale and rgb with alpha channel
+// supports lossless grayscale and rgb with alpha channel, 8 (u8) or 16 (u16) bits per sample
 // extensions -> .png
 // validate -> 89 50 4e 47 0d 0a 1a 0a
 // standard -> ISO/IEC 15948
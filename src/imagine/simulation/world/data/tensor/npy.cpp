@@ -0,0 +1,368 @@
+/*
+ Imagine v0.1
+ [bridge]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/simulation/world/data/tensor/npy.h"
+
+extern "C"
+{
+#include "png/zlib.h"
+}
+
+namespace ig {
+namespace {
+
+constexpr char npy_magic[] = "\x93NUMPY";
+
+constexpr uint32_t zip_local   = 0x04034b50;
+constexpr uint32_t zip_central = 0x02014b50;
+constexpr uint32_t zip_end     = 0x06054b50;
+constexpr uint32_t zip64_end   = 0x06064b50;
+constexpr uint32_t zip64_loc   = 0x07064b50;
+constexpr uint32_t zip_limit   = 0xffffffff;
+
+bool host_big() {
+  const uint16_t probe = 1;
+  return *reinterpret_cast<const uint8_t*>(&probe) == 0;
+}
+
+// Little endian fields
+template <size_t N>
+void put(std::ostream& out, uint64_t v) {
+  char b[N];
+  for (size_t i = 0; i < N; ++i) b[i] = char((v >> (8 * i)) & 0xff);
+  out.write(b, N);
+}
+
+template <size_t N>
+uint64_t get(const char* p) {
+  uint64_t v = 0;
+  for (size_t i = 0; i < N; ++i) v |= uint64_t(uint8_t(p[i])) << (8 * i);
+  return v;
+}
+
+template <size_t N>
+uint64_t get(std::istream& in) {
+  char b[N];
+  if (!in.read(b, N))
+    throw std::runtime_error{"[Npz] Truncated archive"};
+  return get<N>(b);
+}
+
+// Value of a key in the header dictionary, as written by numpy
+std::string npy_field(const std::string& dict, const std::string& key) {
+  auto k = dict.find("'" + key + "'");
+  auto c = k == std::string::npos ? k : dict.find(':', k);
+  if (c == std::string::npos)
+    throw std::runtime_error{"[Npy] Invalid header, missing " + key};
+
+  auto first = dict.find_first_not_of(' ', c + 1);
+  auto close = dict[first] == '(' ? ')' : dict[first] == '\'' ? '\'' : ',';
+  auto last = dict.find(close, first + 1);
+  return dict.substr(first, last == std::string::npos ? last : last - first + 1);
+}
+
+uint32_t crc(const std::string& bytes) {
+  uLong c = crc32(0L, Z_NULL, 0);
+  constexpr size_t chunk = size_t(1) << 30;
+  for (size_t i = 0; i < bytes.size(); i += chunk)
+    c = crc32(c, reinterpret_cast<const Bytef*>(bytes.data() + i), uInt(std::min(chunk, bytes.size() - i)));
+  return uint32_t(c);
+}
+
+} // namespace
+
+auto npy_read_header(std::istream& in) -> npy_header {
+  char pre[8];
+  if (!in.read(pre, 8) || std::memcmp(pre, npy_magic, 6) != 0)
+    throw std::runtime_error{"[Npy] Invalid magic string"};
+
+  auto major = uint8_t(pre[6]);
+  auto width = major == 1 ? 2 : 4;
+  char len[4] = {};
+  in.read(len, width);
+
+  std::string dict(width == 2 ? get<2>(len) : get<4>(len), '\0');
+  if (!in.read(dict.data(), std::streamsize(dict.size())))
+    throw std::runtime_error{"[Npy] Truncated header"};
+
+  npy_header header{};
+  header.data = 8 + width + dict.size();
+
+  auto descr = npy_field(dict, "descr");
+  if (descr.size() < 4)
+    throw std::runtime_error{"[Npy] Invalid header, unsupported descr " + descr};
+
+  auto order = descr[1];
+  header.kind = descr[2];
+  header.item = std::stoul(descr.substr(3, descr.size() - 4));
+  header.swapped = header.item > 1 && ((order == '<' && host_big()) || (order == '>' && !host_big()));
+  header.fortran = npy_field(dict, "fortran_order").compare(0, 4, "True") == 0;
+
+  auto shape = npy_field(dict, "shape");
+  for (size_t i = 1; i < shape.size();) {
+    auto d = shape.find_first_of("0123456789", i);
+    if (d == std::string::npos) break;
+    auto e = shape.find_first_not_of("0123456789", d);
+    header.shape.push_back(std::stoull(shape.substr(d, e - d)));
+    i = e;
+  } return header;
+}
+
+void npy_write_header(std::ostream& out, const npy_header& header) {
+  std::ostringstream dict;
+  dict << "{'descr': '" << (header.item == 1 ? '|' : host_big() ? '>' : '<') << header.kind << header.item
+       << "', 'fortran_order': " << (header.fortran ? "True" : "False")
+       << ", 'shape': (";
+  for (size_t k = 0; k < header.shape.size(); ++k)
+    dict << (k ? ", " : "") << header.shape[k];
+  dict << (header.shape.size() == 1 ? ",), }" : "), }");
+
+  // Elements start on a 64 bytes boundary
+  auto str = dict.str();
+  auto width = str.size() + 11 < 65536 ? 2 : 4;
+  auto pad = 63 - (8 + width + str.size()) % 64;
+  str.append(pad, ' ').push_back('\n');
+
+  out.write(npy_magic, 6);
+  out.put(char(width == 2 ? 1 : 2)).put(0);
+  if (width == 2) put<2>(out, str.size());
+  else            put<4>(out, str.size());
+  out.write(str.data(), std::streamsize(str.size()));
+}
+
+npz_writer::npz_writer(const std::string& filename)
+  : out_{filename, std::ios::binary} {
+  if (!out_.good())
+    throw std::runtime_error{"[Npz] Failed to create " + filename};
+}
+
+// Errors are only reported by an explicit close, a throwing destructor would terminate
+npz_writer::~npz_writer() {
+  try {
+    close();
+  } catch (...) {}
+}
+
+void npz_writer::add(const std::string& name, const std::string& npy) {
+  record r{name + ".npy", crc(npy), npy.size(), uint64_t(out_.tellp())};
+  auto wide = r.size >= zip_limit;
+
+  // Padding field so that the elements can be mapped in place
+  auto head = r.offset + 30 + r.name.size() + (wide ? 20 : 0) + 4;
+  auto pad = (64 - head % 64) % 64;
+
+  put<4>(out_, zip_local);
+  put<2>(out_, wide ? 45 : 20);
+  put<2>(out_, 0); put<2>(out_, 0);               // flags, stored
+  put<2>(out_, 0); put<2>(out_, 0x21);            // 1980-01-01
+  put<4>(out_, r.crc);
+  put<4>(out_, wide ? zip_limit : r.size);
+  put<4>(out_, wide ? zip_limit : r.size);
+  put<2>(out_, r.name.size());
+  put<2>(out_, (wide ? 20 : 0) + 4 + pad);
+  out_.write(r.name.data(), std::streamsize(r.name.size()));
+  if (wide) {
+    put<2>(out_, 1); put<2>(out_, 16);
+    put<8>(out_, r.size); put<8>(out_, r.size);
+  }
+  put<2>(out_, 0xd935); put<2>(out_, pad);
+  out_.write(std::string(pad, '\0').data(), std::streamsize(pad));
+
+  out_.write(npy.data(), std::streamsize(npy.size()));
+  records_.push_back(r);
+}
+
+void npz_writer::close() {
+  if (!out_.is_open())
+    return;
+
+  auto start = uint64_t(out_.tellp());
+  for (auto& r : records_) {
+    auto wide_size = r.size >= zip_limit;
+    auto wide_off = r.offset >= zip_limit;
+    auto extra = (wide_size ? 16 : 0) + (wide_off ? 8 : 0);
+
+    put<4>(out_, zip_central);
+    put<2>(out_, 45); put<2>(out_, extra ? 45 : 20);
+    put<2>(out_, 0); put<2>(out_, 0);
+    put<2>(out_, 0); put<2>(out_, 0x21);
+    put<4>(out_, r.crc);
+    put<4>(out_, wide_size ? zip_limit : r.size);
+    put<4>(out_, wide_size ? zip_limit : r.size);
+    put<2>(out_, r.name.size());
+    put<2>(out_, extra ? extra + 4 : 0);
+    put<2>(out_, 0); put<2>(out_, 0); put<2>(out_, 0); // comment, disk, internal attributes
+    put<4>(out_, 0);
+    put<4>(out_, wide_off ? zip_limit : r.offset);
+    out_.write(r.name.data(), std::streamsize(r.name.size()));
+    if (extra) {
+      put<2>(out_, 1); put<2>(out_, extra);
+      if (wide_size) put<8>(out_, r.size), put<8>(out_, r.size);
+      if (wide_off)  put<8>(out_, r.offset);
+    }
+  }
+
+  auto end = uint64_t(out_.tellp());
+  auto count = uint64_t(records_.size());
+  auto size = end - start;
+  auto wide = count >= 0xffff || start >= zip_limit || size >= zip_limit;
+  if (wide) {
+    put<4>(out_, zip64_end); put<8>(out_, 44);
+    put<2>(out_, 45); put<2>(out_, 45);
+    put<4>(out_, 0); put<4>(out_, 0);
+    put<8>(out_, count); put<8>(out_, count);
+    put<8>(out_, size);  put<8>(out_, start);
+
+    put<4>(out_, zip64_loc); put<4>(out_, 0);
+    put<8>(out_, end);       put<4>(out_, 1);
+  }
+
+  put<4>(out_, zip_end);
+  put<2>(out_, 0); put<2>(out_, 0);
+  put<2>(out_, wide ? 0xffff : count);
+  put<2>(out_, wide ? 0xffff : count);
+  put<4>(out_, wide ? zip_limit : size);
+  put<4>(out_, wide ? zip_limit : start);
+  put<2>(out_, 0);
+
+  out_.close();
+}
+
+npz_reader::npz_reader(const std::string& filename)
+  : filename_{filename} {
+  std::ifstream in{filename, std::ios::binary | std::ios::ate};
+  if (!in.good())
+    throw std::runtime_error{"[Npz] Failed to open " + filename};
+
+  // End of central directory, followed by at most a 64k comment
+  auto length = uint64_t(in.tellg());
+  auto tail = std::min<uint64_t>(length, 65536 + 22);
+  std::string buf(tail, '\0');
+  in.seekg(std::streamoff(length - tail));
+  in.read(buf.data(), std::streamsize(tail));
+
+  auto e = std::string::npos;
+  for (auto i = tail < 22 ? 0 : tail - 22 + 1; i-- > 0;)
+    if (get<4>(buf.data() + i) == zip_end) { e = i; break; }
+  if (e == std::string::npos)
+    throw std::runtime_error{"[Npz] Invalid archive, missing end of central directory"};
+
+  uint64_t count = get<2>(buf.data() + e + 10);
+  uint64_t start = get<4>(buf.data() + e + 16);
+  if (start == zip_limit || count == 0xffff) {
+    auto loc = length - tail + e - 20;
+    in.seekg(std::streamoff(loc));
+    if (get<4>(in) != zip64_loc)
+      throw std::runtime_error{"[Npz] Invalid archive, missing zip64 locator"};
+    get<4>(in);
+    in.seekg(std::streamoff(get<8>(in)));
+    if (get<4>(in) != zip64_end)
+      throw std::runtime_error{"[Npz] Invalid archive, missing zip64 end of central directory"};
+    in.seekg(28, std::ios::cur);
+    count = get<8>(in);
+    get<8>(in);
+    start = get<8>(in);
+  }
+
+  in.seekg(std::streamoff(start));
+  for (uint64_t k = 0; k < count; ++k) {
+    char h[46];
+    if (!in.read(h, 46) || get<4>(h) != zip_central)
+      throw std::runtime_error{"[Npz] Invalid archive, corrupted central directory"};
+
+    entry en{uint16_t(get<2>(h + 10)), get<4>(h + 20), get<4>(h + 24), get<4>(h + 42)};
+    std::string name(get<2>(h + 28), '\0'), extra(get<2>(h + 30), '\0');
+    in.read(name.data(), std::streamsize(name.size()));
+    in.read(extra.data(), std::streamsize(extra.size()));
+    in.seekg(std::streamoff(get<2>(h + 32)), std::ios::cur);
+
+    // Zip64 fields are only present for the saturated ones, in this order
+    for (size_t i = 0; i + 4 <= extra.size();) {
+      auto id = get<2>(extra.data() + i), len = get<2>(extra.data() + i + 2);
+      if (id == 1) {
+        auto p = extra.data() + i + 4;
+        if (en.size   == zip_limit) en.size   = get<8>(p), p += 8;
+        if (en.csize  == zip_limit) en.csize  = get<8>(p), p += 8;
+        if (en.offset == zip_limit) en.offset = get<8>(p);
+      } i += 4 + len;
+    }
+
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0)
+      name.resize(name.size() - 4);
+    entries_.emplace(name, en);
+  }
+}
+
+bool npz_reader::contains(const std::string& name) const {
+  return entries_.count(name) != 0;
+}
+
+auto npz_reader::names() const -> std::vector<std::string> {
+  std::vector<std::string> res;
+  for (auto& [name, en] : entries_) res.push_back(name);
+  return res;
+}
+
+auto npz_reader::find(const std::string& name) const -> const entry& {
+  auto it = entries_.find(name);
+  if (it == entries_.end())
+    throw std::runtime_error{"[Npz] Missing array " + name + " in " + filename_};
+  return it->second;
+}
+
+auto npz_reader::stored(const std::string& name) const -> uint64_t {
+  auto& en = find(name);
+  if (en.method != 0)
+    return 0;
+
+  std::ifstream in{filename_, std::ios::binary};
+  in.seekg(std::streamoff(en.offset));
+  char h[30];
+  if (!in.read(h, 30) || get<4>(h) != zip_local)
+    throw std::runtime_error{"[Npz] Invalid archive, corrupted local header"};
+  return en.offset + 30 + get<2>(h + 26) + get<2>(h + 28);
+}
+
+auto npz_reader::extract(const std::string& name) const -> std::string {
+  auto& en = find(name);
+  if (en.method != 0 && en.method != 8)
+    throw std::runtime_error{"[Npz] Unsupported compression method for " + name};
+
+  std::ifstream in{filename_, std::ios::binary};
+  in.seekg(std::streamoff(en.offset));
+  char h[30];
+  if (!in.read(h, 30) || get<4>(h) != zip_local)
+    throw std::runtime_error{"[Npz] Invalid archive, corrupted local header"};
+  in.seekg(std::streamoff(get<2>(h + 26) + get<2>(h + 28)), std::ios::cur);
+
+  std::string packed(en.csize, '\0');
+  if (!in.read(packed.data(), std::streamsize(packed.size())))
+    throw std::runtime_error{"[Npz] Truncated archive"};
+  if (en.method == 0)
+    return packed;
+
+  // Raw deflate stream, as written by numpy.savez_compressed
+  std::string npy(en.size, '\0');
+  z_stream zs{};
+  inflateInit2(&zs, -MAX_WBITS);
+  zs.next_in = reinterpret_cast<Bytef*>(packed.data());
+  zs.next_out = reinterpret_cast<Bytef*>(npy.data());
+
+  constexpr size_t chunk = size_t(1) << 30;
+  size_t in_left = packed.size(), out_left = npy.size();
+  auto res = Z_OK;
+  while (res == Z_OK) {
+    if (!zs.avail_in)  zs.avail_in  = uInt(std::min(chunk, in_left)),  in_left  -= zs.avail_in;
+    if (!zs.avail_out) zs.avail_out = uInt(std::min(chunk, out_left)), out_left -= zs.avail_out;
+    res = inflate(&zs, Z_NO_FLUSH);
+  } inflateEnd(&zs);
+
+  if (res != Z_STREAM_END)
+    throw std::runtime_error{"[Npz] Corrupted deflate stream for " + name};
+  return npy;
+}
+
+} // namespace ig
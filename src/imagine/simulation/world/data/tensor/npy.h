@@ -0,0 +1,309 @@
+/*
+ Imagine v0.1
+ [bridge]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#ifndef IG_SIMULATION_NPY_H
+#define IG_SIMULATION_NPY_H
+
+#include "imagine/ig.h"
+#include "imagine/envi/mapping.h"
+
+#include "imagine/math/theory/matrix.h"
+#include "imagine/math/theory/ndarray.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <vector>
+
+namespace ig {
+
+// NumPy array format (1.0 - 2.0)
+// supports bool, integer and floating point elements (f2 as float16) in either byte order, bfloat16 has no npy counterpart
+// extensions -> .npy, .npz (zip of .npy, stored or deflated)
+// validate -> 93 4e 55 4d 50 59
+// layout:
+//   ndarrays are written in fortran order with their own shape, the first index is the fastest on both sides
+//   c ordered files are read with their shape reversed, nd::transpose restores numpy subscripts
+//   matrices are written and read in c order
+struct npy_header {
+  char kind;        // b, i, u, f
+  size_t item;      // bytes per element
+  bool swapped;     // byte order differs from the host
+  bool fortran;
+  std::vector<size_t> shape;
+  size_t data;      // elements offset from the magic string
+
+  auto size() const {
+    return std::accumulate(
+      shape.begin(),
+      shape.end(),
+      size_t(1), std::multiplies<>{});
+  }
+};
+
+namespace detail {
+
+template <typename T>
+constexpr auto npy_kind() {
+  static_assert(!std::is_same_v<T, bfloat16>, "Unsupported npy element type, bfloat16 has no numpy dtype");
+  static_assert(std::is_arithmetic_v<T> || std::is_same_v<T, float16>, "Unsupported npy element type");
+  if constexpr (std::is_same_v<T, bool>)        return 'b';
+  else if constexpr (std::is_same_v<T, float16>)  return 'f';
+  else if constexpr (std::is_floating_point_v<T>) return 'f';
+  else if constexpr (std::is_signed_v<T>)         return 'i';
+  else                                            return 'u';
+}
+
+template <typename T>
+auto npy_native(const npy_header& header) {
+  return header.kind == npy_kind<T>() && header.item == sizeof(T) && !header.swapped;
+}
+
+template <typename T>
+auto npy_header_of(const std::vector<size_t>& shape, bool fortran) {
+  return npy_header{npy_kind<T>(), sizeof(T), false, fortran, shape, 0};
+}
+
+template <typename S, typename T>
+void npy_cast(char* src, T* dst, size_t n, bool swapped) {
+  for (size_t i = 0; i < n; ++i) {
+    auto p = src + i * sizeof(S);
+    if (swapped)
+      std::reverse(p, p + sizeof(S));
+
+    S v; std::memcpy(&v, p, sizeof(S));
+    dst[i] = static_cast<T>(v);
+  }
+}
+
+// Elements of any supported type are converted to T, the source bytes are swapped in place
+template <typename T>
+void npy_convert(const npy_header& header, char* src, T* dst, size_t n) {
+  auto s = header.swapped;
+  switch (header.kind) {
+  case 'b': return npy_cast<bool>(src, dst, n, s);
+  case 'f':
+    if (header.item == 2) return npy_cast<float16>(src, dst, n, s);
+    if (header.item == 4) return npy_cast<float>(src, dst, n, s);
+    if (header.item == 8) return npy_cast<double>(src, dst, n, s);
+    break;
+  case 'i':
+    if (header.item == 1) return npy_cast<int8_t> (src, dst, n, s);
+    if (header.item == 2) return npy_cast<int16_t>(src, dst, n, s);
+    if (header.item == 4) return npy_cast<int32_t>(src, dst, n, s);
+    if (header.item == 8) return npy_cast<int64_t>(src, dst, n, s);
+    break;
+  case 'u':
+    if (header.item == 1) return npy_cast<uint8_t> (src, dst, n, s);
+    if (header.item == 2) return npy_cast<uint16_t>(src, dst, n, s);
+    if (header.item == 4) return npy_cast<uint32_t>(src, dst, n, s);
+    if (header.item == 8) return npy_cast<uint64_t>(src, dst, n, s);
+    break;
+  } throw std::runtime_error{"[Npy] Unsupported element type " + std::string{header.kind} + std::to_string(header.item)};
+}
+
+template <typename T>
+void npy_read(std::istream& in, const npy_header& header, T* dst, size_t n) {
+  if (npy_native<T>(header)) {
+    in.read(reinterpret_cast<char*>(dst), std::streamsize(n * sizeof(T)));
+  } else {
+    constexpr size_t chunk = size_t(1) << 16;
+    std::vector<char> buf(chunk * header.item);
+    for (size_t i = 0; i < n && in; i += chunk) {
+      auto c = std::min(chunk, n - i);
+      in.read(buf.data(), std::streamsize(c * header.item));
+      npy_convert(header, buf.data(), dst + i, c);
+    }
+  }
+
+  if (!in)
+    throw std::runtime_error{"[Npy] Truncated array data"};
+}
+
+} // namespace detail
+
+IG_API auto npy_read_header(std::istream& in) -> npy_header;
+IG_API void npy_write_header(std::ostream& out, const npy_header& header);
+
+// ndarray
+template <typename Arr>
+void npy_save(std::ostream& out, const ndarray_base<Arr>& arr) {
+  using T = ndarray_t<Arr>;
+  npy_write_header(out, detail::npy_header_of<T>({arr.shape().begin(), arr.shape().end()}, true));
+
+  auto write = [&out](auto& a) { out.write(reinterpret_cast<const char*>(a.buffer()), std::streamsize(a.size() * sizeof(T))); };
+  if constexpr (nd::is_strided<Arr>::value) {
+    if (arr.derived().contiguous())
+      return write(arr.derived());
+  }
+
+  const concrete_ndarray<Arr> tmp{arr};
+  write(tmp);
+}
+
+template <typename T>
+auto npy_load(std::istream& in) {
+  auto header = npy_read_header(in);
+  auto shape = header.shape;
+  if (!header.fortran)
+    std::reverse(shape.begin(), shape.end());
+
+  ndarray<T> arr{nd::shape_array{shape.begin(), shape.end()}};
+  detail::npy_read(in, header, arr.buffer(), arr.size());
+  return arr;
+}
+
+// Maps the file elements in place when type, byte order and alignment allow it, and loads a copy otherwise
+// Mappings are private copy-on-write by default, write stores back to the file and read throws like nd::mmap
+template <typename T>
+auto npy_map(const std::string& filename, map_mode mode = map_mode::copy) {
+  std::ifstream in{filename, std::ios::binary};
+  auto header = npy_read_header(in);
+  if (!detail::npy_native<T>(header) || header.data % alignof(T)) {
+    in.seekg(0);
+    return npy_load<T>(in);
+  }
+
+  auto shape = header.shape;
+  if (!header.fortran)
+    std::reverse(shape.begin(), shape.end());
+  return nd::mmap<T>(
+    std::make_shared<mapping>(filename, mode),
+    nd::shape_array{shape.begin(), shape.end()},
+    header.data);
+}
+
+// matrix
+template <typename Mat>
+void npy_save(std::ostream& out, const matrix_base<Mat>& mat) {
+  using T = matrix_t<Mat>;
+  const concrete_matrix<Mat> tmp{mat};
+  npy_write_header(out, detail::npy_header_of<T>({tmp.rows(), tmp.cols()}, false));
+  out.write(reinterpret_cast<const char*>(tmp.buffer()), std::streamsize(tmp.size() * sizeof(T)));
+}
+
+// Vectors are read as columns
+template <typename T>
+auto npy_load_matrix(std::istream& in) {
+  auto header = npy_read_header(in);
+  if (header.shape.size() > 2)
+    throw std::runtime_error{"[Npy] Invalid matrix, array has more than two dimensions"};
+
+  auto m = header.shape.size() > 0 ? header.shape[0] : 1;
+  auto n = header.shape.size() > 1 ? header.shape[1] : 1;
+  matrix<T> mat{m, n};
+  if (!header.fortran || n == 1 || m == 1) {
+    detail::npy_read(in, header, mat.buffer(), mat.size());
+  } else {
+    std::vector<T> tmp(m * n);
+    detail::npy_read(in, header, tmp.data(), tmp.size());
+    for (size_t j = 0; j < n; ++j)
+      for (size_t i = 0; i < m; ++i) mat(i, j) = tmp[j * m + i];
+  } return mat;
+}
+
+template <typename Xpr>
+void npy_save(const std::string& filename, const Xpr& xpr) {
+  std::ofstream out{filename, std::ios::binary};
+  if (!out.good())
+    throw std::runtime_error{"[Npy] Failed to create " + filename};
+  npy_save(out, xpr);
+}
+
+// Archives of named arrays, as written by numpy.savez
+class IG_API npz_writer {
+public:
+  explicit npz_writer(const std::string& filename);
+  ~npz_writer();
+
+  template <typename Xpr>
+  void save(const std::string& name, const Xpr& xpr) {
+    std::ostringstream npy;
+    npy_save(npy, xpr);
+    add(name, npy.str());
+  }
+
+  void close();
+
+  npz_writer(const npz_writer&) = delete;
+  npz_writer& operator=(const npz_writer&) = delete;
+
+private:
+  void add(const std::string& name, const std::string& npy);
+
+  struct record {
+    std::string name;
+    uint32_t crc;
+    uint64_t size;
+    uint64_t offset;
+  };
+
+  std::ofstream out_;
+  std::vector<record> records_;
+};
+
+class IG_API npz_reader {
+public:
+  explicit npz_reader(const std::string& filename);
+
+  bool contains(const std::string& name) const;
+  auto names() const -> std::vector<std::string>;
+
+  template <typename T>
+  auto load(const std::string& name) const {
+    std::istringstream in{extract(name)};
+    return npy_load<T>(in);
+  }
+
+  template <typename T>
+  auto load_matrix(const std::string& name) const {
+    std::istringstream in{extract(name)};
+    return npy_load_matrix<T>(in);
+  }
+
+  // Stored entries are mapped in place like single files, deflated ones are loaded
+  template <typename T>
+  auto map(const std::string& name, map_mode mode = map_mode::copy) const {
+    auto off = stored(name);
+    if (!off)
+      return load<T>(name);
+
+    std::ifstream in{filename_, std::ios::binary};
+    in.seekg(std::streamoff(off));
+    auto header = npy_read_header(in);
+    if (!detail::npy_native<T>(header) || (off + header.data) % alignof(T))
+      return load<T>(name);
+
+    auto shape = header.shape;
+    if (!header.fortran)
+      std::reverse(shape.begin(), shape.end());
+    return nd::mmap<T>(
+      std::make_shared<mapping>(filename_, mode),
+      nd::shape_array{shape.begin(), shape.end()},
+      off + header.data);
+  }
+
+private:
+  struct entry {
+    uint16_t method;
+    uint64_t csize;
+    uint64_t size;
+    uint64_t offset;
+  };
+
+  auto find(const std::string& name) const -> const entry&;
+  auto extract(const std::string& name) const -> std::string;
+  // Offset of the npy bytes of an uncompressed entry, 0 when compressed
+  auto stored(const std::string& name) const -> uint64_t;
+
+  std::string filename_;
+  std::map<std::string, entry> entries_;
+};
+
+} // namespace ig
+
+#endif // IG_SIMULATION_NPY_H
@@ -0,0 +1,131 @@
+/*
+ Imagine v0.1
+ [test]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/math/lin/algebra.h"
+#include "imagine/core/time.h"
+
+#include <cstdio>
+#include <random>
+
+using namespace ig;
+
+namespace {
+
+// Operands stay in cache, every run repeats the batch
+constexpr size_t batch = 1 << 9, repeats = 32;
+volatile float sink;
+
+// Generic paths, through the expression iterators and runtime loops
+template <typename Mat>
+auto generic_sum(const Mat& m) { return std::accumulate(m.begin(), m.end(), float(0)); }
+
+template <typename Mat>
+auto generic_dot(const Mat& lhs, const Mat& rhs) { return generic_sum(lhs * rhs); }
+
+template <typename Mat>
+auto generic_prod(const Mat& lhs, const Mat& rhs) {
+  Mat res{};
+  for (size_t i = 0; i < lhs.rows(); ++i)
+    for (size_t j = 0; j < lhs.cols(); ++j)
+      for (size_t k = 0; k < rhs.cols(); ++k)
+        res[i * rhs.cols() + k] += lhs[i * lhs.cols() + j] * rhs[j * rhs.cols() + k];
+  return res;
+}
+
+template <typename Mat>
+auto generic_trans(const Mat& m) {
+  Mat res{};
+  for (size_t i = 0; i < m.rows(); ++i)
+    for (size_t j = 0; j < m.cols(); ++j)
+      res[j * m.rows() + i] = m[i * m.cols() + j];
+  return res;
+}
+
+template <typename Fn>
+auto measure(Fn&& fn) {
+  ig::time<std::chrono::steady_clock, std::chrono::microseconds> t{15};
+  t.measure(15, [&] { for (size_t r = 0; r < repeats; ++r) fn(); });
+  return t.stats.median;
+}
+
+template <typename Generic, typename Unrolled>
+void compare(const char* name, Generic&& generic, Unrolled&& unrolled) {
+  auto g = measure(generic), u = measure(unrolled);
+  std::printf("%-16s generic %6llu us  unrolled %6llu us  x%.1f\n", name,
+    static_cast<unsigned long long>(g),
+    static_cast<unsigned long long>(u), double(g) / double(std::max<uint64_t>(u, 1)));
+}
+
+template <size_t N>
+void run(std::mt19937& rng) {
+  using mat = matrix<float, N, N>;
+  using vec = colvec<float, N>;
+  std::uniform_real_distribution<float> dist{-1.f, 1.f};
+
+  std::vector<mat> a(batch), b(batch);
+  std::vector<vec> u(batch), v(batch);
+  for (size_t i = 0; i < batch; ++i)
+    for (size_t k = 0; k < N * N; ++k)
+      a[i][k] = dist(rng), b[i][k] = dist(rng), u[i][k % N] = dist(rng), v[i][k % N] = dist(rng);
+
+  std::printf("%zu x %zu\n", N, N);
+  compare("product",
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += generic_prod(a[i], b[i])[1]; sink = s; },
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += mat{a[i] % b[i]}[1]; sink = s; });
+  compare("transpose",
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += generic_trans(a[i])[1]; sink = s; },
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += mat{a[i].t()}[1]; sink = s; });
+  compare("sum",
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += generic_sum(a[i]); sink = s; },
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += a[i].sum(); sink = s; });
+  compare("dot",
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += generic_dot(u[i], v[i]); sink = s; },
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += lin::dot(u[i], v[i]); sink = s; });
+  compare("normalise",
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += vec{u[i] / std::sqrt(generic_dot(u[i], u[i]))}[0]; sink = s; },
+    [&] { float s = 0; for (size_t i = 0; i < batch; ++i) s += vec{lin::normalise(u[i])}[0]; sink = s; });
+}
+
+// Dynamic vectors through the sequential loop, the pairwise tree and the compensated sum
+void reductions(std::mt19937& rng) {
+  constexpr size_t n = 1 << 16;
+  std::uniform_real_distribution<float> dist{-1.f, 1.f};
+  colvec<float> u(n), v(n);
+  for (size_t i = 0; i < n; ++i) u[i] = dist(rng), v[i] = dist(rng);
+
+  auto row = [](const char* name, auto&& naive, auto&& pairwise, auto&& compensated) {
+    auto a = measure(naive), b = measure(pairwise), c = measure(compensated);
+    std::printf("%-16s naive %6llu us  pairwise %6llu us  compensated %6llu us\n", name,
+      static_cast<unsigned long long>(a),
+      static_cast<unsigned long long>(b),
+      static_cast<unsigned long long>(c));
+  };
+
+  std::printf("%zu elements\n", n);
+  row("sum",
+    [&] { sink = generic_sum(u); },
+    [&] { sink = u.sum(); },
+    [&] { sink = u.sum(summation::compensated); });
+  row("dot",
+    [&] { float s = 0; for (size_t i = 0; i < n; ++i) s += u[i] * v[i]; sink = s; },
+    [&] { sink = lin::dot(u, v); },
+    [&] { sink = lin::dot(u, v, summation::compensated); });
+}
+
+} // namespace
+
+// Unrolled kernels of small static matrices against the generic loops, then the summation modes of long vectors, medians over 15 runs
+int main() {
+  std::mt19937 rng{42};
+  run<3>(rng);
+  run<4>(rng);
+  run<8>(rng);
+  reductions(rng);
+
+  colvec<float, 3> x{1.f, 0.f, 0.f}, y{0.f, 1.f, 0.f};
+  auto z = lin::cross(x, y);
+  return z[2] == 1.f ? 0 : 1;
+}
@@ -0,0 +1,52 @@
+/*
+ Imagine v0.1
+ [test]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/math/sig/conv.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace ig;
+
+namespace {
+
+size_t failures = 0;
+
+// Unrolled patches against the direct correlation of the same layer
+void im2col_direct(std::mt19937& rng, const nd::shape_array& in, const nd::shape_array& weights, const conv_params& params) {
+  std::uniform_real_distribution<float> dist{-1.f, 1.f};
+  ndarray<float> x{in}, w{weights};
+  for (size_t i = 0; i < x.size(); ++i) x.buffer()[i] = dist(rng);
+  for (size_t i = 0; i < w.size(); ++i) w.buffer()[i] = dist(rng);
+
+  auto direct = params, unrolled = params;
+  direct.method = conv_method::direct;
+  unrolled.method = conv_method::im2col;
+  auto a = conv(x, w, direct), b = conv(x, w, unrolled);
+
+  size_t wrong = 0;
+  for (size_t i = 0; i < a.size(); ++i)
+    wrong += std::abs(a.buffer()[i] - b.buffer()[i]) > 1e-4f * (1.f + std::abs(a.buffer()[i]));
+  if (wrong) {
+    std::printf("im2col: %zu of %zu outputs differ from the direct path\n", wrong, a.size());
+    ++failures;
+  }
+}
+
+} // namespace
+
+// Output positions and channels that do not divide the register tiles of the product
+int main() {
+  std::mt19937 rng{42};
+  im2col_direct(rng, {4, 33},     {3, 4, 1},    {});
+  im2col_direct(rng, {5, 65},     {7, 5, 3},    conv_params::same(nd::shape_array{3}));
+  im2col_direct(rng, {3, 9, 11},  {5, 3, 3, 3}, conv_params::same(nd::shape_array{3, 3}));
+  im2col_direct(rng, {6, 17, 2},  {9, 6, 2},    {});
+
+  std::printf("%zu failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
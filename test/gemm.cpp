@@ -0,0 +1,84 @@
+/*
+ Imagine v0.1
+ [test]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/math/theory/detail/gemm.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace ig;
+
+namespace {
+
+// Sizes that do not divide the register tiles nor the panels split across threads
+constexpr size_t rows[] = {1, 3, 5, 17}, cols[] = {1, 9, 33, 65, 100}, depths[] = {1, 5, 300};
+
+size_t failures = 0;
+
+void check(bool ok, const char* name, size_t m, size_t n, size_t k) {
+  if (ok) return;
+  std::printf("%-8s m %zu n %zu k %zu: wrong outputs\n", name, m, n, k);
+  ++failures;
+}
+
+template <typename T>
+void gemm_naive(std::mt19937& rng) {
+  std::uniform_real_distribution<T> dist{T(-1), T(1)};
+  for (auto m : rows)
+    for (auto n : cols)
+      for (auto k : depths) {
+        std::vector<T> a(m * k), b(k * n), c(m * n, T(0));
+        for (auto& x : a) x = dist(rng);
+        for (auto& x : b) x = dist(rng);
+        gemm<T>(m, n, k, T(1), {a.data(), std::ptrdiff_t(k), 1}, {b.data(), std::ptrdiff_t(n), 1}, T(0), {c.data(), std::ptrdiff_t(n), 1});
+
+        bool ok = true;
+        for (size_t i = 0; i < m; ++i)
+          for (size_t j = 0; j < n; ++j) {
+            double ref = 0;
+            for (size_t p = 0; p < k; ++p) ref += double(a[i * k + p]) * double(b[p * n + j]);
+            ok &= std::abs(c[i * n + j] - ref) <= 1e-3 * (1 + std::abs(ref));
+          }
+        check(ok, sizeof(T) == 4 ? "gemm f32" : "gemm f64", m, n, k);
+      }
+}
+
+// int8 products are exact, every output is compared for equality
+void qgemm_naive(std::mt19937& rng) {
+  std::uniform_int_distribution<int> dist{-127, 127};
+  for (auto m : rows)
+    for (auto n : cols)
+      for (auto k : depths) {
+        std::vector<int8_t> a(m * k), b(k * n);
+        std::vector<float> c(m * n, -1.f), one{1.f};
+        for (auto& x : a) x = int8_t(dist(rng));
+        for (auto& x : b) x = int8_t(dist(rng));
+        qgemm<float>(m, n, k, {a.data(), std::ptrdiff_t(k), 1}, {b.data(), std::ptrdiff_t(n), 1}, {one.data(), 0, one.data(), 0}, {c.data(), std::ptrdiff_t(n), 1});
+
+        bool ok = true;
+        for (size_t i = 0; i < m; ++i)
+          for (size_t j = 0; j < n; ++j) {
+            int32_t ref = 0;
+            for (size_t p = 0; p < k; ++p) ref += int32_t(a[i * k + p]) * int32_t(b[p * n + j]);
+            ok &= c[i * n + j] == float(ref);
+          }
+        check(ok, "qgemm", m, n, k);
+      }
+}
+
+} // namespace
+
+// Blocked products against the naive triple loop
+int main() {
+  std::mt19937 rng{42};
+  gemm_naive<float>(rng);
+  gemm_naive<double>(rng);
+  qgemm_naive(rng);
+
+  std::printf("%zu failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+/*
+ Imagine v0.1
+ [test]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/math/lin/algebra.h"
+
+#include <cmath>
+#include <cstdio>
+
+using namespace ig;
+
+namespace {
+
+size_t failures = 0;
+
+void check(bool ok, const char* name, const char* what) {
+  if (ok) return;
+  std::printf("%-8s %s: wrong result\n", name, what);
+  ++failures;
+}
+
+// Products of small integers are exact in both formats, every output is compared for equality
+template <typename H>
+void product(const char* name) {
+  matrix<H> l{5, 7}, r{7, 3};
+  for (size_t i = 0; i < l.size(); ++i) l[i] = float(i % 5) * 0.25f;
+  for (size_t i = 0; i < r.size(); ++i) r[i] = float(i % 3) - 1.f;
+
+  matrix<H> p = l % r;
+  bool ok = p.rows() == 5 && p.cols() == 3;
+  for (size_t i = 0; i < 5; ++i)
+    for (size_t k = 0; k < 3; ++k) {
+      float ref = 0;
+      for (size_t j = 0; j < 7; ++j) ref += float(l(i, j)) * float(r(j, k));
+      ok &= float(p(i, k)) == ref;
+    }
+  check(ok, name, "product");
+
+  H h{1.f};
+  h += 2.f; h *= 3.f; h -= 1.f; h /= 4.f;
+  check(float(h) == 2.f, name, "compound assignment");
+}
+
+// Past the largest float16 (65504), results only fit in the float accumulator
+template <typename H>
+void reductions(const char* name) {
+  matrix<H> a{300, 300};
+  colvec<H> v(120000);
+  for (size_t i = 0; i < a.size(); ++i) a[i] = 1.f;
+  for (size_t i = 0; i < v.size(); ++i) v[i] = 1.f;
+
+  check(a.sum() == 90000.f, name, "sum");
+  check(a.sum(summation::compensated) == 90000.f, name, "compensated sum");
+  check(a.mean() == 1.f, name, "mean");
+  check(a.prod() == 1.f, name, "prod");
+  check(lin::dot(v, v) == 120000.f, name, "dot");
+  check(std::abs(lin::norm(v) - std::sqrt(120000.f)) < 1e-2f, name, "norm");
+}
+
+} // namespace
+
+// 16-bit matrices are computed in float
+int main() {
+  product<float16>("float16");
+  product<bfloat16>("bfloat16");
+  reductions<float16>("float16");
+  reductions<bfloat16>("bfloat16");
+
+  std::printf("%zu failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
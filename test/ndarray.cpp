@@ -0,0 +1,78 @@
+/*
+ Imagine v0.1
+ [test]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/math/theory/ndarray.h"
+
+#include <cstdio>
+
+using namespace ig;
+
+namespace {
+
+size_t failures = 0;
+
+void check(bool ok, const char* what) {
+  if (ok) return;
+  std::printf("%s: wrong result\n", what);
+  ++failures;
+}
+
+// Boolean elements are stored as bytes, copies and moves keep them
+void boolean() {
+  ndarray<bool> a{nd::shape_array{3, 4}};
+  check(a.size() == 12, "bool size");
+
+  for (size_t i = 0; i < a.size(); ++i) a(i) = i % 3 == 0;
+  size_t set = 0;
+  for (size_t i = 0; i < a.size(); ++i) set += a(i);
+  check(set == 4 && a(1, 1) == false && a(0, 1) == true, "bool elements");
+
+  auto b = a;
+  b(0) = false;
+  check(a(0) && !b(0), "bool copy");
+
+  auto c = std::move(b);
+  check(!c(0) && c(3) && c.size() == 12, "bool move");
+
+  c->reshape({4, 3});
+  check(c.shape()[0] == 4 && c(3), "bool reshape");
+
+  ndarray<bool> d{nd::dynamic_storage<bool>{{2, 2}, true}};
+  check(d(0) && d(3), "bool fill");
+}
+
+// Lazy expressions broadcast by lines, against the subscripts of their operands
+void broadcast(const nd::shape_array& xs, const nd::shape_array& to) {
+  ndarray<float> a{xs}, b{xs}, r{to};
+  for (size_t i = 0; i < a.size(); ++i) a(i) = float(i % 7), b(i) = float(i % 5) - 2.f;
+  r = nd::broadcast(a * b + 1.f, to);
+
+  bool ok = true;
+  for (size_t i = 0; i < r.size(); ++i) {
+    size_t src = 0, step = 1, j = i;
+    for (size_t k = 0; k < to.size(); ++k) {
+      auto idx = j % to[k];
+      j /= to[k];
+      if (k < xs.size() && xs[k] != 1) src += idx * step;
+      if (k < xs.size()) step *= xs[k];
+    }
+    ok &= r(i) == a(src) * b(src) + 1.f;
+  }
+  check(ok, "broadcast");
+}
+
+} // namespace
+
+int main() {
+  boolean();
+  broadcast({1, 5}, {4, 5});
+  broadcast({33, 1}, {33, 9});
+  broadcast({17}, {17, 3, 2});
+  broadcast({1, 3, 1}, {20, 3, 4});
+
+  std::printf("%zu failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/*
+ Imagine v0.1
+ [test]
+ Copyright (c) 2015-present, Hugo (hrkz) Frezat
+*/
+
+#include "imagine/math/lin/algebra.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+using namespace ig;
+
+namespace {
+
+constexpr size_t n = size_t(1) << 16;
+constexpr double u = std::numeric_limits<float>::epsilon() / 2;
+
+size_t failures = 0;
+
+void check(bool ok, const char* what, double err, double bound) {
+  std::printf("%-16s error %.3e limit %.3e\n", what, err, bound);
+  if (ok) return;
+  std::printf("%-16s wrong result\n", what);
+  ++failures;
+}
+
+// Magnitudes over six decades that mostly cancel, the condition number sum |x| / |sum x| is large
+auto ill_conditioned(std::mt19937& rng) {
+  std::uniform_real_distribution<float> mant{-1.f, 1.f}, decade{0.f, 6.f};
+  colvec<float> x(n);
+  for (size_t i = 0; i < n; i += 2) {
+    auto v = mant(rng) * std::pow(10.f, decade(rng));
+    x[i] = v, x[i + 1] = -v * (1.f + mant(rng) * 1e-3f);
+  }
+  return x;
+}
+
+// Sequential long double sums are exact enough to serve as reference
+void sums(std::mt19937& rng) {
+  auto x = ill_conditioned(rng);
+  long double ref = 0, abs = 0;
+  for (size_t i = 0; i < n; ++i)
+    ref += x[i], abs += std::abs(x[i]);
+
+  auto pairwise = std::abs(x.sum() - ref), compensated = std::abs(x.sum(summation::compensated) - ref);
+  std::printf("sum condition %.3e\n", double(abs / std::abs(ref)));
+  check(pairwise <= std::log2(double(n)) * u * abs, "sum pairwise", double(pairwise), std::log2(double(n)) * u * double(abs));
+  check(compensated <= 2 * u * std::abs(ref) + 4 * n * u * u * abs, "sum compensated", double(compensated), double(2 * u * std::abs(ref) + 4 * n * u * u * abs));
+  check(compensated <= pairwise, "sum ordering", double(compensated), double(pairwise));
+}
+
+// Positive terms of similar size, the error of a sequential sum grows linearly with n and pairwise with log n
+void drift(std::mt19937& rng) {
+  std::uniform_real_distribution<float> dist{0.09f, 0.11f};
+  colvec<float> x(n);
+  long double ref = 0;
+  float seq = 0;
+  for (size_t i = 0; i < n; ++i)
+    x[i] = dist(rng), ref += x[i], seq += x[i];
+
+  auto naive = std::abs(seq - ref), pairwise = std::abs(x.sum() - ref);
+  check(pairwise < naive, "drift pairwise", double(pairwise), double(naive));
+}
+
+// Products are rounded once in both modes, only their accumulation differs
+void dots(std::mt19937& rng) {
+  auto x = ill_conditioned(rng);
+  colvec<float> y(n);
+  for (size_t i = 0; i < n; ++i) y[i] = 1.f + float(i % 3) * 0.25f;
+
+  long double ref = 0, abs = 0;
+  for (size_t i = 0; i < n; ++i) {
+    auto p = (long double)x[i] * y[i];
+    ref += p, abs += std::abs(p);
+  }
+
+  auto pairwise = std::abs(lin::dot(x, y) - ref), compensated = std::abs(lin::dot(x, y, summation::compensated) - ref);
+  check(pairwise <= (std::log2(double(n)) + 1) * u * abs, "dot pairwise", double(pairwise), (std::log2(double(n)) + 1) * u * double(abs));
+  check(compensated <= u * abs + 2 * u * std::abs(ref) + 4 * n * u * u * abs, "dot compensated", double(compensated), double(u * abs + 2 * u * std::abs(ref) + 4 * n * u * u * abs));
+}
+
+} // namespace
+
+// Pairwise and compensated reductions of float vectors against long double references
+int main() {
+  std::mt19937 rng{42};
+  sums(rng);
+  drift(rng);
+  dots(rng);
+
+  std::printf("%zu failures\n", failures);
+  return failures == 0 ? 0 : 1;
+}